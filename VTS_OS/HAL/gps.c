@@ -130,12 +130,13 @@ void GPSInitPortPinsAndClock(void){
 /***********************************************************************************************
  * Function Name      : GPSParseRawData
  * Description        : Parse the incoming data from gps module
- * INPUTS             : Recieved Data Buffer, pointer to time variable,
- *                      pointer to Longitude variable, pointer to Speed variable,
+ * INPUTS             : Recieved Data Buffer, pointer to time variable, pointer to date variable
+ *                      (ddmmyy), pointer to Longitude and Latitude variables (GPSCoordinateSize
+ *                      bytes each), pointer to Speed variable,
  *                      pointer to current COG variable and pointer to state variable
  * RETURNS            : void
  ***********************************************************************************************/
-void GPSParseRawData(char Received_Data[], float *Time, char *Longitude, char *Latitude, float *Speed, float *currentCOG,char *State)
+void GPSParseRawData(char Received_Data[], float *Time, uint32_t *Date, char *Longitude, char *Latitude, float *Speed, float *currentCOG,char *State)
 {
 /*                      Payload that contain Time,Location,Speed                                */
     char GPS_Payload[120];
@@ -174,11 +175,32 @@ void GPSParseRawData(char Received_Data[], float *Time, char *Longitude, char *L
         }
             else if (tokenIndex == 3)
             {
-                strcpy(Latitude, token);
+                /* Leave room for the sign of the hemisphere */
+                strncpy(Latitude, token, GPSCoordinateSize - 2);
+                Latitude[GPSCoordinateSize - 2] = '\0';
+            }
+            else if (tokenIndex == 4)
+            {
+                /* Southern latitudes are negative */
+                if (*token == 'S')
+                {
+                    memmove(&Latitude[1], Latitude, strlen(Latitude) + 1);
+                    Latitude[0] = '-';
+                }
             }
             else if (tokenIndex == 5)
             {
-                strcpy(Longitude, token);
+                strncpy(Longitude, token, GPSCoordinateSize - 2);
+                Longitude[GPSCoordinateSize - 2] = '\0';
+            }
+            else if (tokenIndex == 6)
+            {
+                /* Western longitudes are negative */
+                if (*token == 'W')
+                {
+                    memmove(&Longitude[1], Longitude, strlen(Longitude) + 1);
+                    Longitude[0] = '-';
+                }
             }
             else if (tokenIndex == 7)
             {
@@ -188,6 +210,10 @@ void GPSParseRawData(char Received_Data[], float *Time, char *Longitude, char *L
             {
                 *currentCOG = atof(token);
             }
+            else if (tokenIndex == 9)
+            {
+                *Date = strtoul(token, NULL, 10);
+            }
             token = strtok(NULL, ",");
             tokenIndex++;
         }
@@ -232,3 +258,96 @@ int GPSDetectUTurn(const float currentCOG,const float speed)
     }
     return Status;
 }
+
+/***********************************************************************************************
+ * Function Name: GPSToMicroDegrees
+ * Description  : Convert a coordinate in the NMEA ddmm.mmmm (or dddmm.mmmm) format to
+ *                millionths of a degree without going through floating point. A leading '-'
+ *                (southern or western hemisphere) gives a negative value.
+ * INPUTS       : const char *Coordinate
+ *
+ * RETURNS      : int32_t  coordinate in micro degrees
+ ***********************************************************************************************/
+int32_t GPSToMicroDegrees(const char *Coordinate)
+{
+    uint32_t whole = 0;                                 /* ddmm part of the coordinate */
+    uint32_t fraction = 0;                              /* minutes fraction in 1e-5 minutes */
+    uint8_t  digits = 0;
+    int32_t  sign = 1;
+
+    if (*Coordinate == '-')
+    {
+        sign = -1;
+        Coordinate++;
+    }
+    while (*Coordinate >= '0' && *Coordinate <= '9')
+    {
+        whole = whole * 10 + (uint32_t)(*Coordinate - '0');
+        Coordinate++;
+    }
+    if (*Coordinate == '.')
+    {
+        Coordinate++;
+        while (digits < 5 && *Coordinate >= '0' && *Coordinate <= '9')
+        {
+            fraction = fraction * 10 + (uint32_t)(*Coordinate - '0');
+            Coordinate++;
+            digits++;
+        }
+    }
+    while (digits < 5)
+    {
+        fraction *= 10;
+        digits++;
+    }
+    /* minutes in 1e-5 units divided by 6 gives micro degrees (1e6 / 60 / 1e5) */
+    return sign * (int32_t)((whole / 100) * 1000000 + ((whole % 100) * 100000 + fraction) / 6);
+}
+
+/***********************************************************************************************
+ * Function Name: GPSFromMicroDegrees
+ * Description  : Write a coordinate in millionths of a degree in the NMEA ddmm.mmmm (or
+ *                dddmm.mmmm) format GPSParseRawData gives, with a leading '-' for the southern
+ *                or western hemisphere. The minutes are cut to 4 decimals (under 0.2 m).
+ * INPUTS       : int32_t MicroDegrees
+ *                char *Coordinate  GPSCoordinateSize bytes
+ * RETURNS      : void
+ ***********************************************************************************************/
+void GPSFromMicroDegrees(int32_t MicroDegrees, char *Coordinate)
+{
+    uint32_t value;
+    uint32_t minutes;                                   /* minutes in 1e-4 units */
+    char     digits[10];
+    uint8_t  count = 0;
+
+    if (MicroDegrees < 0)
+    {
+        *Coordinate++ = '-';
+        value = (uint32_t)(-MicroDegrees);
+    }
+    else
+    {
+        value = (uint32_t)MicroDegrees;
+    }
+    /* micro degrees times 6 gives 1e-5 minutes (60 / 1e6 * 1e5) */
+    minutes = ((value % 1000000) * 6) / 10;
+    /* ddmm.mmmm read backwards: 4 decimals, the point, 2 digits of minutes and the degrees */
+    digits[count++] = (char)('0' + minutes % 10);
+    digits[count++] = (char)('0' + (minutes / 10) % 10);
+    digits[count++] = (char)('0' + (minutes / 100) % 10);
+    digits[count++] = (char)('0' + (minutes / 1000) % 10);
+    digits[count++] = '.';
+    digits[count++] = (char)('0' + (minutes / 10000) % 10);
+    digits[count++] = (char)('0' + (minutes / 100000) % 10);
+    value /= 1000000;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count != 0)
+    {
+        *Coordinate++ = digits[--count];
+    }
+    *Coordinate = '\0';
+}
@@ -32,6 +32,8 @@
  *                                Definitions                                  *
  *******************************************************************************/
 #define GPSUART_Base     UART1_BASE
+/* Size of a coordinate string: "-dddmm.mmmmm" (a western NEO-6M longitude) and its NUL */
+#define GPSCoordinateSize   13
 typedef enum
 {
     UTURN,
@@ -60,8 +62,12 @@ void GPSGetRawData(uint8_t *RawData,uint32_t RawDataSize);
 /*                      Function to set callback Function                      */
 void GPSSetReceptionCallBack(void (*Callback)(void));
 /*             The core function which takes the raw data and parse it          */
-void GPSParseRawData(char Received_Data[], float *Time, char *Longitude, char *Latitude, float *Speed, float *currentCOG,char *State);
+void GPSParseRawData(char Received_Data[], float *Time, uint32_t *Date, char *Longitude, char *Latitude, float *Speed, float *currentCOG,char *State);
 /*             The function That Detects the type of movement                   */
 int GPSDetectUTurn(const float currentCOG,const float speed);
+/*  Convert a [-]ddmm.mmmm NMEA coordinate to millionths of a degree            */
+int32_t GPSToMicroDegrees(const char *Coordinate);
+/*  Write millionths of a degree back as a [-]ddmm.mmmm NMEA coordinate         */
+void GPSFromMicroDegrees(int32_t MicroDegrees, char *Coordinate);
 
 #endif /* HAL_GPS_H_ */
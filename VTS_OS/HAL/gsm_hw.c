@@ -12,13 +12,29 @@
  *                                Includes                                     *
  *******************************************************************************/
 #include <HAL/gsm_hw.h>
+#include <stddef.h>
 
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
 extern void (* UART2RX_DMA_CH0_Ptr )(void);
 extern void (* UART2TX_DMA_CH1_Ptr )(void);
+extern void (* GPIOD_Ptr )(void);
 extern uint32_t uDMAControlTable[256];
+/* Bytes handed to the UART2 TX DMA since power up */
+static uint32_t GSMTxBytes=0;
+/* Size of the reception armed by the last GSMReceiveResponse */
+static uint32_t GSMRxSize=0;
+/* Baud rate UART2 currently runs at */
+static uint32_t GSMBaudRate=GSMDefaultBaud;
+/* Reception callback of the application, called after RTS was released */
+static void (*GSMRxCallback)(void)=NULL;
+/* Set while a transmission waits for the module to assert CTS */
+static volatile uint8_t GSMTxPaused=0;
+/* Task list of the scatter-gather transmissions, read by the DMA from the alternate structure */
+static tDMAControlTable GSMTxTasks[GSMMaxFragments];
+/* Set when the primary structure of UART2 TX was last used for scatter-gather */
+static uint8_t GSMTxScatter=0;
 
 /*******************************************************************************
  *                              Functions Prototypes                           *
@@ -26,6 +42,12 @@ extern uint32_t uDMAControlTable[256];
 static void GSMInitPortPinsAndClock(void);
 static void GSMUARTInit(void);
 static void GSMDMAInit(void);
+static void GSMFlowControlInit(void);
+static void GSMSleepControlInit(void);
+static void GSMPowerControlInit(void);
+static void GSMRxComplete(void);
+static void GSMCTSChanged(void);
+static void GSMStartTx(void);
 
 /***********************************************************************************************
  * Function Name      : GSMInit
@@ -39,6 +61,18 @@ void GSMInit(void){
     GSMUARTInit();
     //Init DMA
     GSMDMAInit();
+#if GSMFlowControl
+    //Init RTS/CTS
+    GSMFlowControlInit();
+#endif
+#if GSMSleepControl
+    //Init DTR
+    GSMSleepControlInit();
+#endif
+#if GSMPowerControl
+    //Init PWRKEY/RESET
+    GSMPowerControlInit();
+#endif
 }
 
 
@@ -49,8 +83,9 @@ void GSMInit(void){
  * RETURNS            : void
  ***********************************************************************************************/
 void GSMSetReceptionCallBack(void (*Callback)(void)){
-    // Assign the provided callback function to the pointer responsible for DMA reception.
-    UART2RX_DMA_CH0_Ptr=Callback;
+    // The DMA reception ends in GSMRxComplete which releases RTS and calls the provided callback.
+    GSMRxCallback=Callback;
+    UART2RX_DMA_CH0_Ptr=GSMRxComplete;
 }
 
 /***********************************************************************************************
@@ -71,11 +106,16 @@ void GSMSetTransmissionCallBack(void (*Callback)(void)){
  * RETURNS            : void
  ***********************************************************************************************/
 void GSMReceiveResponse(uint8_t *Response,uint32_t ResponseSize){
+    GSMRxSize=ResponseSize;
     // Configure DMA transfer settings for UART2 RX channel.
     uDMAChannelTransferSet( UDMA_SEC_CHANNEL_UART2RX_0 |UDMA_PRI_SELECT, UDMA_MODE_BASIC,
                            (void *)&HWREG(UART2_BASE+UART_O_DR), (void *)Response,ResponseSize);
     // Enable the DMA channel for UART2 RX.
     uDMAChannelEnable(UDMA_SEC_CHANNEL_UART2RX_0);
+#if GSMFlowControl
+    // Let the module send now that there is room for the response.
+    MAP_GPIOPinWrite(GSMFlow_Base, GSMRTS_Pin, 0);
+#endif
 }
 
 /***********************************************************************************************
@@ -85,15 +125,241 @@ void GSMReceiveResponse(uint8_t *Response,uint32_t ResponseSize){
  * RETURNS            : void
  ***********************************************************************************************/
 void GSMSend(uint8_t *CMD_Data,uint32_t DataSize){
+    GSMTxBytes+=DataSize;
+    // A scatter-gather transmission left 32 bit items in the control word
+    if(GSMTxScatter){
+        uDMAChannelControlSet(UDMA_SEC_CHANNEL_UART2TX_1 |UDMA_PRI_SELECT, UDMA_DST_INC_NONE| UDMA_SRC_INC_8 |UDMA_SIZE_8 |UDMA_ARB_4);
+        GSMTxScatter=0;
+    }
     // Configure DMA transfer settings for UART2 TX channel.
     uDMAChannelTransferSet( UDMA_SEC_CHANNEL_UART2TX_1 |UDMA_PRI_SELECT, UDMA_MODE_BASIC,
                            (void *)CMD_Data, (void *)&HWREG(UART2_BASE+UART_O_DR),DataSize);
+    GSMStartTx();
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMSendVector
+ * Description        : Send a list of fragments back to back in one peripheral scatter-gather DMA
+ *                      operation, so a constant command prefix and a payload elsewhere in memory
+ *                      need no staging buffer. The fragments must stay valid until the
+ *                      transmission callback. Empty fragments are skipped.
+ * INPUTS             : const GSMFragment_t *Fragments, uint32_t Count (at most GSMMaxFragments)
+ * RETURNS            : uint32_t bytes sent, 0 if the list does not fit the task list
+ ***********************************************************************************************/
+uint32_t GSMSendVector(const GSMFragment_t *Fragments,uint32_t Count){
+    uint32_t Index;
+    uint32_t Tasks=0;
+    uint32_t Bytes=0;
+    for(Index=0;Index<Count;Index++){
+        if(Fragments[Index].Size==0){
+            continue;
+        }
+        if(Tasks==GSMMaxFragments || Fragments[Index].Size>GSMMaxFragmentSize){
+            return 0;
+        }
+        // Same transfer as GSMSend, the DMA loads it into the alternate structure
+        GSMTxTasks[Tasks].pvSrcEndAddr=(void *)&Fragments[Index].Data[Fragments[Index].Size-1];
+        GSMTxTasks[Tasks].pvDstEndAddr=(void *)&HWREG(UART2_BASE+UART_O_DR);
+        GSMTxTasks[Tasks].ui32Control=UDMA_DST_INC_NONE|UDMA_SRC_INC_8|UDMA_SIZE_8|UDMA_ARB_4|
+                                      ((Fragments[Index].Size-1)<<4)|
+                                      UDMA_MODE_PER_SCATTER_GATHER|UDMA_MODE_ALT_SELECT;
+        GSMTxTasks[Tasks].ui32Spare=0;
+        Bytes+=Fragments[Index].Size;
+        Tasks++;
+    }
+    if(Tasks==0){
+        return 0;
+    }
+    // The last task ends the operation
+    GSMTxTasks[Tasks-1].ui32Control=(GSMTxTasks[Tasks-1].ui32Control&~(uint32_t)0x7)|UDMA_MODE_BASIC;
+    GSMTxBytes+=Bytes;
+    GSMTxScatter=1;
+    uDMAChannelScatterGatherSet(UDMA_SEC_CHANNEL_UART2TX_1,Tasks,GSMTxTasks,1);
+    GSMStartTx();
+    return Bytes;
+}
 
+/***********************************************************************************************
+ * Function Name      : GSMStartTx
+ * Description        : Enable the prepared UART2 TX transfer, or hold it while CTS is deasserted.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMStartTx(void){
+#if GSMFlowControl
+    // Hold the transmission until the module asserts CTS, GSMCTSChanged starts it then.
+    if(MAP_GPIOPinRead(GSMFlow_Base, GSMCTS_Pin)){
+        GSMTxPaused=1;
+        // CTS may have been asserted before the flag was seen by GSMCTSChanged
+        if(MAP_GPIOPinRead(GSMFlow_Base, GSMCTS_Pin)){
+            return;
+        }
+        GSMTxPaused=0;
+    }
+#endif
     // Enable the DMA channel for UART2 TX.
     uDMAChannelEnable(UDMA_SEC_CHANNEL_UART2TX_1);
 
 }
 
+/***********************************************************************************************
+ * Function Name      : GSMGetTxByteCount
+ * Description        : Get the number of bytes sent to the GSM module since power up.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t GSMGetTxByteCount(void){
+    return GSMTxBytes;
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMGetRxByteCount
+ * Description        : Get the number of bytes received since the last GSMReceiveResponse. Unlike
+ *                      searching the buffer it also counts the zero bytes of binary data.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t GSMGetRxByteCount(void){
+    return GSMRxSize-uDMAChannelSizeGet(UDMA_SEC_CHANNEL_UART2RX_0 |UDMA_PRI_SELECT);
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMSetBaudRate
+ * Description        : Switch UART2 to a new baud rate once the module was told to use it.
+ * INPUTS             : uint32_t Baud
+ * RETURNS            : void
+ ***********************************************************************************************/
+void GSMSetBaudRate(uint32_t Baud){
+    // Let the last command leave the UART before changing the rate.
+    while(UARTBusy(GSMUART_Base));
+    UARTConfigSetExpClk(GSMUART_Base, 16000000, Baud, UART_CONFIG_WLEN_8|UART_CONFIG_STOP_ONE);
+    GSMBaudRate=Baud;
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMGetBaudRate
+ * Description        : Get the baud rate UART2 runs at.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t GSMGetBaudRate(void){
+    return GSMBaudRate;
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMSetDTR
+ * Description        : Drive the DTR line of the module, high allows it to sleep, low wakes it up.
+ * INPUTS             : uint8_t High
+ * RETURNS            : void
+ ***********************************************************************************************/
+void GSMSetDTR(uint8_t High){
+#if GSMSleepControl
+    MAP_GPIOPinWrite(GSMDTR_Base, GSMDTR_Pin, High?GSMDTR_Pin:0);
+#endif
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMSetPowerKey
+ * Description        : Press or release the PWRKEY of the module. A press of about 1 s switches
+ *                      the module on when it is off and off when it is on.
+ * INPUTS             : uint8_t Pressed
+ * RETURNS            : void
+ ***********************************************************************************************/
+void GSMSetPowerKey(uint8_t Pressed){
+#if GSMPowerControl
+    MAP_GPIOPinWrite(GSMPower_Base, GSMPWRKEY_Pin, Pressed?GSMPWRKEY_Pin:0);
+#endif
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMSetReset
+ * Description        : Hold the module in reset or release it.
+ * INPUTS             : uint8_t Asserted
+ * RETURNS            : void
+ ***********************************************************************************************/
+void GSMSetReset(uint8_t Asserted){
+#if GSMPowerControl
+    MAP_GPIOPinWrite(GSMPower_Base, GSMRST_Pin, Asserted?GSMRST_Pin:0);
+#endif
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMRxComplete
+ * Description        : DMA reception done, stop the module from sending until the next reception
+ *                      is armed and notify the application.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMRxComplete(void){
+#if GSMFlowControl
+    MAP_GPIOPinWrite(GSMFlow_Base, GSMRTS_Pin, GSMRTS_Pin);
+#endif
+    if(GSMRxCallback != NULL){
+        GSMRxCallback();
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMCTSChanged
+ * Description        : CTS edge, pause the TX DMA while the module cannot take more data and
+ *                      resume it when it can.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMCTSChanged(void){
+    if(MAP_GPIOPinRead(GSMFlow_Base, GSMCTS_Pin)){
+        if(uDMAChannelIsEnabled(UDMA_SEC_CHANNEL_UART2TX_1)){
+            uDMAChannelDisable(UDMA_SEC_CHANNEL_UART2TX_1);
+            GSMTxPaused=1;
+        }
+    }else if(GSMTxPaused){
+        GSMTxPaused=0;
+        uDMAChannelEnable(UDMA_SEC_CHANNEL_UART2TX_1);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMFlowControlInit
+ * Description        : Configure the RTS output, the CTS input and its interrupt on both edges.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMFlowControlInit(void){
+    // Not ready to receive until the first reception is armed.
+    MAP_GPIOPinTypeGPIOOutput(GSMFlow_Base, GSMRTS_Pin);
+    MAP_GPIOPinWrite(GSMFlow_Base, GSMRTS_Pin, GSMRTS_Pin);
+    MAP_GPIOPinTypeGPIOInput(GSMFlow_Base, GSMCTS_Pin);
+    MAP_GPIOPadConfigSet(GSMFlow_Base, GSMCTS_Pin, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);
+    GPIOD_Ptr=GSMCTSChanged;
+    MAP_GPIOIntTypeSet(GSMFlow_Base, GSMCTS_Pin, GPIO_BOTH_EDGES);
+    MAP_GPIOIntEnable(GSMFlow_Base, GSMCTS_Pin);
+    IntEnable(INT_GPIOD_TM4C123);
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMSleepControlInit
+ * Description        : Configure the DTR output, low so the module stays awake until told otherwise.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMSleepControlInit(void){
+    MAP_SysCtlPeripheralEnable(GSMDTR_Periph);
+    MAP_GPIOPinTypeGPIOOutput(GSMDTR_Base, GSMDTR_Pin);
+    MAP_GPIOPinWrite(GSMDTR_Base, GSMDTR_Pin, 0);
+}
+
+/***********************************************************************************************
+ * Function Name      : GSMPowerControlInit
+ * Description        : Configure the PWRKEY and RESET outputs, both released.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMPowerControlInit(void){
+    MAP_SysCtlPeripheralEnable(GSMPower_Periph);
+    MAP_GPIOPinTypeGPIOOutput(GSMPower_Base, GSMPWRKEY_Pin|GSMRST_Pin);
+    MAP_GPIOPinWrite(GSMPower_Base, GSMPWRKEY_Pin|GSMRST_Pin, 0);
+}
+
 /***********************************************************************************************
  * Function Name      : GSMDMAInit
  * Description        : Initialize UART for GSM communication.
@@ -133,7 +399,7 @@ void GSMDMAInit(void){
  ***********************************************************************************************/
 void GSMUARTInit(void){
     // Configure UART settings:
-    UARTConfigSetExpClk(GSMUART_Base, 16000000, 9600, UART_CONFIG_WLEN_8|UART_CONFIG_STOP_ONE);
+    UARTConfigSetExpClk(GSMUART_Base, 16000000, GSMBaudRate, UART_CONFIG_WLEN_8|UART_CONFIG_STOP_ONE);
     // Enable DMA for UART transmit and receive.
     UARTDMAEnable(GSMUART_Base, UART_DMA_TX|UART_DMA_RX);
     // Enable NVIC interrupt for UART2.
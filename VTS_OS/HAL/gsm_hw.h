@@ -29,6 +29,42 @@
  *                                Definitions                                  *
  *******************************************************************************/
 #define GSMUART_Base     UART2_BASE
+/* Baud rate of the module after power up (autobaud) and the one negotiated with it */
+#define GSMDefaultBaud   9600
+#define GSMFastBaud      115200
+
+/* RTS/CTS flow control on GPIO pins, set GSMFlowControl to 0 if they are not wired.
+ * RTS (output, low = MCU ready to receive) goes to the module RTS input,
+ * CTS (input, low = module ready to receive) comes from the module CTS output.
+ * CTS has a pull down so an unconnected line never blocks the transmission. */
+#define GSMFlowControl   1
+#define GSMFlow_Base     GPIO_PORTD_BASE
+#define GSMRTS_Pin       GPIO_PIN_2
+#define GSMCTS_Pin       GPIO_PIN_3
+
+/* DTR output used with the AT+CSCLK=1 sleep mode, set GSMSleepControl to 0 if it is not wired.
+ * DTR high lets the module sleep while the link is idle, DTR low wakes it up. */
+#define GSMSleepControl  1
+#define GSMDTR_Periph    SYSCTL_PERIPH_GPIOE
+#define GSMDTR_Base      GPIO_PORTE_BASE
+#define GSMDTR_Pin       GPIO_PIN_1
+
+/* PWRKEY and RESET of the module through open collector transistors, a high pin pulls the module
+ * line low. Set GSMPowerControl to 0 if they are not wired. */
+#define GSMPowerControl  1
+#define GSMPower_Periph  SYSCTL_PERIPH_GPIOE
+#define GSMPower_Base    GPIO_PORTE_BASE
+#define GSMPWRKEY_Pin    GPIO_PIN_2
+#define GSMRST_Pin       GPIO_PIN_3
+
+/* Fragments GSMSendVector sends in one DMA operation, each of them at most GSMMaxFragmentSize */
+#define GSMMaxFragments     8
+#define GSMMaxFragmentSize  1024
+
+typedef struct{
+    const uint8_t *Data;
+    uint32_t       Size;
+}GSMFragment_t;
 
 
 /*******************************************************************************
@@ -36,8 +72,16 @@
  *******************************************************************************/
 void GSMInit(void);
 void GSMSend(uint8_t *CMD_Data,uint32_t DataSize);
+uint32_t GSMSendVector(const GSMFragment_t *Fragments,uint32_t Count);
 void GSMReceiveResponse(uint8_t *Response,uint32_t ResponseSize);
 void GSMSetReceptionCallBack(void (*Callback)(void));
 void GSMSetTransmissionCallBack(void (*Callback)(void));
+uint32_t GSMGetTxByteCount(void);
+uint32_t GSMGetRxByteCount(void);
+void GSMSetBaudRate(uint32_t Baud);
+uint32_t GSMGetBaudRate(void);
+void GSMSetDTR(uint8_t High);
+void GSMSetPowerKey(uint8_t Pressed);
+void GSMSetReset(uint8_t Asserted);
 
 #endif /* HAL_GSM_HW_H_ */
@@ -0,0 +1,137 @@
+/******************************************************************************
+ * File Name: spinor_hw.c
+ *
+ * Description: Source file for the SSI bus of the external SPI NOR flash. The
+ *              command and address bytes go through the SSI FIFO, the data of
+ *              a page program or a read is moved by the uDMA: the transmit
+ *              channel feeds the data (or 0xFF while reading) and the receive
+ *              channel stores the answer (or drops it while programming), so
+ *              the receive FIFO never overruns and the end of the receive
+ *              transfer is the end of the command.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <HAL/spinor_hw.h>
+#include <stddef.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+extern uint32_t uDMAControlTable[256];
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t SpiNorSsiInit(void);
+static uint32_t SpiNorSsiTransfer(const uint8_t *Cmd,uint32_t CmdSize,const uint8_t *Tx,uint8_t *Rx,uint32_t Size);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Byte clocked out while reading and sink of the bytes clocked in while programming */
+static const uint8_t SpiNorFill=0xFF;
+static uint8_t SpiNorSink;
+const SpiNorBus_t SpiNorSsi={
+    SpiNorSsiInit,
+    SpiNorSsiTransfer
+};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : SpiNorSsiInit
+ * Description        : Clock SSI0, port A and the uDMA, set the pins and the SPI mode 0 master at
+ *                      SpiNorBitRate, and assign the uDMA channels 10 and 11 to SSI0.
+ * INPUTS             : void
+ * RETURNS            : uint32_t 0
+ ***********************************************************************************************/
+static uint32_t SpiNorSsiInit(void){
+    uint32_t Data;
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_SSI0);
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    // Chip select high (idle) before the pin becomes an output
+    MAP_GPIOPinWrite(SpiNorCS_Base, SpiNorCS_Pin, SpiNorCS_Pin);
+    MAP_GPIOPinTypeGPIOOutput(SpiNorCS_Base, SpiNorCS_Pin);
+    MAP_GPIOPinConfigure(GPIO_PA2_SSI0CLK);
+    MAP_GPIOPinConfigure(GPIO_PA4_SSI0RX);
+    MAP_GPIOPinConfigure(GPIO_PA5_SSI0TX);
+    MAP_GPIOPinTypeSSI(GPIO_PORTA_BASE, GPIO_PIN_2|GPIO_PIN_4|GPIO_PIN_5);
+    SSIConfigSetExpClk(SpiNorSSI_Base, 16000000, SSI_FRF_MOTO_MODE_0, SSI_MODE_MASTER, SpiNorBitRate, 8);
+    SSIEnable(SpiNorSSI_Base);
+    // Drop what the FIFO may hold from before
+    while(SSIDataGetNonBlocking(SpiNorSSI_Base, &Data)){
+    }
+    uDMAControlBaseSet(uDMAControlTable);
+    uDMAChannelAssign(UDMA_CH10_SSI0RX);
+    uDMAChannelAssign(UDMA_CH11_SSI0TX);
+    uDMAChannelAttributeDisable(UDMA_CHANNEL_SSI0RX, UDMA_ATTR_ALTSELECT|UDMA_ATTR_USEBURST|UDMA_ATTR_HIGH_PRIORITY|UDMA_ATTR_REQMASK);
+    uDMAChannelAttributeDisable(UDMA_CHANNEL_SSI0TX, UDMA_ATTR_ALTSELECT|UDMA_ATTR_USEBURST|UDMA_ATTR_HIGH_PRIORITY|UDMA_ATTR_REQMASK);
+    uDMAEnable();
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorSsiTransfer
+ * Description        : One command with the chip selected: the command bytes through the FIFO,
+ *                      then the data by DMA in transfers of up to SpiNorDMAMax bytes. The task
+ *                      waits on the receive channel, a page takes 0.3 ms at 8 MHz.
+ * INPUTS             : const uint8_t *Cmd, uint32_t CmdSize (up to 8), const uint8_t *Tx,
+ *                      uint8_t *Rx, uint32_t Size
+ * RETURNS            : uint32_t 0 on success, 1 if a transfer did not complete
+ ***********************************************************************************************/
+static uint32_t SpiNorSsiTransfer(const uint8_t *Cmd,uint32_t CmdSize,const uint8_t *Tx,uint8_t *Rx,uint32_t Size){
+    uint32_t Data;
+    uint32_t Chunk;
+    uint32_t Spins;
+    MAP_GPIOPinWrite(SpiNorCS_Base, SpiNorCS_Pin, 0);
+    while(CmdSize!=0){
+        SSIDataPut(SpiNorSSI_Base, *Cmd++);
+        CmdSize--;
+    }
+    while(SSIBusy(SpiNorSSI_Base)){
+    }
+    // The bytes clocked in during the command mean nothing
+    while(SSIDataGetNonBlocking(SpiNorSSI_Base, &Data)){
+    }
+    while(Size!=0){
+        Chunk=(Size<SpiNorDMAMax)?Size:SpiNorDMAMax;
+        uDMAChannelControlSet(UDMA_CHANNEL_SSI0RX|UDMA_PRI_SELECT,
+                              UDMA_SIZE_8|UDMA_SRC_INC_NONE|((Rx!=NULL)?UDMA_DST_INC_8:UDMA_DST_INC_NONE)|UDMA_ARB_4);
+        uDMAChannelTransferSet(UDMA_CHANNEL_SSI0RX|UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                               (void *)&HWREG(SpiNorSSI_Base+SSI_O_DR), (Rx!=NULL)?(void *)Rx:(void *)&SpiNorSink, Chunk);
+        uDMAChannelControlSet(UDMA_CHANNEL_SSI0TX|UDMA_PRI_SELECT,
+                              UDMA_SIZE_8|((Tx!=NULL)?UDMA_SRC_INC_8:UDMA_SRC_INC_NONE)|UDMA_DST_INC_NONE|UDMA_ARB_4);
+        uDMAChannelTransferSet(UDMA_CHANNEL_SSI0TX|UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                               (Tx!=NULL)?(void *)Tx:(void *)&SpiNorFill, (void *)&HWREG(SpiNorSSI_Base+SSI_O_DR), Chunk);
+        uDMAChannelEnable(UDMA_CHANNEL_SSI0RX);
+        uDMAChannelEnable(UDMA_CHANNEL_SSI0TX);
+        SSIDMAEnable(SpiNorSSI_Base, SSI_DMA_RX|SSI_DMA_TX);
+        for(Spins=Chunk*SpiNorDMASpins;Spins!=0 && uDMAChannelIsEnabled(UDMA_CHANNEL_SSI0RX);Spins--){
+        }
+        SSIDMADisable(SpiNorSSI_Base, SSI_DMA_RX|SSI_DMA_TX);
+        if(Spins==0){
+            uDMAChannelDisable(UDMA_CHANNEL_SSI0TX);
+            uDMAChannelDisable(UDMA_CHANNEL_SSI0RX);
+            MAP_GPIOPinWrite(SpiNorCS_Base, SpiNorCS_Pin, SpiNorCS_Pin);
+            return 1;
+        }
+        Size-=Chunk;
+        if(Tx!=NULL){
+            Tx+=Chunk;
+        }
+        if(Rx!=NULL){
+            Rx+=Chunk;
+        }
+    }
+    MAP_GPIOPinWrite(SpiNorCS_Base, SpiNorCS_Pin, SpiNorCS_Pin);
+    return 0;
+}
@@ -0,0 +1,51 @@
+/******************************************************************************
+ * File Name: spinor_hw.h
+ *
+ * Description: Header file for the SSI bus of the external SPI NOR flash.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef HAL_SPINOR_HW_H_
+#define HAL_SPINOR_HW_H_
+
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "inc/hw_types.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/gpio.h"
+#include "driverlib/ssi.h"
+#include "driverlib/udma.h"
+#include "spinor.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* SSI0 on port A: PA2 clock, PA4 from the chip, PA5 to the chip. PA3 is driven as a GPIO chip
+ * select so it stays low for a whole command. */
+#define SpiNorSSI_Base      SSI0_BASE
+#define SpiNorCS_Base       GPIO_PORTA_BASE
+#define SpiNorCS_Pin        GPIO_PIN_3
+/* Half the 16 MHz system clock, the fastest SSI master rate */
+#define SpiNorBitRate       8000000
+/* Bytes per DMA transfer, the uDMA moves at most 1024 items */
+#define SpiNorDMAMax        1024
+/* Polls of the receive channel per byte before a transfer is given up */
+#define SpiNorDMASpins      64
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/* SSI0 with the uDMA moving the data of the commands */
+extern const SpiNorBus_t SpiNorSsi;
+
+#endif /* HAL_SPINOR_HW_H_ */
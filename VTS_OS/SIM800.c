@@ -14,11 +14,22 @@
  *                                Includes                                     *
  *******************************************************************************/
 #include "SIM800.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
+// Fragment of a constant string, sent from flash by Sim800ExchangeVector.
+#define Sim800Const(Str)    {(const uint8_t *)(Str),sizeof(Str)-1}
+// Fragment of a string built at run time.
+#define Sim800Str(Str)      {(const uint8_t *)(Str),strlen(Str)}
 // Test command to check module communication.
 uint8_t     test[5]           =   "AT\r\n";
+// Use RTS/CTS hardware flow control in both directions.
+uint8_t     SetFlowControl[13]=   "AT+IFC=2,2\r\n";
+// Save the user profile so the baud rate survives a power cycle.
+uint8_t     SaveProfile[7]    =   "AT&W\r\n";
 // Configure module for GPRS connection.
 uint8_t     SetCToGPRS[32]    =   "AT+SAPBR=3,1,\"Contype\",\"GPRS\"\r\n";
 // Set APN configuration for GPRS connection.
@@ -31,26 +42,107 @@ uint8_t     GetIP[15]         =   "AT+SAPBR=2,1\r\n";
 uint8_t     InitHTTP[14]      =   "AT+HTTPINIT\r\n";
 // Enable HTTPS for secure communication.
 uint8_t     EnableHTTPS[15]   =   "AT+HTTPSSL=1\r\n";
+// Plain HTTP for the signed reports.
+uint8_t     DisableHTTPS[15]  =   "AT+HTTPSSL=0\r\n";
 // Set CID parameter for HTTP request.
 uint8_t     SetCIDPAR[22]     =   "AT+HTTPPARA=\"CID\",1\r\n";
 // Initiate HTTP GET request.
 uint8_t     HTTPRequest[136]  =   "AT+HTTPACTION=0\r\n";
+// Initiate HTTP POST request of the data given with AT+HTTPDATA.
+uint8_t     HTTPPost[18]      =   "AT+HTTPACTION=1\r\n";
+// Set the content type of the HTTP POST body.
+uint8_t     SetContent[37]    =   "AT+HTTPPARA=\"CONTENT\",\"text/plain\"\r\n";
 // Read HTTP response from the server.
 uint8_t     HTTPResponse[18]  =   "AT+HTTPREAD\r\n";
 // Terminate HTTP service.
 uint8_t     TERMINATEHTTP[14] =   "AT+HTTPTERM\r\n";
+// Query and enable the local time update from the network (NITZ).
+uint8_t     GetCLTS[11]       =   "AT+CLTS?\r\n";
+uint8_t     SetCLTS[13]       =   "AT+CLTS=1\r\n";
+// Get the real time clock of the module.
+uint8_t     GetClock[11]      =   "AT+CCLK?\r\n";
+// Restart the module with full functionality.
+uint8_t     ResetCFUN[14]     =   "AT+CFUN=1,1\r\n";
+// Let the module sleep while DTR is high.
+uint8_t     SetSleepMode[13]  =   "AT+CSCLK=1\r\n";
+// Get the received signal strength and bit error rate.
+uint8_t     GetSignal[9]      =   "AT+CSQ\r\n";
+// Get the network registration status.
+uint8_t     GetCREG[11]       =   "AT+CREG?\r\n";
+// Get the GPRS attach status.
+uint8_t     GetCGATT[12]      =   "AT+CGATT?\r\n";
 // Connect to IP network.
 uint8_t     ConnectIP[13]     =    "AT+CGATT=1\r\n";
+// Single connection mode for the TCP/IP stack.
+uint8_t     SetCIPMUX[14]     =   "AT+CIPMUX=0\r\n";
+// Bring up the wireless connection of the TCP/IP stack.
+uint8_t     BringUpGPRS[11]   =   "AT+CIICR\r\n";
+// Get local IP address, the stack refuses to connect before it was read.
+uint8_t     GetLocalIP[11]    =   "AT+CIFSR\r\n";
+// Keep received socket data in the module until it is read with AT+CIPRXGET=2.
+uint8_t     SetCIPRXGET[15]   =   "AT+CIPRXGET=1\r\n";
+// Close the TCP/UDP connection.
+uint8_t     CloseSocket[14]   =   "AT+CIPCLOSE\r\n";
+// Select the PDU mode of the SMS commands.
+uint8_t     SetPduMode[12]    =   "AT+CMGF=0\r\n";
+// Stop and restart echoing the received characters.
+uint8_t     EchoOff[7]        =   "ATE0\r\n";
+uint8_t     EchoOn[7]         =   "ATE1\r\n";
 // Set the URL for the HTTP request.
 uint8_t     SetURL[155]       =   "AT+HTTPPARA=\"URL\",\"https://script.google.com/macros/s/AKfycbx8WQYc7m7JuC8h8yKm4WlH8M-6aSU8mOM0s3aCJVzsQ229MBlpJlXxDkZGPEPmBxV-6w/exec?";
 // Buffer to store responses and data.
 uint8_t buffer2[Sim800BufSize];
+// Set once the TCP/IP stack of the module has an IP address.
+static uint8_t Sim800IpStackUp=0;
+// Size of the last reception armed by Sim800Arm.
+static uint32_t Sim800RxSize=0;
+// Result codes that end an exchange before its response, matched at the start of a line.
+static const char *const Sim800FailLines[]={"ERROR","+CME ERROR","CONNECT FAIL","SEND FAIL","+CMS ERROR"};
+// Offsets of the slots of the link rendered by Sim800RenderLink.
+static uint8_t Sim800LatOffset;
+static uint8_t Sim800LonOffset;
+static uint8_t Sim800SeqOffset;
+static uint8_t Sim800MacOffset;
+// Hex digits of the SMS PDU being sent, followed by Ctrl-Z.
+static uint8_t Sim800PduBuf[2*Sim800SmsPduMax+1];
+// Serializes the tasks talking to the module, their exchanges yield while waiting.
+static SemaphoreHandle_t Sim800Mutex=NULL;
+// Sleep state driven through DTR, the tick of the last transition and the time spent in each state.
+static volatile uint8_t Sim800Asleep=0;
+static uint8_t Sim800SleepEnabled=0;
+static TickType_t Sim800StateTick=0;
+static TickType_t Sim800ReadyTick=0;
+static Sim800PowerStats_t Sim800Power;
+// Recovery accounting and the time waited while the scheduler does not run yet
+static Sim800RecoveryStats_t Sim800Recovery;
+static uint32_t Sim800BusyMs=0;
 
 
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
-static uint32_t Sim800SendCommand(uint8_t *Command,char *response);
+static void Sim800Arm(uint32_t Size);
+static uint32_t Sim800Configure(void);
+static uint32_t Sim800Probe(void);
+static uint32_t Sim800WaitReady(void);
+static void Sim800PressPowerKey(uint32_t PressMs);
+static uint32_t Sim800ClockMs(void);
+static uint32_t Sim800Exchange(const uint8_t *Command,uint32_t ComLen,const char *Response,uint32_t TimeoutMs);
+static uint32_t Sim800Transact(const uint8_t *Command,uint32_t ComLen,const char *Response,uint32_t TimeoutMs,uint32_t *ResLen);
+static uint32_t Sim800ExchangeVector(const GSMFragment_t *Fragments,uint32_t Count,const char *Response,uint32_t TimeoutMs);
+static uint32_t Sim800Await(const char *Response,uint32_t ResLen,uint32_t TimeoutMs);
+static uint32_t Sim800Query(const uint8_t *Command,const char *Prefix,uint32_t *Values,uint8_t Count);
+static uint32_t Sim800StartIpStack(void);
+static uint32_t Sim800GetLocalIp(void);
+static char *Sim800FindLine(const char *Str,uint32_t Size);
+static char *Sim800FindAddress(uint32_t Size);
+static uint8_t Sim800Failed(uint32_t Size);
+static void Sim800Sleep(void);
+static void Sim800CountState(TickType_t Now);
+static void Sim800DelayMs(uint32_t Ms);
+static char *Sim800UIntToStr(char *Str,uint32_t Value);
+static void Sim800PatchSlot(char *Slot,uint8_t Width,const char *Value);
+static uint32_t Sim800RenderSlots(char *RQSTLink,uint32_t Len);
 
 
 /*******************************************************************************
@@ -79,56 +171,1369 @@ void Sim800Init(void)
  ***********************************************************************************************/
 uint32_t Sim800SetNetConnectivity(void)
 {
-	while(Sim800SendCommand(test,"OK\r\n")!=Gsmok);// Wait for the test command to be successfully executed.
-	Sim800SendCommand(SetCToGPRS,"OK\r\n"); // Configure the module for GPRS connection.
-	Sim800SendCommand(SetAPNCfg, "OK\r\n"); //Set APN to your network provider
-	Sim800SendCommand(ActGPRS,"OK\r\n");    // Set APN to the network provider
-	Sim800SendCommand(InitHTTP,"OK\r\n");
-	return Gsmok;
+    if(Sim800Mutex==NULL)
+    {
+        Sim800Mutex=xSemaphoreCreateMutex();
+    }
+    // A module that does not answer goes through the recovery steps instead of blocking the start up
+    if(Sim800Probe()!=Gsmok)
+    {
+        return Sim800Recover();
+    }
+    return Sim800Configure();
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Recover
+ * Description        : Bring a module that stopped answering back, escalating from the cheapest
+ *                      step to the most disruptive one: AT probes (with a new baud negotiation),
+ *                      a restart with AT+CFUN=1,1, a pulse on RESET and finally a power cycle
+ *                      through PWRKEY. The configuration is restored once it answers again.
+ *                      Called with the module taken.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800Recover(void)
+{
+    uint32_t Start=Sim800ClockMs();
+    uint8_t Level;
+    Sim800Recovery.Attempts++;
+    for(Level=Sim800RecoverProbe;Level<Sim800RecoverLevels;Level++)
+    {
+        switch(Level)
+        {
+        case Sim800RecoverCfun:
+            // Only a module that still parses commands restarts this way
+            Sim800Exchange(ResetCFUN,strlen((const char*)ResetCFUN),"OK",Sim800CmdTimeout);
+            Sim800DelayMs(Sim800BootTime);
+            break;
+#if GSMPowerControl
+        case Sim800RecoverReset:
+            GSMSetReset(1);
+            Sim800DelayMs(Sim800ResetPulse);
+            GSMSetReset(0);
+            Sim800DelayMs(Sim800BootTime);
+            break;
+        case Sim800RecoverPower:
+            // The state of the module is not known, a first press may switch it on instead of off
+            Sim800PressPowerKey(Sim800PowerOffPulse);
+            Sim800DelayMs(Sim800PowerOffTime);
+            if(Sim800Probe()==Gsmok)
+            {
+                break;
+            }
+            Sim800PressPowerKey(Sim800PowerOnPulse);
+            Sim800DelayMs(Sim800BootTime);
+            break;
+#endif
+        default:
+            break;
+        }
+        if(Sim800WaitReady()==Gsmok)
+        {
+            break;
+        }
+    }
+    if(Level==Sim800RecoverLevels)
+    {
+        Sim800Recovery.Failed++;
+        return GsmError;
+    }
+    Sim800Recovery.Recovered[Level]++;
+    Sim800Configure();
+    Sim800Recovery.LastMs=Sim800ClockMs()-Start;
+    Sim800Recovery.TotalMs+=Sim800Recovery.LastMs;
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800GetRecoveryStats
+ * Description        : Recovery counts and the mean time to recover since the start up.
+ * INPUTS             : Sim800RecoveryStats_t *Stats
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sim800GetRecoveryStats(Sim800RecoveryStats_t *Stats)
+{
+    uint32_t Recovered=Sim800Recovery.Attempts-Sim800Recovery.Failed;
+    *Stats=Sim800Recovery;
+    Stats->MeanMs=Recovered?(Sim800Recovery.TotalMs/Recovered):0;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Configure
+ * Description        : Restore the configuration of an answering module: baud rate, flow control,
+ *                      bearer, HTTP service, network time and sleep mode. None of the steps waits
+ *                      longer than its timeout, the bearer and HTTP commands answer ERROR when
+ *                      the module kept them from before and that is not a failure.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800Configure(void)
+{
+    // Move the link to the fast rate before anything else is exchanged
+    if(Sim800NegotiateBaudRate(GSMFastBaud)==Gsmok)
+    {
+#if GSMFlowControl
+        Sim800Exchange(SetFlowControl,strlen((const char*)SetFlowControl),"OK",Sim800CmdTimeout);
+#endif
+    }
+    // Configure the module for GPRS connection with the APN of the network provider
+    Sim800Exchange(SetCToGPRS,strlen((const char*)SetCToGPRS),"OK",Sim800CmdTimeout);
+    Sim800Exchange(SetAPNCfg,strlen((const char*)SetAPNCfg),"OK",Sim800CmdTimeout);
+    Sim800Exchange(ActGPRS,strlen((const char*)ActGPRS),"OK",Sim800ConnectTimeout);
+    Sim800Exchange(InitHTTP,strlen((const char*)InitHTTP),"OK",Sim800CmdTimeout);
+    // The TCP/IP stack has to be brought up again after a restart
+    Sim800IpStackUp=0;
+    // Let the network time zone and clock updates set the clock of the module
+    Sim800EnableNetworkTime();
+#if GSMSleepControl
+    // From now on the module sleeps whenever nobody holds it (Sim800Give)
+    if(Sim800Exchange(SetSleepMode,strlen((const char*)SetSleepMode),"OK",Sim800CmdTimeout)==Gsmok)
+    {
+        Sim800SleepEnabled=1;
+    }
+#endif
+    return Gsmok;
+}
+/***********************************************************************************************
+ * Function Name      : Sim800NegotiateBaudRate
+ * Description        : Bring the module and UART2 to a faster baud rate. The module may already
+ *                      run at it from a previous negotiation, otherwise it is reached at the
+ *                      default rate, told to switch with AT+IPR and checked at the new rate.
+ *                      UART2 stays at the default rate if the module does not follow.
+ * INPUTS             : uint32_t Baud
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800NegotiateBaudRate(uint32_t Baud)
+{
+    char BaudStr[11];
+    uint8_t Try;
+    GSMFragment_t Command[3]={Sim800Const("AT+IPR="),{NULL,0},Sim800Const("\r\n")};
+    GSMSetBaudRate(Baud);
+    if(Sim800Exchange(test,strlen((const char*)test),"OK",Sim800ProbeTimeout)==Gsmok)
+    {
+        return Gsmok;
+    }
+    GSMSetBaudRate(GSMDefaultBaud);
+    // The first "AT" only lets an autobauding module lock on the rate
+    for(Try=0;Try<3;Try++)
+    {
+        if(Sim800Exchange(test,strlen((const char*)test),"OK",Sim800ProbeTimeout)==Gsmok)
+        {
+            break;
+        }
+    }
+    if(Try==3)
+    {
+        return GsmError;
+    }
+    Command[1].Data=(const uint8_t *)Sim800UIntToStr(BaudStr,Baud);
+    Command[1].Size=strlen(BaudStr);
+    if(Sim800ExchangeVector(Command,3,"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    GSMSetBaudRate(Baud);
+    if(Sim800Exchange(test,strlen((const char*)test),"OK",Sim800ProbeTimeout)!=Gsmok)
+    {
+        GSMSetBaudRate(GSMDefaultBaud);
+        return GsmError;
+    }
+    Sim800Exchange(SaveProfile,strlen((const char*)SaveProfile),"OK",Sim800CmdTimeout);
+    return Gsmok;
 }
+
 /***********************************************************************************************
  * Function Name      : Sim800PrepareLink
- * Description        : Prepare the HTTP request link with latitude and longitude.
- * INPUTS             : char *RQSTLink, char *Lon, char *Lat
+ * Description        : Prepare the HTTP request link with the report sequence number,
+ *                      latitude and longitude.
+ * INPUTS             : char *RQSTLink, uint32_t Seq, char *Lon, char *Lat
  * RETURNS            : void
  ***********************************************************************************************/
-void Sim800PrepareLink(char *RQSTLink,char *Lon, char *Lat){
-    strcpy(RQSTLink,(char *)SetURL); // Copy the base URL for the HTTP request into the RQSTLink buffer.
-    strcat(RQSTLink,"lat=");         // Append "lat=" followed by the provided latitude value.
-    strcat(RQSTLink,Lat);
-    strcat(RQSTLink,"&");            // Append "&" separator between latitude and longitude parameters.
-    strcat(RQSTLink,"lon=");
-    strcat(RQSTLink,Lon);            // Append "lon=" followed by the provided longitude value.
-    strcat(RQSTLink,"\"\r\n");
+void Sim800PrepareLink(char *RQSTLink,uint32_t Seq,char *Lon, char *Lat){
+    uint8_t Index;
+    // Only the slots of the template rendered by Sim800RenderLink are written
+    Sim800PatchSlot(&RQSTLink[Sim800LatOffset],Sim800LatSlot,Lat);
+    Sim800PatchSlot(&RQSTLink[Sim800LonOffset],Sim800LonSlot,Lon);
+    for(Index=Sim800SeqSlot;Index!=0;Index--)
+    {
+        RQSTLink[Sim800SeqOffset+Index-1]=(char)('0'+(Seq%10));
+        Seq/=10;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800RenderLink
+ * Description        : Render the HTTP request link once with fixed width slots for the latitude,
+ *                      the longitude and the sequence number, patched by Sim800PrepareLink for
+ *                      every report. The slots are zero padded on the left, which keeps the
+ *                      numeric values.
+ * INPUTS             : char *RQSTLink (Sim800LinkSize bytes)
+ * RETURNS            : uint32_t length of the link
+ ***********************************************************************************************/
+uint32_t Sim800RenderLink(char *RQSTLink){
+    uint32_t Len=strlen((const char*)SetURL);
+    memcpy(RQSTLink,SetURL,Len);
+    Len=Sim800RenderSlots(RQSTLink,Len);
+    memcpy(&RQSTLink[Len],"\"\r\n",4);
+    return Len+3;
 }
+
 /***********************************************************************************************
- * Function Name      : Sim800SendCommand
- * Description        : Send an AT command to SIM800 module and receive its response.
- * INPUTS             : uint8_t *Command,char *response
+ * Function Name      : Sim800RenderSignedLink
+ * Description        : Render the link of the signed reports: the given URL, the same slots as
+ *                      Sim800RenderLink and a "mac" slot written by Sim800SignLink.
+ * INPUTS             : char *RQSTLink (Sim800LinkSize bytes), const char *Url (ends with '?' or '&')
+ * RETURNS            : uint32_t length of the link
+ ***********************************************************************************************/
+uint32_t Sim800RenderSignedLink(char *RQSTLink,const char *Url){
+    uint32_t Len=strlen("AT+HTTPPARA=\"URL\",\"");
+    memcpy(RQSTLink,"AT+HTTPPARA=\"URL\",\"",Len);
+    memcpy(&RQSTLink[Len],Url,strlen(Url));
+    Len+=strlen(Url);
+    Len=Sim800RenderSlots(RQSTLink,Len);
+    memcpy(&RQSTLink[Len],"&mac=",5);
+    Len+=5;
+    Sim800MacOffset=Len;
+    memset(&RQSTLink[Len],'0',Sim800MacSlot);
+    Len+=Sim800MacSlot;
+    memcpy(&RQSTLink[Len],"\"\r\n",4);
+    return Len+3;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800SignLink
+ * Description        : Write the truncated MAC of the report into the slot of a link rendered by
+ *                      Sim800RenderSignedLink, in lower case hex.
+ * INPUTS             : char *RQSTLink, const uint8_t *Mac (Sim800MacSlot/2 bytes)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sim800SignLink(char *RQSTLink,const uint8_t *Mac){
+    uint8_t Index;
+    for(Index=0;Index<Sim800MacSlot/2;Index++)
+    {
+        RQSTLink[Sim800MacOffset+2*Index]="0123456789abcdef"[Mac[Index]>>4];
+        RQSTLink[Sim800MacOffset+2*Index+1]="0123456789abcdef"[Mac[Index]&0x0F];
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800BatchLinkRoom
+ * Description        : Characters a packed batch may take in a link of Sim800BatchLinkSize bytes.
+ * INPUTS             : void
  * RETURNS            : uint32_t
  ***********************************************************************************************/
-uint32_t Sim800SendCommand(uint8_t *Command,char *response)
+uint32_t Sim800BatchLinkRoom(void){
+    // "b=", the closing quote, the line end and the terminator
+    return Sim800BatchLinkSize-strlen((const char*)SetURL)-6;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800PrepareBatchLink
+ * Description        : Prepare the HTTP request link of several reports packed into the single
+ *                      "b" parameter, see HttpGetBatchTransport.
+ * INPUTS             : char *RQSTLink (Sim800BatchLinkSize bytes), const char *Packed (URL safe),
+ *                      uint32_t PackedLen (at most Sim800BatchLinkRoom)
+ * RETURNS            : uint32_t length of the link
+ ***********************************************************************************************/
+uint32_t Sim800PrepareBatchLink(char *RQSTLink,const char *Packed,uint32_t PackedLen){
+    uint32_t Len=strlen((const char*)SetURL);
+    memcpy(RQSTLink,SetURL,Len);
+    memcpy(&RQSTLink[Len],"b=",2);
+    Len+=2;
+    memcpy(&RQSTLink[Len],Packed,PackedLen);
+    Len+=PackedLen;
+    memcpy(&RQSTLink[Len],"\"\r\n",4);
+    return Len+3;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800RenderSlots
+ * Description        : Append the zero filled latitude, longitude and sequence number slots and
+ *                      record where they start.
+ * INPUTS             : char *RQSTLink, uint32_t Len (length of the link so far)
+ * RETURNS            : uint32_t length of the link
+ ***********************************************************************************************/
+static uint32_t Sim800RenderSlots(char *RQSTLink,uint32_t Len){
+    memcpy(&RQSTLink[Len],"lat=",4);
+    Len+=4;
+    Sim800LatOffset=Len;
+    memset(&RQSTLink[Len],'0',Sim800LatSlot);
+    Len+=Sim800LatSlot;
+    memcpy(&RQSTLink[Len],"&lon=",5);
+    Len+=5;
+    Sim800LonOffset=Len;
+    memset(&RQSTLink[Len],'0',Sim800LonSlot);
+    Len+=Sim800LonSlot;
+    // "seq=" lets the server detect gaps and duplicates
+    memcpy(&RQSTLink[Len],"&seq=",5);
+    Len+=5;
+    Sim800SeqOffset=Len;
+    memset(&RQSTLink[Len],'0',Sim800SeqSlot);
+    return Len+Sim800SeqSlot;
+}
+/***********************************************************************************************
+ * Function Name      : Sim800HttpAction
+ * Description        : Send an AT+HTTPACTION command and wait for the "+HTTPACTION: <method>,
+ *                      <status>,<len>" URC that carries the real result of the request. The "OK"
+ *                      to the command only means the request was started.
+ * INPUTS             : uint8_t *Command, uint16_t *HttpStatus (0 if no URC was received)
+ * RETURNS            : uint32_t Gsmok for a 2xx status, GsmError otherwise
+ ***********************************************************************************************/
+uint32_t Sim800HttpAction(uint8_t *Command,uint16_t *HttpStatus)
 {
-    char *P={0};
-    char *err={0};
-    uint32_t reslen =strlen((const char*)response);
+    char *P=NULL;
+    uint32_t Waited=0;
     uint32_t comlen =strlen((const char*)Command);
-    //The Response buffer is supposed to the size of the transmitted data + received data +20 margin error
-    reslen+=comlen+20;
-    GSMReceiveResponse(buffer2, reslen);
-    GSMSend((uint8_t *)Command,comlen);
-    P=strstr((const char*)buffer2,(const char*)response);
-    while(*P!=response[0])
+    uint32_t reslen =comlen+Sim800HttpActionResSize;
+    *HttpStatus=0;
+    Sim800Arm(reslen);
+    GSMSend(Command,comlen);
+    while(Waited<Sim800HttpActionTimeout)
     {
-        P=strstr((const char*)buffer2,(const char*)response);
-        err=strstr((const char*)buffer2,"ERROR\r\n");
-        if(*err=='E')
+        if(Sim800Failed(reslen))
         {
-            memset(buffer2,'\0',reslen);
-            return GsmError;
+            break;
         }
+        P=Sim800FindLine("+HTTPACTION:",reslen);
+        // Only parse once the whole URC line has been received
+        if(P!=NULL && memchr(P,'\n',(char *)buffer2+reslen-P)!=NULL)
+        {
+            P=strchr(P,',');
+            if(P!=NULL)
+            {
+                *HttpStatus=(uint16_t)strtoul(P+1,NULL,10);
+            }
+            break;
+        }
+        Sim800DelayMs(Sim800PollPeriod);
+        Waited+=Sim800PollPeriod;
     }
     //Reset buffer to recieve new info
     memset(buffer2,'\0',reslen);
+    if(*HttpStatus>=200 && *HttpStatus<300)
+    {
+        return Gsmok;
+    }
+    return GsmError;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Take
+ * Description        : Get exclusive use of the module for a sequence of exchanges.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sim800Take(void)
+{
+    TickType_t Now;
+    xSemaphoreTake(Sim800Mutex,portMAX_DELAY);
+    Sim800WakeUp();
+    // Only the part of the wake up latency that did not elapse yet is waited for
+    Now=xTaskGetTickCount();
+    if((int32_t)(Sim800ReadyTick-Now)>0)
+    {
+        vTaskDelay(Sim800ReadyTick-Now);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Give
+ * Description        : Release the module taken by Sim800Take.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sim800Give(void)
+{
+    Sim800Sleep();
+    xSemaphoreGive(Sim800Mutex);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800WakeUp
+ * Description        : Pull DTR low to wake the module. It only returns the call, the next
+ *                      Sim800Take waits for what is left of the wake up latency, so a scheduler
+ *                      that wakes the module ahead of a report window hides the latency.
+ *                      Safe to call from a timer callback.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sim800WakeUp(void)
+{
+    TickType_t Now;
+    taskENTER_CRITICAL();
+    if(Sim800Asleep)
+    {
+        Now=xTaskGetTickCount();
+        Sim800CountState(Now);
+        GSMSetDTR(0);
+        Sim800Asleep=0;
+        Sim800Power.Wakeups++;
+        Sim800ReadyTick=Now+pdMS_TO_TICKS(Sim800WakeLatency);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800GetPowerStats
+ * Description        : Time spent asleep and awake since the sleep mode was enabled.
+ * INPUTS             : Sim800PowerStats_t *Stats
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sim800GetPowerStats(Sim800PowerStats_t *Stats)
+{
+    taskENTER_CRITICAL();
+    if(Sim800SleepEnabled)
+    {
+        Sim800CountState(xTaskGetTickCount());
+    }
+    *Stats=Sim800Power;
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Sleep
+ * Description        : Raise DTR so the module sleeps until the next Sim800WakeUp. Called with the
+ *                      module taken, the exchanges of the holder are over.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void Sim800Sleep(void)
+{
+    if(!Sim800SleepEnabled)
+    {
+        return;
+    }
+    taskENTER_CRITICAL();
+    if(!Sim800Asleep)
+    {
+        Sim800CountState(xTaskGetTickCount());
+        GSMSetDTR(1);
+        Sim800Asleep=1;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800CountState
+ * Description        : Add the time since the last transition to the current sleep state.
+ * INPUTS             : TickType_t Now
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void Sim800CountState(TickType_t Now)
+{
+    uint32_t Elapsed=(Now-Sim800StateTick)*portTICK_PERIOD_MS;
+    if(Sim800Asleep)
+    {
+        Sim800Power.AsleepMs+=Elapsed;
+    }
+    else
+    {
+        Sim800Power.AwakeMs+=Elapsed;
+    }
+    Sim800StateTick=Now;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800GetSignalQuality
+ * Description        : Read the signal strength with AT+CSQ.
+ * INPUTS             : uint8_t *Rssi (0..31, 99 when not known)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800GetSignalQuality(uint8_t *Rssi)
+{
+    uint32_t Values[2];
+    *Rssi=99;
+    if(Sim800Query(GetSignal,"+CSQ:",Values,2)!=Gsmok)
+    {
+        return GsmError;
+    }
+    *Rssi=(uint8_t)Values[0];
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800GetRegistration
+ * Description        : Read the network registration status with AT+CREG?.
+ * INPUTS             : uint8_t *Registered (1 when registered home or roaming)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800GetRegistration(uint8_t *Registered)
+{
+    uint32_t Values[2];
+    *Registered=0;
+    if(Sim800Query(GetCREG,"+CREG:",Values,2)!=Gsmok)
+    {
+        return GsmError;
+    }
+    *Registered=(Values[1]==1 || Values[1]==5);
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800GetAttach
+ * Description        : Read the GPRS attach status with AT+CGATT?.
+ * INPUTS             : uint8_t *Attached
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800GetAttach(uint8_t *Attached)
+{
+    uint32_t Values[1];
+    *Attached=0;
+    if(Sim800Query(GetCGATT,"+CGATT:",Values,1)!=Gsmok)
+    {
+        return GsmError;
+    }
+    *Attached=(Values[0]==1);
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800EnableNetworkTime
+ * Description        : Let the network set the clock of the module (AT+CLTS=1). The setting is
+ *                      saved to the profile and used from the next power up, so it is only
+ *                      written when it is not set yet.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800EnableNetworkTime(void)
+{
+    uint32_t Values[1];
+    if(Sim800Query(GetCLTS,"+CLTS:",Values,1)!=Gsmok)
+    {
+        return GsmError;
+    }
+    if(Values[0]==1)
+    {
+        return Gsmok;
+    }
+    if(Sim800Exchange(SetCLTS,strlen((const char*)SetCLTS),"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    return Sim800Exchange(SaveProfile,strlen((const char*)SaveProfile),"OK",Sim800CmdTimeout);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800GetClock
+ * Description        : Read the clock of the module with AT+CCLK?, answered with
+ *                      +CCLK: "yy/MM/dd,hh:mm:ss+zz".
+ * INPUTS             : Sim800Clock_t *Clock
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800GetClock(Sim800Clock_t *Clock)
+{
+    char *P=NULL;
+    uint8_t Field[7];
+    uint8_t Index;
+    uint32_t Status;
+    uint32_t comlen=strlen((const char*)GetClock);
+    uint32_t reslen=comlen+Sim800ClockResSize;
+    Sim800Arm(reslen);
+    GSMSend(GetClock,comlen);
+    Status=Sim800Await("OK",reslen,Sim800CmdTimeout);
+    if(Status==Gsmok)
+    {
+        P=Sim800FindLine("+CCLK: \"",reslen);
+        if(P==NULL)
+        {
+            Status=GsmError;
+        }
+        else
+        {
+            // Six two digit fields and the zone, each preceded by one separator
+            P+=7;
+            for(Index=0;Index<7;Index++)
+            {
+                if(P[1]<'0' || P[1]>'9' || P[2]<'0' || P[2]>'9')
+                {
+                    Status=GsmError;
+                    break;
+                }
+                Field[Index]=(uint8_t)((P[1]-'0')*10+(P[2]-'0'));
+                P+=3;
+            }
+        }
+    }
+    if(Status==Gsmok)
+    {
+        Clock->Year=Field[0];
+        Clock->Month=Field[1];
+        Clock->Day=Field[2];
+        Clock->Hour=Field[3];
+        Clock->Minute=Field[4];
+        Clock->Second=Field[5];
+        // The zone sign is the separator before the last field
+        Clock->Zone=(P[-3]=='-') ? -(int8_t)Field[6] : (int8_t)Field[6];
+    }
+    //Reset buffer to recieve new info
+    memset(buffer2,'\0',reslen);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800CheckHttps
+ * Description        : Check that the HTTP service answers by enabling HTTPS on it.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800CheckHttps(void)
+{
+    return Sim800Exchange(EnableHTTPS,strlen((const char*)EnableHTTPS),"OK",Sim800CmdTimeout);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800CheckHttp
+ * Description        : Check that the HTTP service answers by switching it to plain HTTP.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800CheckHttp(void)
+{
+    return Sim800Exchange(DisableHTTPS,strlen((const char*)DisableHTTPS),"OK",Sim800CmdTimeout);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800HttpGet
+ * Description        : Issue an HTTP GET of a link prepared by Sim800PrepareLink or
+ *                      Sim800PrepareBatchLink. The echo of a link longer than the response buffer
+ *                      is turned off while it is sent.
+ * INPUTS             : uint8_t *Link, uint32_t LinkLen, uint16_t *HttpStatus
+ * RETURNS            : uint32_t Gsmok for a 2xx status, GsmError otherwise
+ ***********************************************************************************************/
+uint32_t Sim800HttpGet(uint8_t *Link,uint32_t LinkLen,uint16_t *HttpStatus)
+{
+    uint32_t Result;
+    uint8_t Quiet=(LinkLen+24>=Sim800BufSize);
+    *HttpStatus=0;
+    if(Sim800Exchange(SetCIDPAR,strlen((const char*)SetCIDPAR),"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    if(Quiet && Sim800Exchange(EchoOff,strlen((const char*)EchoOff),"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    Result=Sim800Exchange(Link,LinkLen,"OK",Sim800CmdTimeout);
+    if(Quiet)
+    {
+        Sim800Exchange(EchoOn,strlen((const char*)EchoOn),"OK",Sim800CmdTimeout);
+    }
+    if(Result!=Gsmok)
+    {
+        return GsmError;
+    }
+    return Sim800HttpAction(HTTPRequest,HttpStatus);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800PreparePostLink
+ * Description        : Prepare the HTTP request link without parameters, the data goes in the body.
+ * INPUTS             : char *RQSTLink (Sim800LinkSize bytes)
+ * RETURNS            : uint32_t length of the link
+ ***********************************************************************************************/
+uint32_t Sim800PreparePostLink(char *RQSTLink)
+{
+    uint32_t Len=strlen((const char*)SetURL);
+    memcpy(RQSTLink,SetURL,Len);
+    memcpy(&RQSTLink[Len],"\"\r\n",4);
+    return Len+3;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800HttpPost
+ * Description        : Issue an HTTP POST of a body to a link prepared by Sim800PreparePostLink.
+ *                      The body is handed to the module with AT+HTTPDATA after its "DOWNLOAD".
+ * INPUTS             : uint8_t *Link, uint32_t LinkLen, const uint8_t *Body, uint32_t BodySize,
+ *                      uint16_t *HttpStatus
+ * RETURNS            : uint32_t Gsmok for a 2xx status, GsmError otherwise
+ ***********************************************************************************************/
+uint32_t Sim800HttpPost(uint8_t *Link,uint32_t LinkLen,const uint8_t *Body,uint32_t BodySize,uint16_t *HttpStatus)
+{
+    char SizeStr[11];
+    char TimeStr[11];
+    *HttpStatus=0;
+    if(Sim800Exchange(SetCIDPAR,strlen((const char*)SetCIDPAR),"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    if(Sim800Exchange(Link,LinkLen,"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    if(Sim800Exchange(SetContent,strlen((const char*)SetContent),"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    GSMFragment_t Command[5]={Sim800Const("AT+HTTPDATA="),Sim800Str(Sim800UIntToStr(SizeStr,BodySize)),
+                              Sim800Const(","),Sim800Str(Sim800UIntToStr(TimeStr,Sim800HttpDataTimeout)),
+                              Sim800Const("\r\n")};
+    if(Sim800ExchangeVector(Command,5,"DOWNLOAD",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    if(Sim800Exchange(Body,BodySize,"OK",Sim800HttpDataTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    return Sim800HttpAction(HTTPPost,HttpStatus);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800SocketOpen
+ * Description        : Open a connection through the TCP/IP stack of the module. The stack is
+ *                      brought up on the first call. The connection stays open between reports.
+ * INPUTS             : const char *Mode ("TCP" or "UDP"), const char *Host, uint16_t Port
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800SocketOpen(const char *Mode,const char *Host,uint16_t Port)
+{
+    char PortStr[11];
+    GSMFragment_t Command[7]={Sim800Const("AT+CIPSTART=\""),Sim800Str(Mode),Sim800Const("\",\""),
+                              Sim800Str(Host),Sim800Const("\",\""),Sim800Str(Sim800UIntToStr(PortStr,Port)),
+                              Sim800Const("\"\r\n")};
+    if(!Sim800IpStackUp && Sim800StartIpStack()!=Gsmok)
+    {
+        return GsmError;
+    }
+    // "ALREADY CONNECT" is accepted as well as "CONNECT OK"
+    if(Sim800ExchangeVector(Command,7,"CONNECT",Sim800ConnectTimeout)!=Gsmok)
+    {
+        // Bring the stack up again on the next attempt in case the bearer was lost
+        Sim800IpStackUp=0;
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800ResolveHost
+ * Description        : Resolve a host name with AT+CDNSGIP. The "OK" only starts the lookup, the
+ *                      result comes in the URC +CDNSGIP: 1,"<host>","<ip>"[,"<ip2>"] or
+ *                      +CDNSGIP: 0,<error>. The TCP/IP stack is brought up first if needed.
+ * INPUTS             : const char *Host, char *Ip, uint32_t IpSize
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800ResolveHost(const char *Host,char *Ip,uint32_t IpSize)
+{
+    char *P;
+    char *End;
+    uint32_t Status=GsmError;
+    uint32_t reslen;
+    GSMFragment_t Command[3]={Sim800Const("AT+CDNSGIP=\""),Sim800Str(Host),Sim800Const("\"\r\n")};
+    if(!Sim800IpStackUp && Sim800StartIpStack()!=Gsmok)
+    {
+        return GsmError;
+    }
+    // Echo, "OK", the URC with the host and two addresses and margin
+    reslen=2*Command[1].Size+Command[0].Size+Command[2].Size+64;
+    if(reslen>=Sim800BufSize)
+    {
+        return GsmError;
+    }
+    Sim800Arm(reslen);
+    GSMSendVector(Command,3);
+    if(Sim800Await("+CDNSGIP:",reslen,Sim800ConnectTimeout)==Gsmok)
+    {
+        P=Sim800FindLine("+CDNSGIP:",reslen);
+        // Skip "+CDNSGIP: 1," and the quoted host to the opening quote of the first address
+        if(P[10]=='1' && (P=strchr(P+12,'"'))!=NULL && (P=strchr(P+1,'"'))!=NULL
+                && (P=strchr(P+1,'"'))!=NULL && (End=strchr(P+1,'"'))!=NULL && (uint32_t)(End-P-1)<IpSize)
+        {
+            memcpy(Ip,P+1,End-P-1);
+            Ip[End-P-1]='\0';
+            Status=Gsmok;
+        }
+    }
+    memset(buffer2,'\0',reslen);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800SocketSend
+ * Description        : Send a block of data on the open connection using AT+CIPSEND.
+ * INPUTS             : const uint8_t *Data, uint32_t DataSize
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800SocketSend(const uint8_t *Data,uint32_t DataSize)
+{
+    char SizeStr[11];
+    GSMFragment_t Command[3]={Sim800Const("AT+CIPSEND="),Sim800Str(Sim800UIntToStr(SizeStr,DataSize)),
+                              Sim800Const("\r\n")};
+    // Wait for the "> " prompt before the data is written
+    if(Sim800ExchangeVector(Command,3,">",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    return Sim800Exchange(Data,DataSize,"SEND OK",Sim800CmdTimeout);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800SocketReceive
+ * Description        : Read the data the server sent on the open connection. The module holds it
+ *                      until it is read, so the tasks can poll for it between their exchanges.
+ *                      The reply is "+CIPRXGET: 2,<n>,<left>" followed by n bytes of data.
+ * INPUTS             : uint8_t *Data, uint32_t MaxSize, uint32_t *Received
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800SocketReceive(uint8_t *Data,uint32_t MaxSize,uint32_t *Received)
+{
+    char SizeStr[11];
+    char *P=NULL;
+    char *Start=NULL;
+    uint32_t Count=0;
+    uint32_t Waited=0;
+    uint32_t Status=GsmError;
+    uint32_t reslen;
+    GSMFragment_t Command[3]={Sim800Const("AT+CIPRXGET=2,"),Sim800Str(Sim800UIntToStr(SizeStr,MaxSize)),
+                              Sim800Const("\r\n")};
+    *Received=0;
+    // Echo, header line, data, "OK" and margin
+    reslen=Command[0].Size+Command[1].Size+Command[2].Size+MaxSize+48;
+    if(reslen>=Sim800BufSize)
+    {
+        return GsmError;
+    }
+    Sim800Arm(reslen);
+    GSMSendVector(Command,3);
+    while(Waited<Sim800CmdTimeout)
+    {
+        if(Start==NULL)
+        {
+            if(Sim800Failed(reslen))
+            {
+                break;
+            }
+            P=Sim800FindLine("+CIPRXGET: 2,",reslen);
+            if(P!=NULL && memchr(P,'\n',(char *)buffer2+reslen-P)!=NULL)
+            {
+                Count=strtoul(P+13,NULL,10);
+                Start=(char *)memchr(P,'\n',(char *)buffer2+reslen-P)+1;
+                if(Count>MaxSize)
+                {
+                    break;
+                }
+            }
+        }
+        // The data may hold zero bytes, wait for the DMA to have received all of it
+        if(Start!=NULL && GSMGetRxByteCount()>=(uint32_t)(Start-(char *)buffer2)+Count)
+        {
+            memcpy(Data,Start,Count);
+            *Received=Count;
+            Status=Gsmok;
+            break;
+        }
+        Sim800DelayMs(Sim800PollPeriod);
+        Waited+=Sim800PollPeriod;
+    }
+    //Let the trailing "OK" arrive before the buffer is reused
+    Sim800DelayMs(Sim800PollPeriod);
+    memset(buffer2,'\0',reslen);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800SocketClose
+ * Description        : Close the connection opened by Sim800SocketOpen.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sim800SocketClose(void)
+{
+    Sim800Exchange(CloseSocket,strlen((const char*)CloseSocket),"CLOSE OK",Sim800CmdTimeout);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800SmsSendPdu
+ * Description        : Send an SMS with AT+CMGS in PDU mode. The PDU starts with the SMSC
+ *                      information (a single 0 octet for the default SMSC) followed by the TPDU.
+ *                      The hex digits are longer than the response buffer, so the echo is turned
+ *                      off while they are written.
+ * INPUTS             : const uint8_t *Pdu, uint32_t PduSize (octets)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Sim800SmsSendPdu(const uint8_t *Pdu,uint32_t PduSize)
+{
+    static const char Hex[]="0123456789ABCDEF";
+    char SizeStr[11];
+    GSMFragment_t Command[3];
+    uint32_t Index;
+    uint32_t Status;
+    if(PduSize==0 || PduSize>Sim800SmsPduMax || (uint32_t)Pdu[0]+1>=PduSize)
+    {
+        return GsmError;
+    }
+    for(Index=0;Index<PduSize;Index++)
+    {
+        Sim800PduBuf[2*Index]=Hex[Pdu[Index]>>4];
+        Sim800PduBuf[2*Index+1]=Hex[Pdu[Index]&0x0F];
+    }
+    Sim800PduBuf[2*PduSize]=0x1A;
+    if(Sim800Exchange(SetPduMode,strlen((const char*)SetPduMode),"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    if(Sim800Exchange(EchoOff,strlen((const char*)EchoOff),"OK",Sim800CmdTimeout)!=Gsmok)
+    {
+        return GsmError;
+    }
+    // The length given to AT+CMGS leaves out the SMSC information
+    Command[0].Data=(const uint8_t *)"AT+CMGS=";
+    Command[0].Size=8;
+    Command[1].Data=(const uint8_t *)Sim800UIntToStr(SizeStr,PduSize-1-Pdu[0]);
+    Command[1].Size=strlen(SizeStr);
+    Command[2].Data=(const uint8_t *)"\r";
+    Command[2].Size=1;
+    Status=Sim800ExchangeVector(Command,3,">",Sim800CmdTimeout);
+    if(Status==Gsmok)
+    {
+        Status=Sim800Exchange(Sim800PduBuf,2*PduSize+1,"+CMGS:",Sim800SmsTimeout);
+    }
+    else
+    {
+        // Leave the prompt without sending anything
+        Sim800PduBuf[0]=0x1B;
+        Sim800Exchange(Sim800PduBuf,1,"OK",Sim800CmdTimeout);
+    }
+    Sim800Exchange(EchoOn,strlen((const char*)EchoOn),"OK",Sim800CmdTimeout);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800StartIpStack
+ * Description        : Bring up the TCP/IP stack of the module with the APN set by AT+CSTT.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800StartIpStack(void)
+{
+    Sim800Exchange(SetCIPMUX,strlen((const char*)SetCIPMUX),"OK",Sim800CmdTimeout);
+    Sim800Exchange(SetCIPRXGET,strlen((const char*)SetCIPRXGET),"OK",Sim800CmdTimeout);
+    // AT+CIICR answers ERROR when the wireless connection is already up
+    Sim800Exchange(BringUpGPRS,strlen((const char*)BringUpGPRS),"OK",Sim800ConnectTimeout);
+    if(Sim800GetLocalIp()!=Gsmok)
+    {
+        return GsmError;
+    }
+    Sim800IpStackUp=1;
     return Gsmok;
 }
+
+/***********************************************************************************************
+ * Function Name      : Sim800GetLocalIp
+ * Description        : Read the local IP address with AT+CIFSR. The answer is the bare address,
+ *                      without "OK".
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800GetLocalIp(void)
+{
+    uint32_t Status=GsmError;
+    uint32_t Waited=0;
+    uint32_t comlen=strlen((const char*)GetLocalIP);
+    //Echo and the address line of up to 15 characters
+    uint32_t reslen=comlen+24;
+    Sim800Arm(reslen);
+    GSMSend(GetLocalIP,comlen);
+    while(Waited<Sim800CmdTimeout)
+    {
+        if(Sim800Failed(reslen))
+        {
+            break;
+        }
+        if(Sim800FindAddress(reslen)!=NULL)
+        {
+            Status=Gsmok;
+            break;
+        }
+        Sim800DelayMs(Sim800PollPeriod);
+        Waited+=Sim800PollPeriod;
+    }
+    //Reset buffer to recieve new info
+    memset(buffer2,'\0',reslen);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Arm
+ * Description        : Arm the reception of a response in buffer2. When the last response filled
+ *                      its reception, the rest of it is still held by the module behind RTS or in
+ *                      the UART FIFO and would land at the start of the new one, where a leftover
+ *                      "OK" completes the next exchange. It is received and thrown away first.
+ * INPUTS             : uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void Sim800Arm(uint32_t Size)
+{
+    uint32_t Count;
+    uint32_t Last;
+    if(Sim800RxSize!=0 && GSMGetRxByteCount()>=Sim800RxSize)
+    {
+        do
+        {
+            GSMReceiveResponse(buffer2, Sim800BufSize);
+            Count=0;
+            //Wait until the module sent all it held
+            do
+            {
+                Last=Count;
+                Sim800DelayMs(Sim800PollPeriod);
+                Count=GSMGetRxByteCount();
+            }while(Count!=Last && Count<Sim800BufSize);
+        }while(Count>=Sim800BufSize);
+        memset(buffer2,'\0',Sim800BufSize);
+    }
+    Sim800RxSize=Size;
+    GSMReceiveResponse(buffer2, Size);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Exchange
+ * Description        : Send a command and wait until a line starting with the expected response
+ *                      was received, an error was reported or the timeout expired.
+ * INPUTS             : const uint8_t *Command, uint32_t ComLen, const char *Response,
+ *                      uint32_t TimeoutMs
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800Exchange(const uint8_t *Command,uint32_t ComLen,const char *Response,uint32_t TimeoutMs)
+{
+    uint32_t reslen;
+    uint32_t Status=Sim800Transact(Command,ComLen,Response,TimeoutMs,&reslen);
+    //Reset buffer to recieve new info
+    memset(buffer2,'\0',reslen);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Query
+ * Description        : Send a query command and read the numbers of its "<Prefix> a,b,..." answer.
+ * INPUTS             : const uint8_t *Command, const char *Prefix, uint32_t *Values,
+ *                      uint8_t Count (numbers expected)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800Query(const uint8_t *Command,const char *Prefix,uint32_t *Values,uint8_t Count)
+{
+    char *P=NULL;
+    char *End=NULL;
+    uint8_t Index;
+    uint32_t reslen;
+    uint32_t Status=Sim800Transact(Command,strlen((const char*)Command),"OK",Sim800CmdTimeout,&reslen);
+    if(Status==Gsmok)
+    {
+        P=Sim800FindLine(Prefix,reslen);
+        if(P==NULL)
+        {
+            Status=GsmError;
+        }
+        else
+        {
+            P+=strlen(Prefix);
+            for(Index=0;Index<Count;Index++)
+            {
+                Values[Index]=strtoul(P,&End,10);
+                if(End==P || (Index+1<Count && *End!=','))
+                {
+                    Status=GsmError;
+                    break;
+                }
+                P=End+1;
+            }
+        }
+    }
+    //Reset buffer to recieve new info
+    memset(buffer2,'\0',reslen);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Transact
+ * Description        : Exchange of Sim800Exchange that leaves the response in the buffer for the
+ *                      caller to parse and clear.
+ * INPUTS             : const uint8_t *Command, uint32_t ComLen, const char *Response,
+ *                      uint32_t TimeoutMs, uint32_t *ResLen (bytes of the buffer in use)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800Transact(const uint8_t *Command,uint32_t ComLen,const char *Response,uint32_t TimeoutMs,uint32_t *ResLen)
+{
+    uint32_t reslen=strlen(Response);
+    //The Response buffer is supposed to the size of the transmitted data + received data +20 margin error
+    reslen+=ComLen+20;
+    if(reslen>=Sim800BufSize)
+    {
+        reslen=Sim800BufSize-1;
+    }
+    Sim800Arm(reslen);
+    GSMSend((uint8_t *)Command,ComLen);
+    *ResLen=reslen;
+    return Sim800Await(Response,reslen,TimeoutMs);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800ExchangeVector
+ * Description        : Sim800Exchange of a command sent as fragments, see GSMSendVector. Constant
+ *                      parts stay in flash and the parts built at run time are not copied.
+ * INPUTS             : const GSMFragment_t *Fragments, uint32_t Count, const char *Response,
+ *                      uint32_t TimeoutMs
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800ExchangeVector(const GSMFragment_t *Fragments,uint32_t Count,const char *Response,uint32_t TimeoutMs)
+{
+    uint32_t Index;
+    uint32_t Status=GsmError;
+    uint32_t reslen=strlen(Response)+20;
+    for(Index=0;Index<Count;Index++)
+    {
+        reslen+=Fragments[Index].Size;
+    }
+    if(reslen>=Sim800BufSize)
+    {
+        reslen=Sim800BufSize-1;
+    }
+    Sim800Arm(reslen);
+    if(GSMSendVector(Fragments,Count)!=0)
+    {
+        Status=Sim800Await(Response,reslen,TimeoutMs);
+    }
+    //Reset buffer to recieve new info
+    memset(buffer2,'\0',reslen);
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Await
+ * Description        : Poll the response buffer until the expected response line was received, an
+ *                      error was reported or the timeout expired.
+ * INPUTS             : const char *Response, uint32_t ResLen (bytes armed for reception),
+ *                      uint32_t TimeoutMs
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800Await(const char *Response,uint32_t ResLen,uint32_t TimeoutMs)
+{
+    char *P=NULL;
+    uint32_t Status=GsmError;
+    uint32_t Waited=0;
+    uint32_t reslen=ResLen;
+    while(Waited<TimeoutMs)
+    {
+        // Only whole lines count, an echoed payload may hold "OK" or "ERROR" anywhere
+        if(Sim800Failed(reslen))
+        {
+            break;
+        }
+        P=Sim800FindLine(Response,reslen);
+        // The prompt of AT+CIPSEND is not followed by a line end
+        if(P!=NULL && (Response[0]=='>' || memchr(P,'\n',(char *)buffer2+reslen-P)!=NULL))
+        {
+            Status=Gsmok;
+            break;
+        }
+        Sim800DelayMs(Sim800PollPeriod);
+        Waited+=Sim800PollPeriod;
+    }
+    return Status;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800FindLine
+ * Description        : Search the first Size bytes of the response buffer for a line starting with
+ *                      a string, a line starts the buffer or follows a CR or LF. The echo of the
+ *                      command starts with "AT" and never matches. Unlike strstr it does not stop
+ *                      at the zero bytes of an echoed binary payload.
+ * INPUTS             : const char *Str, uint32_t Size
+ * RETURNS            : char* to the start of the first matching line or NULL
+ ***********************************************************************************************/
+static char *Sim800FindLine(const char *Str,uint32_t Size)
+{
+    uint32_t Index;
+    uint32_t Len=strlen(Str);
+    for(Index=0;Index+Len<=Size;Index++)
+    {
+        if((Index==0 || buffer2[Index-1]=='\r' || buffer2[Index-1]=='\n') && memcmp(&buffer2[Index],Str,Len)==0)
+        {
+            return (char *)&buffer2[Index];
+        }
+    }
+    return NULL;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800FindAddress
+ * Description        : Search the first Size bytes of the response buffer for a whole line made of
+ *                      digits and dots, the IP address AT+CIFSR answers with.
+ * INPUTS             : uint32_t Size
+ * RETURNS            : char* to the start of the address or NULL
+ ***********************************************************************************************/
+static char *Sim800FindAddress(uint32_t Size)
+{
+    uint32_t Index;
+    uint32_t End;
+    uint8_t Dots;
+    for(Index=0;Index<Size;Index++)
+    {
+        if(Index!=0 && buffer2[Index-1]!='\r' && buffer2[Index-1]!='\n')
+        {
+            continue;
+        }
+        Dots=0;
+        for(End=Index;End<Size && ((buffer2[End]>='0' && buffer2[End]<='9') || buffer2[End]=='.');End++)
+        {
+            Dots+=(buffer2[End]=='.');
+        }
+        if(Dots==3 && End<Size && (buffer2[End]=='\r' || buffer2[End]=='\n'))
+        {
+            return (char *)&buffer2[Index];
+        }
+    }
+    return NULL;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Failed
+ * Description        : Check the first Size bytes of the response buffer for a line holding one of
+ *                      the result codes of Sim800FailLines.
+ * INPUTS             : uint32_t Size
+ * RETURNS            : uint8_t 1 if the exchange failed
+ ***********************************************************************************************/
+static uint8_t Sim800Failed(uint32_t Size)
+{
+    uint32_t Index;
+    for(Index=0;Index<sizeof(Sim800FailLines)/sizeof(Sim800FailLines[0]);Index++)
+    {
+        if(Sim800FindLine(Sim800FailLines[Index],Size)!=NULL)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800Probe
+ * Description        : Check that the module answers "AT", at the fast rate or at the default one.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800Probe(void)
+{
+    if(Sim800NegotiateBaudRate(GSMFastBaud)==Gsmok)
+    {
+        return Gsmok;
+    }
+    // Answers at the default rate but refused the new one
+    return Sim800Exchange(test,strlen((const char*)test),"OK",Sim800ProbeTimeout);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800WaitReady
+ * Description        : Probe the module a few times, it may still be starting up.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800WaitReady(void)
+{
+    uint8_t Try;
+    for(Try=0;Try<Sim800ProbeTries;Try++)
+    {
+        if(Sim800Probe()==Gsmok)
+        {
+            return Gsmok;
+        }
+    }
+    return GsmError;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800PressPowerKey
+ * Description        : Hold PWRKEY pressed for the given time.
+ * INPUTS             : uint32_t PressMs
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void Sim800PressPowerKey(uint32_t PressMs)
+{
+    GSMSetPowerKey(1);
+    Sim800DelayMs(PressMs);
+    GSMSetPowerKey(0);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800ClockMs
+ * Description        : Milliseconds since the start up, counted from the busy waits until the
+ *                      scheduler runs.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t Sim800ClockMs(void)
+{
+    if(xTaskGetSchedulerState()==taskSCHEDULER_RUNNING)
+    {
+        return Sim800BusyMs+xTaskGetTickCount()*portTICK_PERIOD_MS;
+    }
+    return Sim800BusyMs;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800DelayMs
+ * Description        : Wait while a response is being received. Yields to the other tasks once
+ *                      the scheduler runs and busy waits during the initialization phase.
+ * INPUTS             : uint32_t Ms
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void Sim800DelayMs(uint32_t Ms)
+{
+    if(xTaskGetSchedulerState()==taskSCHEDULER_RUNNING)
+    {
+        vTaskDelay(pdMS_TO_TICKS(Ms));
+    }
+    else
+    {
+        // SysCtlDelay takes 3 cycles per loop
+        SysCtlDelay((configCPU_CLOCK_HZ/3000)*Ms);
+        Sim800BusyMs+=Ms;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800PatchSlot
+ * Description        : Write a value right aligned in a fixed width slot, zero padded on the left.
+ *                      The sign of a negative value stays in front of the padding. A longer
+ *                      value is cut to the slot so nothing is written past it.
+ * INPUTS             : char *Slot, uint8_t Width, const char *Value
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void Sim800PatchSlot(char *Slot,uint8_t Width,const char *Value)
+{
+    uint8_t Len=0;
+    while(Len<Width && Value[Len]!='\0')
+    {
+        Len++;
+    }
+    memset(Slot,'0',Width-Len);
+    memcpy(&Slot[Width-Len],Value,Len);
+    if(Value[0]=='-' && Len<Width)
+    {
+        Slot[0]='-';
+        Slot[Width-Len]='0';
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : Sim800UIntToStr
+ * Description        : Convert an unsigned number to a decimal string.
+ * INPUTS             : char *Str (at least 11 bytes), uint32_t Value
+ * RETURNS            : char* Str
+ ***********************************************************************************************/
+static char *Sim800UIntToStr(char *Str,uint32_t Value)
+{
+    char Digits[10];
+    uint8_t Count=0,Index=0;
+    do{
+        Digits[Count++]=(char)('0'+(Value%10));
+        Value/=10;
+    }while(Value!=0);
+    while(Count!=0)
+    {
+        Str[Index++]=Digits[--Count];
+    }
+    Str[Index]='\0';
+    return Str;
+}
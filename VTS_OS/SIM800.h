@@ -24,6 +24,82 @@
  *                                Definitions                                  *
  *******************************************************************************/
 #define Sim800BufSize  200
+/* Period in ms between two polls of the response buffer */
+#define Sim800PollPeriod          10
+/* Time in ms the server is given to answer an HTTP action */
+#define Sim800HttpActionTimeout   30000
+/* Room for "OK" and the "+HTTPACTION: <method>,<status>,<len>" URC after the echo */
+#define Sim800HttpActionResSize   48
+/* Room for the "+CCLK: "yy/MM/dd,hh:mm:ss+zz"" line and "OK" after the echo */
+#define Sim800ClockResSize        48
+/* Time in ms allowed for a plain command to be answered */
+#define Sim800CmdTimeout          5000
+/* Time in ms allowed for the TCP/IP stack to come up or a socket to connect */
+#define Sim800ConnectTimeout      30000
+/* Time in ms an "AT" probe is answered in when the baud rate matches */
+#define Sim800ProbeTimeout        500
+/* Time in ms the module waits for the body announced by AT+HTTPDATA */
+#define Sim800HttpDataTimeout     10000
+/* Size of the HTTP request link and the width of its slots, Report_t coordinates fit in
+ * GPSCoordinateSize-1 */
+#define Sim800LinkSize            200
+#define Sim800LatSlot             12
+#define Sim800LonSlot             12
+#define Sim800SeqSlot             10
+/* Size of the link of a batch GET (Sim800PrepareBatchLink), well below the URL limit of the HTTP
+ * service of the module */
+#define Sim800BatchLinkSize       400
+/* Hex digits of the truncated MAC of a signed report link */
+#define Sim800MacSlot             16
+/* Largest SMS PDU (SMSC information and TPDU) in octets */
+#define Sim800SmsPduMax           164
+/* Time in ms the network is given to accept an SMS */
+#define Sim800SmsTimeout          60000
+/* Time in ms the module needs after DTR went low before it accepts commands */
+#define Sim800WakeLatency         60
+/* Recovery timing in ms: start up after a restart, RESET pulse, PWRKEY presses and the time the
+ * module takes to switch off */
+#define Sim800BootTime            3000
+#define Sim800ResetPulse          150
+#define Sim800PowerOnPulse        1200
+#define Sim800PowerOffPulse       1500
+#define Sim800PowerOffTime        3000
+/* Probes of a module that may still be starting up */
+#define Sim800ProbeTries          3
+
+/* Recovery steps, in the order they are tried */
+typedef enum{
+    Sim800RecoverProbe=0,    /* The module answers again after new probes */
+    Sim800RecoverCfun,       /* AT+CFUN=1,1 */
+    Sim800RecoverReset,      /* Pulse on RESET */
+    Sim800RecoverPower,      /* Power cycle through PWRKEY */
+    Sim800RecoverLevels
+}Sim800RecoverLevel_t;
+
+typedef struct{
+    uint32_t Attempts;       /* Calls of Sim800Recover */
+    uint32_t Failed;         /* Attempts that went through all steps without an answer */
+    uint32_t Recovered[Sim800RecoverLevels]; /* Successful attempts by the step that worked */
+    uint32_t TotalMs;        /* Time spent in the successful attempts */
+    uint32_t LastMs;         /* Time of the last successful attempt */
+    uint32_t MeanMs;         /* Mean time to recover, filled by Sim800GetRecoveryStats */
+}Sim800RecoveryStats_t;
+
+typedef struct{
+    uint8_t  Year;           /* Years since 2000 */
+    uint8_t  Month;
+    uint8_t  Day;
+    uint8_t  Hour;
+    uint8_t  Minute;
+    uint8_t  Second;
+    int8_t   Zone;           /* Offset of the local time to UTC in quarters of an hour */
+}Sim800Clock_t;
+
+typedef struct{
+    uint32_t AsleepMs;       /* Time DTR allowed the module to sleep */
+    uint32_t AwakeMs;        /* Time the module was kept awake */
+    uint32_t Wakeups;        /* Sleep to awake transitions */
+}Sim800PowerStats_t;
 
 typedef enum{
     Gsmok=0,
@@ -38,7 +114,36 @@ typedef enum{
 
 void sim800recieve(void);
 void Sim800Init(void);
-void Sim800PrepareLink(char *RQSTLink,char *Lon, char *Lat);
+void Sim800PrepareLink(char *RQSTLink,uint32_t Seq,char *Lon, char *Lat);
+uint32_t Sim800RenderLink(char *RQSTLink);
+uint32_t Sim800RenderSignedLink(char *RQSTLink,const char *Url);
+void Sim800SignLink(char *RQSTLink,const uint8_t *Mac);
+uint32_t Sim800BatchLinkRoom(void);
+uint32_t Sim800PrepareBatchLink(char *RQSTLink,const char *Packed,uint32_t PackedLen);
 uint32_t Sim800SetNetConnectivity(void);
+uint32_t Sim800NegotiateBaudRate(uint32_t Baud);
+uint32_t Sim800Recover(void);
+void Sim800GetRecoveryStats(Sim800RecoveryStats_t *Stats);
+void Sim800Take(void);
+void Sim800Give(void);
+void Sim800WakeUp(void);
+void Sim800GetPowerStats(Sim800PowerStats_t *Stats);
+uint32_t Sim800GetSignalQuality(uint8_t *Rssi);
+uint32_t Sim800GetRegistration(uint8_t *Registered);
+uint32_t Sim800GetAttach(uint8_t *Attached);
+uint32_t Sim800EnableNetworkTime(void);
+uint32_t Sim800GetClock(Sim800Clock_t *Clock);
+uint32_t Sim800HttpAction(uint8_t *Command,uint16_t *HttpStatus);
+uint32_t Sim800CheckHttps(void);
+uint32_t Sim800CheckHttp(void);
+uint32_t Sim800HttpGet(uint8_t *Link,uint32_t LinkLen,uint16_t *HttpStatus);
+uint32_t Sim800PreparePostLink(char *RQSTLink);
+uint32_t Sim800HttpPost(uint8_t *Link,uint32_t LinkLen,const uint8_t *Body,uint32_t BodySize,uint16_t *HttpStatus);
+uint32_t Sim800SocketOpen(const char *Mode,const char *Host,uint16_t Port);
+uint32_t Sim800ResolveHost(const char *Host,char *Ip,uint32_t IpSize);
+uint32_t Sim800SocketSend(const uint8_t *Data,uint32_t DataSize);
+uint32_t Sim800SocketReceive(uint8_t *Data,uint32_t MaxSize,uint32_t *Received);
+void Sim800SocketClose(void);
+uint32_t Sim800SmsSendPdu(const uint8_t *Pdu,uint32_t PduSize);
 uint32_t Sim800HttpRequest(char *Lon, char *Lat);
 #endif /* SRC_Sim800_H_ */
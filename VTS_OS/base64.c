@@ -0,0 +1,148 @@
+/******************************************************************************
+ * File Name: base64.c
+ *
+ * Description: Source file for the base64url encoding (RFC 4648 section 5)
+ *              without padding. Its alphabet needs no escaping in a query
+ *              string, so binary batches can travel in the parameter of an
+ *              HTTP GET. No target dependency, the servers decode with the
+ *              same file.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "base64.h"
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static int8_t Base64UrlValue(char Digit);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static const char Base64UrlDigits[64]=
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : Base64UrlEncode
+ * Description        : Encode bytes, 4 characters for every 3 bytes and 2 or 3 for a last partial
+ *                      group. The text is not zero terminated.
+ * INPUTS             : const uint8_t *Data, uint32_t Size, char *Text (Base64UrlChars(Size) bytes)
+ * RETURNS            : uint32_t characters written
+ ***********************************************************************************************/
+uint32_t Base64UrlEncode(const uint8_t *Data,uint32_t Size,char *Text)
+{
+    uint32_t Len=0;
+    uint32_t Group;
+    while(Size!=0)
+    {
+        Group=(uint32_t)Data[0]<<16;
+        if(Size>1)
+        {
+            Group|=(uint32_t)Data[1]<<8;
+        }
+        if(Size>2)
+        {
+            Group|=Data[2];
+        }
+        Text[Len++]=Base64UrlDigits[(Group>>18)&0x3F];
+        Text[Len++]=Base64UrlDigits[(Group>>12)&0x3F];
+        if(Size>1)
+        {
+            Text[Len++]=Base64UrlDigits[(Group>>6)&0x3F];
+        }
+        if(Size>2)
+        {
+            Text[Len++]=Base64UrlDigits[Group&0x3F];
+        }
+        Data+=(Size>3)?3:Size;
+        Size-=(Size>3)?3:Size;
+    }
+    return Len;
+}
+
+/***********************************************************************************************
+ * Function Name      : Base64UrlDecode
+ * Description        : Decode text written by Base64UrlEncode.
+ * INPUTS             : const char *Text, uint32_t Len, uint8_t *Data (Base64UrlBytes(Len) bytes)
+ * RETURNS            : uint32_t bytes written, 0 for a character outside the alphabet or a length
+ *                      no encoding gives
+ ***********************************************************************************************/
+uint32_t Base64UrlDecode(const char *Text,uint32_t Len,uint8_t *Data)
+{
+    uint32_t Size=0;
+    uint32_t Group=0;
+    uint32_t Index;
+    int8_t Value;
+    if(Len%4==1)
+    {
+        return 0;
+    }
+    for(Index=0;Index<Len;Index++)
+    {
+        Value=Base64UrlValue(Text[Index]);
+        if(Value<0)
+        {
+            return 0;
+        }
+        Group=(Group<<6)|(uint32_t)Value;
+        if(Index%4==3)
+        {
+            Data[Size++]=(uint8_t)(Group>>16);
+            Data[Size++]=(uint8_t)(Group>>8);
+            Data[Size++]=(uint8_t)Group;
+            Group=0;
+        }
+    }
+    // A partial group of 2 or 3 characters holds 1 or 2 bytes
+    if(Len%4==2)
+    {
+        Data[Size++]=(uint8_t)(Group>>4);
+    }
+    else if(Len%4==3)
+    {
+        Data[Size++]=(uint8_t)(Group>>10);
+        Data[Size++]=(uint8_t)(Group>>2);
+    }
+    return Size;
+}
+
+/***********************************************************************************************
+ * Function Name      : Base64UrlValue
+ * Description        : Value of a base64url character.
+ * INPUTS             : char Digit
+ * RETURNS            : int8_t 0..63, -1 outside the alphabet
+ ***********************************************************************************************/
+static int8_t Base64UrlValue(char Digit)
+{
+    if(Digit>='A' && Digit<='Z')
+    {
+        return (int8_t)(Digit-'A');
+    }
+    if(Digit>='a' && Digit<='z')
+    {
+        return (int8_t)(Digit-'a'+26);
+    }
+    if(Digit>='0' && Digit<='9')
+    {
+        return (int8_t)(Digit-'0'+52);
+    }
+    if(Digit=='-')
+    {
+        return 62;
+    }
+    if(Digit=='_')
+    {
+        return 63;
+    }
+    return -1;
+}
@@ -0,0 +1,32 @@
+/******************************************************************************
+ * File Name: base64.h
+ *
+ * Description: Header file for the base64url text encoding.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_BASE64_H_
+#define SRC_BASE64_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Characters of Size bytes and bytes that Len characters can hold, without padding */
+#define Base64UrlChars(Size)    (((Size)*4+2)/3)
+#define Base64UrlBytes(Len)     (((Len)*3)/4)
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+uint32_t Base64UrlEncode(const uint8_t *Data,uint32_t Size,char *Text);
+uint32_t Base64UrlDecode(const char *Text,uint32_t Len,uint8_t *Data);
+
+#endif /* SRC_BASE64_H_ */
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * File Name: crc32.c
+ *
+ * Description: Source file for the CRC-32 (IEEE 802.3, reflected polynomial
+ *              0xEDB88320) computed bit by bit. The records it guards are a few
+ *              tens of bytes, a table would cost 1 KB of flash for them.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "crc32.h"
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : Crc32
+ * Description        : CRC-32 of a buffer, the value zlib and Ethernet give.
+ * INPUTS             : const uint8_t *Data, uint32_t Size
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t Crc32(const uint8_t *Data,uint32_t Size)
+{
+    uint32_t Crc=0xFFFFFFFFU;
+    uint8_t  Bit;
+    while(Size--)
+    {
+        Crc^=*Data++;
+        for(Bit=0;Bit<8;Bit++)
+        {
+            Crc=(Crc>>1)^(0xEDB88320U&-(Crc&1));
+        }
+    }
+    return ~Crc;
+}
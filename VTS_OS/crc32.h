@@ -0,0 +1,25 @@
+/******************************************************************************
+ * File Name: crc32.h
+ *
+ * Description: Header file for the CRC-32 guarding what is kept in flash and
+ *              EEPROM.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_CRC32_H_
+#define SRC_CRC32_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+uint32_t Crc32(const uint8_t *Data,uint32_t Size);
+
+#endif /* SRC_CRC32_H_ */
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * File Name: dns.c
+ *
+ * Description: Source file for the DNS resolution cache. A host name is
+ *              resolved once with AT+CDNSGIP and the socket transports
+ *              connect by IP address until the address expires or a
+ *              connection to it fails, which saves the lookup round trip
+ *              the module would otherwise make on every AT+CIPSTART.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "dns.h"
+#include "SIM800.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+typedef struct{
+    const char *Host;        /* NULL while the entry is free */
+    char        Ip[DnsIpSize];
+    TickType_t  Expiry;      /* Tick count the address stops being trusted at */
+}DnsEntry_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static DnsEntry_t *DnsFind(const char *Host);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static DnsEntry_t DnsCache[DnsCacheSize];
+/* Entry replaced next when the cache is full */
+static uint8_t    DnsNext=0;
+static DnsStats_t DnsStats;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : DnsResolve
+ * Description        : Get the address of a host, from the cache while it did not expire and
+ *                      with AT+CDNSGIP otherwise. Must be called with the module taken.
+ * INPUTS             : const char *Host
+ * RETURNS            : const char* dotted address, or NULL when it could not be resolved
+ ***********************************************************************************************/
+const char *DnsResolve(const char *Host)
+{
+    DnsEntry_t *Entry=DnsFind(Host);
+    if(Entry!=NULL && (int32_t)(xTaskGetTickCount()-Entry->Expiry)<0)
+    {
+        DnsStats.Hits++;
+        return Entry->Ip;
+    }
+    if(Entry==NULL)
+    {
+        Entry=&DnsCache[DnsNext];
+        DnsNext=(DnsNext+1)%DnsCacheSize;
+    }
+    Entry->Host=NULL;
+    DnsStats.Lookups++;
+    if(Sim800ResolveHost(Host,Entry->Ip,DnsIpSize)!=Gsmok)
+    {
+        DnsStats.Failures++;
+        return NULL;
+    }
+    Entry->Host=Host;
+    Entry->Expiry=xTaskGetTickCount()+pdMS_TO_TICKS(DnsTtl);
+    return Entry->Ip;
+}
+
+/***********************************************************************************************
+ * Function Name      : DnsInvalidate
+ * Description        : Drop the cached address of a host so the next DnsResolve looks it up again.
+ * INPUTS             : const char *Host
+ * RETURNS            : void
+ ***********************************************************************************************/
+void DnsInvalidate(const char *Host)
+{
+    DnsEntry_t *Entry=DnsFind(Host);
+    if(Entry!=NULL)
+    {
+        Entry->Host=NULL;
+        DnsStats.Invalidated++;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : DnsSocketOpen
+ * Description        : Sim800SocketOpen by the cached address of the host. The module resolves
+ *                      the name itself when no address is known, and a failed connection drops
+ *                      the address so it is looked up again on the next attempt.
+ * INPUTS             : const char *Mode ("TCP" or "UDP"), const char *Host, uint16_t Port
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t DnsSocketOpen(const char *Mode,const char *Host,uint16_t Port)
+{
+    const char *Ip=DnsResolve(Host);
+    if(Sim800SocketOpen(Mode,(Ip!=NULL)?Ip:Host,Port)!=Gsmok)
+    {
+        DnsInvalidate(Host);
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : DnsGetStats
+ * Description        : Cache hits and lookups since the start up.
+ * INPUTS             : void
+ * RETURNS            : const DnsStats_t*
+ ***********************************************************************************************/
+const DnsStats_t *DnsGetStats(void)
+{
+    return &DnsStats;
+}
+
+/***********************************************************************************************
+ * Function Name      : DnsFind
+ * Description        : Get the cache entry of a host.
+ * INPUTS             : const char *Host
+ * RETURNS            : DnsEntry_t* or NULL if the host is not cached
+ ***********************************************************************************************/
+static DnsEntry_t *DnsFind(const char *Host)
+{
+    uint8_t Index;
+    for(Index=0;Index<DnsCacheSize;Index++)
+    {
+        if(DnsCache[Index].Host!=NULL && strcmp(DnsCache[Index].Host,Host)==0)
+        {
+            return &DnsCache[Index];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,44 @@
+/******************************************************************************
+ * File Name: dns.h
+ *
+ * Description: Header file for the DNS resolution cache.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_DNS_H_
+#define SRC_DNS_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Host names kept at once, the transports talk to one or two servers */
+#define DnsCacheSize        2
+/* AT+CDNSGIP does not report the TTL of the record, an address is trusted this long (ms) */
+#define DnsTtl              3600000
+/* Longest dotted IPv4 address and its terminator */
+#define DnsIpSize           16
+
+typedef struct{
+    uint32_t Hits;           /* Connections opened with a cached address */
+    uint32_t Lookups;        /* AT+CDNSGIP resolutions */
+    uint32_t Failures;       /* Resolutions that did not give an address */
+    uint32_t Invalidated;    /* Addresses dropped after a failed connection */
+}DnsStats_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+const char *DnsResolve(const char *Host);
+void DnsInvalidate(const char *Host);
+uint32_t DnsSocketOpen(const char *Mode,const char *Host,uint16_t Port);
+const DnsStats_t *DnsGetStats(void);
+
+#endif /* SRC_DNS_H_ */
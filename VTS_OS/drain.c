@@ -0,0 +1,408 @@
+/******************************************************************************
+ * File Name: drain.c
+ *
+ * Description: Source file for the upload scheduler. Once a transport is
+ *              connected the live reports go first, newest first, then the
+ *              records stored in the flash log during an outage are drained
+ *              in batches, oldest first. Live reports queued meanwhile are
+ *              sent before the next backlog batch, and the number of backlog
+ *              batches in a window follows the link score so a weak link is
+ *              not kept busy with history. A stored record is only acked in
+ *              the flash log once the server confirmed it.
+ *
+ *              The server may ask for the stored positions between two times
+ *              on the MQTT downlink, to look into an incident after the fact.
+ *              Once the backlog is drained, the records of the range are
+ *              found through the time index of the flash log and sent back in
+ *              batches from the same budget, delivered or not.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "drain.h"
+#include "flashlog.h"
+#include "linkmon.h"
+#include "mqtt.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t DrainSendLive(const Transport_t *Transport);
+static uint32_t DrainSendQueued(const Transport_t *Transport);
+static uint32_t DrainSendBacklog(const Transport_t *Transport);
+static uint32_t DrainSendRange(const Transport_t *Transport);
+static uint32_t DrainSendReports(const Transport_t *Transport,uint32_t Loaded,uint16_t *HttpStatus);
+static uint32_t DrainBudget(void);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Reports restored from the flash log for the batch being sent */
+static Report_t     DrainReports[DrainBatchSize];
+static DrainStats_t DrainStats;
+/* Range request received, taken up by DrainSendRange. It may come in while a batch is being sent */
+static volatile uint8_t DrainRangeNew=0;
+static uint32_t DrainRequestFrom;
+static uint32_t DrainRequestTo;
+/* Range being answered, where its batch being sent started and how many records may still go */
+static FlashLogRange_t DrainRange;
+static FlashLogRange_t DrainRangeMark;
+static uint32_t DrainRangeLeft=0;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : DrainRun
+ * Description        : Send what is pending through a connected transport: the live reports,
+ *                      then as many backlog batches as the link score allows, the live reports
+ *                      queued meanwhile going first each time. Once the backlog is drained the
+ *                      budget goes to the range request of the server. Stops at the first
+ *                      failure, which starts the link backoff. Called with the module taken.
+ * INPUTS             : const Transport_t *Transport
+ * RETURNS            : void
+ ***********************************************************************************************/
+void DrainRun(const Transport_t *Transport)
+{
+    uint32_t Batches=DrainBudget();
+    uint32_t Result;
+    if(DrainSendLive(Transport)!=Gsmok)
+    {
+        return;
+    }
+    while(Batches!=0 && DrainDue())
+    {
+        Result=(FlashLogCount()!=0)?DrainSendBacklog(Transport):DrainSendRange(Transport);
+        if(Result!=Gsmok)
+        {
+            return;
+        }
+        Batches--;
+        if(ReportQueueCount()!=0)
+        {
+            DrainStats.Preempted++;
+            if(DrainSendLive(Transport)!=Gsmok)
+            {
+                return;
+            }
+        }
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainDue
+ * Description        : Tell if stored records wait for upload, a batching transport then
+ *                      connects without waiting for a full batch of live reports.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 if the flash log holds pending records or a range request is
+ *                      not answered yet
+ ***********************************************************************************************/
+uint8_t DrainDue(void)
+{
+    return FlashLogCount()!=0 || DrainRangeNew || DrainRangeLeft!=0;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainGetStats
+ * Description        : Backlog depth and drain accounting since start up.
+ * INPUTS             : void
+ * RETURNS            : const DrainStats_t*
+ ***********************************************************************************************/
+const DrainStats_t *DrainGetStats(void)
+{
+    uint32_t Ms=DrainStats.Ticks*portTICK_PERIOD_MS;
+    DrainStats.Depth=FlashLogCount();
+    DrainStats.Rate=(Ms!=0) ? (uint32_t)(((uint64_t)DrainStats.Drained*60000)/Ms) : 0;
+    return &DrainStats;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainRequestRange
+ * Description        : Ask for the stored positions taken between two times to be sent back, in
+ *                      place of a request not answered yet.
+ * INPUTS             : uint32_t From, uint32_t To (UTC Unix times, both included)
+ * RETURNS            : uint8_t 1 when the range is valid
+ ***********************************************************************************************/
+uint8_t DrainRequestRange(uint32_t From,uint32_t To)
+{
+    if(From==0 || To<From)
+    {
+        return 0;
+    }
+    DrainRequestFrom=From;
+    DrainRequestTo=To;
+    DrainRangeNew=1;
+    DrainStats.Ranges++;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainDownlink
+ * Description        : MQTT message callback, take up a range command on the configuration topic.
+ * INPUTS             : const char *Topic, const uint8_t *Payload, uint32_t PayloadSize
+ * RETURNS            : void
+ ***********************************************************************************************/
+void DrainDownlink(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize)
+{
+    char     Command[DrainCommandSize];
+    char    *End;
+    uint32_t From;
+    uint32_t To;
+    if(strcmp(Topic,MqttConfigTopic)!=0 || PayloadSize>=DrainCommandSize)
+    {
+        return;
+    }
+    memcpy(Command,Payload,PayloadSize);
+    Command[PayloadSize]='\0';
+    if(strncmp(Command,DrainRangeCommand,strlen(DrainRangeCommand))!=0)
+    {
+        return;
+    }
+    From=strtoul(&Command[strlen(DrainRangeCommand)],&End,10);
+    To=strtoul(End,NULL,10);
+    DrainRequestRange(From,To);
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainSendLive
+ * Description        : Send the pending live reports, the queue keeps them meanwhile so a report
+ *                      queued during the upload cannot push out the one being sent.
+ * INPUTS             : const Transport_t *Transport
+ * RETURNS            : uint32_t Gsmok when nothing is left pending
+ ***********************************************************************************************/
+static uint32_t DrainSendLive(const Transport_t *Transport)
+{
+    uint32_t Result;
+    ReportQueueSetSending(1);
+    Result=DrainSendQueued(Transport);
+    ReportQueueSetSending(0);
+    return Result;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainSendQueued
+ * Description        : Send the pending live reports. A batching transport takes them at once,
+ *                      otherwise they go one by one, newest first, so the current position is
+ *                      out before the older ones. A confirmed report leaves the queue once the
+ *                      older ones did.
+ * INPUTS             : const Transport_t *Transport
+ * RETURNS            : uint32_t Gsmok when nothing is left pending
+ ***********************************************************************************************/
+static uint32_t DrainSendQueued(const Transport_t *Transport)
+{
+    Report_t *Report;
+    uint16_t HttpStatus=0;
+    uint32_t Count;
+    uint32_t Seq;
+    uint32_t Result=Gsmok;
+    while(Transport->SendBatch!=NULL && (Report=ReportQueuePeek())!=NULL)
+    {
+        //A failed batch is charged to its oldest report, which heads it
+        Seq=Report->Seq;
+        Count=ReportQueueCount();
+        if(TransportSendBatch(Transport,&Count,&HttpStatus)!=Gsmok)
+        {
+            ReportQueueNack(Seq,HttpStatus);
+            LinkReportResult(GsmError);
+            return GsmError;
+        }
+        //The transport confirmed the Count oldest reports (a 2xx for HTTP)
+        while(Count!=0)
+        {
+            ReportQueueAck(HttpStatus);
+            Count--;
+        }
+    }
+    if(Transport->SendBatch!=NULL)
+    {
+        return Gsmok;
+    }
+    for(Count=ReportQueueCount();Count!=0;Count--)
+    {
+        Report=ReportQueuePeekAt(Count-1);
+        if(Report==NULL || Report->Acked)
+        {
+            continue;
+        }
+        Seq=Report->Seq;
+        if(TransportSend(Transport,Report,&HttpStatus)!=Gsmok)
+        {
+            //Keep the reports for the next window instead of hammering a failing link,
+            //the retry is charged to the report that failed, not to the oldest
+            ReportQueueNack(Seq,HttpStatus);
+            LinkReportResult(GsmError);
+            Result=GsmError;
+            break;
+        }
+        Report->Acked=1;
+    }
+    while((Report=ReportQueuePeek())!=NULL && Report->Acked)
+    {
+        ReportQueueAck(HttpStatus);
+    }
+    return Result;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainSendBacklog
+ * Description        : Restore the oldest stored records as reports and send them as one batch
+ *                      (one by one through a transport that does not batch). The records the
+ *                      server confirmed are acked in the flash log, which moves its tail.
+ * INPUTS             : const Transport_t *Transport
+ * RETURNS            : uint32_t Gsmok when the whole batch was confirmed
+ ***********************************************************************************************/
+static uint32_t DrainSendBacklog(const Transport_t *Transport)
+{
+    Record_t   Record;
+    uint16_t   HttpStatus=0;
+    uint32_t   Count=0;
+    uint32_t   Loaded;
+    uint32_t   Index;
+    uint32_t   Result=Gsmok;
+    TickType_t Start=xTaskGetTickCount();
+    while(Count<DrainBatchSize && FlashLogPeekAt(Count,&Record))
+    {
+        TransportFromRecord(&DrainReports[Count],&Record);
+        Count++;
+    }
+    if(Count==0)
+    {
+        return Gsmok;
+    }
+    Loaded=Count;
+    Count=DrainSendReports(Transport,Loaded,&HttpStatus);
+    if(Count<Loaded)
+    {
+        DrainStats.Failures++;
+        LinkReportResult(GsmError);
+        Result=GsmError;
+    }
+    else
+    {
+        DrainStats.Batches++;
+    }
+    DrainStats.Ticks+=xTaskGetTickCount()-Start;
+    //A record appended meanwhile may have pushed the oldest ones out, only ack the ones still there
+    for(Index=0;Index<Count;Index++)
+    {
+        if(!FlashLogPeek(&Record) || Record.Seq!=DrainReports[Index].Seq)
+        {
+            break;
+        }
+        FlashLogAck();
+        DrainStats.Drained++;
+    }
+    return Result;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainSendRange
+ * Description        : Send the next batch of stored records of the range request, taking up a
+ *                      new request first. A batch that failed is sent again from its start in
+ *                      the next window, the server drops what it already got by its seq.
+ * INPUTS             : const Transport_t *Transport
+ * RETURNS            : uint32_t Gsmok when the whole batch was confirmed
+ ***********************************************************************************************/
+static uint32_t DrainSendRange(const Transport_t *Transport)
+{
+    Record_t Record;
+    uint16_t HttpStatus=0;
+    uint32_t Count=0;
+    uint32_t Max;
+    if(DrainRangeNew)
+    {
+        DrainRangeNew=0;
+        FlashLogRangeStart(&DrainRange,DrainRequestFrom,DrainRequestTo);
+        DrainRangeLeft=DrainRangeMax;
+    }
+    DrainRangeMark=DrainRange;
+    Max=(DrainRangeLeft<DrainBatchSize)?DrainRangeLeft:DrainBatchSize;
+    while(Count<Max && FlashLogRangeNext(&DrainRange,&Record))
+    {
+        TransportFromRecord(&DrainReports[Count],&Record);
+        Count++;
+    }
+    if(Count==0)
+    {
+        DrainRangeLeft=0;
+        return Gsmok;
+    }
+    if(DrainSendReports(Transport,Count,&HttpStatus)<Count)
+    {
+        DrainRange=DrainRangeMark;
+        DrainStats.Failures++;
+        LinkReportResult(GsmError);
+        return GsmError;
+    }
+    DrainStats.Replayed+=Count;
+    //A short batch means the query reached the head
+    DrainRangeLeft=(Count<Max)?0:(DrainRangeLeft-Count);
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainSendReports
+ * Description        : Send the reports loaded in DrainReports as one batch, or one by one through
+ *                      a transport that does not batch.
+ * INPUTS             : const Transport_t *Transport, uint32_t Loaded, uint16_t *HttpStatus
+ * RETURNS            : uint32_t Number of reports the server confirmed, oldest first
+ ***********************************************************************************************/
+static uint32_t DrainSendReports(const Transport_t *Transport,uint32_t Loaded,uint16_t *HttpStatus)
+{
+    uint32_t Count=Loaded;
+    if(Transport->SendBatch!=NULL)
+    {
+        if(TransportSendBacklog(Transport,DrainReports,&Count,HttpStatus)!=Gsmok)
+        {
+            Count=0;
+        }
+        return Count;
+    }
+    for(Count=0;Count<Loaded;Count++)
+    {
+        if(TransportSend(Transport,&DrainReports[Count],HttpStatus)!=Gsmok)
+        {
+            break;
+        }
+    }
+    return Count;
+}
+
+/***********************************************************************************************
+ * Function Name      : DrainBudget
+ * Description        : Backlog batches allowed in this window by the link score. Before the
+ *                      first link sample a single batch is tried.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t DrainBudget(void)
+{
+    const LinkQuality_t *Link=LinkGetQuality();
+    if(Link->Samples==0)
+    {
+        return DrainBatchesPoor;
+    }
+    if(Link->Score>=DrainScoreGood)
+    {
+        return DrainBatchesGood;
+    }
+    if(Link->Score>=DrainScoreFair)
+    {
+        return DrainBatchesFair;
+    }
+    if(Link->Score>=LinkMinScore)
+    {
+        return DrainBatchesPoor;
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+/******************************************************************************
+ * File Name: drain.h
+ *
+ * Description: Header file for the upload scheduler that sends the live
+ *              reports, drains the backlog of the flash log and answers the
+ *              range requests of the server.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_DRAIN_H_
+#define SRC_DRAIN_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+#include "transport.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Stored reports restored from the flash log per backlog batch */
+#define DrainBatchSize      ReportBatchSize
+/* Backlog batches sent per window by link score, none below LinkMinScore */
+#define DrainScoreGood      70
+#define DrainScoreFair      50
+#define DrainBatchesGood    4
+#define DrainBatchesFair    2
+#define DrainBatchesPoor    1
+/* Downlink command asking for the stored positions between two UTC Unix times, "range <from> <to>"
+   on the MQTT configuration topic, and most records sent back for one request */
+#define DrainRangeCommand   "range "
+#define DrainCommandSize    32
+#define DrainRangeMax       2000
+
+typedef struct{
+    uint32_t Depth;          /* Records waiting in the flash log */
+    uint32_t Drained;        /* Stored records confirmed by the server */
+    uint32_t Batches;        /* Backlog batches confirmed */
+    uint32_t Failures;       /* Backlog and range batches that failed */
+    uint32_t Preempted;      /* Times live reports were sent between two backlog batches */
+    uint32_t Ticks;          /* Time spent sending backlog batches */
+    uint32_t Rate;           /* Records drained per minute of upload, 0 before the first batch */
+    uint32_t Ranges;         /* Range requests received */
+    uint32_t Replayed;       /* Stored records sent back for range requests */
+}DrainStats_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+void DrainRun(const Transport_t *Transport);
+uint8_t DrainDue(void);
+const DrainStats_t *DrainGetStats(void);
+uint8_t DrainRequestRange(uint32_t From,uint32_t To);
+void DrainDownlink(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize);
+
+#endif /* SRC_DRAIN_H_ */
@@ -0,0 +1,384 @@
+//*****************************************************************************
+//
+// eeprom.c - Driver for programming the on-chip EEPROM.
+//
+// Copyright (c) 2006-2014 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+// 
+//   Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// 
+//   Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the  
+//   distribution.
+// 
+//   Neither the name of Texas Instruments Incorporated nor the names of
+//   its contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// This is part of revision 2.1.0.12573 of the Tiva Peripheral Driver Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_eeprom.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+
+//*****************************************************************************
+//
+//! \addtogroup eeprom_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Useful macro to extract the offset in its block from an EEPROM address.
+//
+//*****************************************************************************
+#define OFFSET_FROM_ADDR(x) (((x) >> 2) & 0x0F)
+
+//*****************************************************************************
+//
+// Blocks until the EEPROM controller is done with the current operation.
+//
+//*****************************************************************************
+static void
+_EEPROMWaitForDone(void)
+{
+    //
+    // Is the EEPROM still busy?
+    //
+    while(HWREG(EEPROM_EEDONE) & EEPROM_EEDONE_WORKING)
+    {
+        //
+        // Spin while EEPROM is busy.
+        //
+    }
+}
+
+//*****************************************************************************
+//
+//! Performs any necessary recovery in case of power failures during write.
+//!
+//! This function \b must be called after SysCtlPeripheralEnable() and before
+//! the EEPROM is accessed.  It checks for errors left by a write that was
+//! interrupted by a reset or a power loss and resets the peripheral to let it
+//! finish the recovery.
+//!
+//! \return Returns \b EEPROM_INIT_OK if no errors were detected or
+//! \b EEPROM_INIT_ERROR if the EEPROM peripheral cannot currently recover from
+//! an interrupted write or erase operation.
+//
+//*****************************************************************************
+uint32_t
+EEPROMInit(void)
+{
+    uint32_t ui32Status;
+
+    //
+    // Insert a small delay (6 cycles + call overhead) to guard against the
+    // possibility that this function is called immediately after the EEPROM
+    // peripheral is enabled.  Without this delay, there is a slight chance
+    // that the first EEPROM register read will fault if you are using a
+    // compiler with a ridiculously good optimizer!
+    //
+    SysCtlDelay(2);
+
+    //
+    // Make sure the EEPROM has finished any ongoing processing.
+    //
+    _EEPROMWaitForDone();
+
+    //
+    // Read the EESUPP register to see if any errors have been reported.
+    //
+    ui32Status = HWREG(EEPROM_EESUPP);
+
+    //
+    // Did an error of some sort occur during initialization?
+    //
+    if(ui32Status & (EEPROM_EESUPP_PRETRY | EEPROM_EESUPP_ERETRY))
+    {
+        return(EEPROM_INIT_ERROR);
+    }
+
+    //
+    // Perform a second EEPROM reset.
+    //
+    SysCtlPeripheralReset(SYSCTL_PERIPH_EEPROM0);
+
+    //
+    // Wait for the EEPROM to complete its reset processing once again.
+    //
+    SysCtlDelay(2);
+    _EEPROMWaitForDone();
+
+    //
+    // Read EESUPP once again to determine if any error occurred.
+    //
+    ui32Status = HWREG(EEPROM_EESUPP);
+
+    //
+    // Was an error reported following the second reset?
+    //
+    if(ui32Status & (EEPROM_EESUPP_PRETRY | EEPROM_EESUPP_ERETRY))
+    {
+        return(EEPROM_INIT_ERROR);
+    }
+
+    //
+    // The EEPROM does not indicate that any error occurred.
+    //
+    return(EEPROM_INIT_OK);
+}
+
+//*****************************************************************************
+//
+//! Determines the size of the EEPROM.
+//!
+//! \return Returns the total number of bytes in the device EEPROM.
+//
+//*****************************************************************************
+uint32_t
+EEPROMSizeGet(void)
+{
+    //
+    // Return the size of the EEPROM in bytes.
+    //
+    return(((HWREG(EEPROM_EESIZE) & EEPROM_EESIZE_WORDCNT_M) >>
+            EEPROM_EESIZE_WORDCNT_S) * 4);
+}
+
+//*****************************************************************************
+//
+//! Determines the number of blocks in the EEPROM.
+//!
+//! \return Returns the total number of blocks in the device EEPROM.
+//
+//*****************************************************************************
+uint32_t
+EEPROMBlockCountGet(void)
+{
+    //
+    // Extract the number of blocks and return it to the caller.
+    //
+    return((HWREG(EEPROM_EESIZE) & EEPROM_EESIZE_BLKCNT_M) >>
+           EEPROM_EESIZE_BLKCNT_S);
+}
+
+//*****************************************************************************
+//
+//! Reads data from the EEPROM.
+//!
+//! \param pui32Data is a pointer to storage for the data read from the EEPROM.
+//! This pointer must point to at least \e ui32Count bytes of available memory.
+//! \param ui32Address is the byte address within the EEPROM from which data is
+//! to be read.  This value must be a multiple of 4.
+//! \param ui32Count is the number of bytes of data to read from the EEPROM.
+//! This value must be a multiple of 4.
+//!
+//! This function reads a number of words from the EEPROM, starting at a given
+//! address, moving on to the next block when the current one is done.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    //
+    // Check parameters in a debug build.
+    //
+    ASSERT(pui32Data);
+    ASSERT(ui32Address < EEPROMSizeGet());
+    ASSERT((ui32Address + ui32Count) <= EEPROMSizeGet());
+    ASSERT((ui32Address & 3) == 0);
+    ASSERT((ui32Count & 3) == 0);
+
+    //
+    // Set the block and offset appropriately to read the first word.
+    //
+    HWREG(EEPROM_EEBLOCK) = EEPROMBlockFromAddr(ui32Address);
+    HWREG(EEPROM_EEOFFSET) = OFFSET_FROM_ADDR(ui32Address);
+
+    //
+    // Convert the byte count to a word count.
+    //
+    ui32Count /= 4;
+
+    //
+    // Read each word in turn.
+    //
+    while(ui32Count)
+    {
+        //
+        // Read the next word through the autoincrementing register.
+        //
+        *pui32Data = HWREG(EEPROM_EERDWRINC);
+
+        //
+        // Move on to the next word.
+        //
+        pui32Data++;
+        ui32Count--;
+
+        //
+        // Do we need to move to the next block?  This is the case if the
+        // offset register has just wrapped back to 0.  Note that we only
+        // write the block register if we have more data to read.  If this
+        // register is written, the hardware expects a read or write operation
+        // next.  If a mass erase is requested instead, the mass erase will
+        // fail.
+        //
+        if(ui32Count && (HWREG(EEPROM_EEOFFSET) == 0))
+        {
+            HWREG(EEPROM_EEBLOCK) += 1;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Writes data to the EEPROM.
+//!
+//! \param pui32Data points to the first word of data to write to the EEPROM.
+//! \param ui32Address defines the byte address within the EEPROM that the data
+//! is to be written to.  This value must be a multiple of 4.
+//! \param ui32Count defines the number of bytes of data that is to be written.
+//! This value must be a multiple of 4.
+//!
+//! This function writes data into the EEPROM at a given word-aligned address.
+//! The call is synchronous and returns only after all data has been written or
+//! an error occurs.  A write interrupted by a power loss is completed or
+//! rolled back word by word by the controller at the next EEPROMInit().
+//!
+//! \return Returns 0 on success or non-zero values on failure.  Failure codes
+//! are logical OR combinations of \b EEPROM_RC_WRBUSY and
+//! \b EEPROM_RC_NOPERM.
+//
+//*****************************************************************************
+uint32_t
+EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t ui32Status;
+
+    //
+    // Check parameters in a debug build.
+    //
+    ASSERT(pui32Data);
+    ASSERT(ui32Address < EEPROMSizeGet());
+    ASSERT((ui32Address + ui32Count) <= EEPROMSizeGet());
+    ASSERT((ui32Address & 3) == 0);
+    ASSERT((ui32Count & 3) == 0);
+
+    //
+    // Make sure the EEPROM is idle before we start.
+    //
+    _EEPROMWaitForDone();
+
+    //
+    // Set the block and offset appropriately to program the first word.
+    //
+    HWREG(EEPROM_EEBLOCK) = EEPROMBlockFromAddr(ui32Address);
+    HWREG(EEPROM_EEOFFSET) = OFFSET_FROM_ADDR(ui32Address);
+
+    //
+    // Convert the byte count to a word count.
+    //
+    ui32Count /= 4;
+
+    //
+    // Write each word in turn.
+    //
+    while(ui32Count)
+    {
+        //
+        // Write the next word through the autoincrementing register.
+        //
+        HWREG(EEPROM_EERDWRINC) = *pui32Data;
+
+        //
+        // Wait for the write to complete.
+        //
+        _EEPROMWaitForDone();
+
+        //
+        // Make sure we completed the write without errors.  Note that we
+        // must check this per-word because write permission can be set per
+        // block resulting in only a section of the write not being performed.
+        //
+        ui32Status = HWREG(EEPROM_EEDONE);
+        if(ui32Status & EEPROM_EEDONE_NOPERM)
+        {
+            return(ui32Status);
+        }
+
+        //
+        // Move on to the next word.
+        //
+        pui32Data++;
+        ui32Count--;
+
+        //
+        // Do we need to move to the next block?  This is the case if the
+        // offset register has just wrapped back to 0.  Note that we only
+        // write the block register if we have more data to read.  If this
+        // register is written, the hardware expects a read or write operation
+        // next.  If a mass erase is requested instead, the mass erase will
+        // fail.
+        //
+        if(ui32Count && (HWREG(EEPROM_EEOFFSET) == 0))
+        {
+            HWREG(EEPROM_EEBLOCK) += 1;
+        }
+    }
+
+    //
+    // Return the current status to the caller.
+    //
+    return(HWREG(EEPROM_EEDONE));
+}
+
+//*****************************************************************************
+//
+//! Returns status on the last EEPROM program or erase operation.
+//!
+//! \return Returns the current value of the EEDONE register, 0 when the
+//! controller is idle and the last operation succeeded.
+//
+//*****************************************************************************
+uint32_t
+EEPROMStatusGet(void)
+{
+    return(HWREG(EEPROM_EEDONE));
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
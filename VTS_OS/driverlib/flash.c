@@ -0,0 +1,264 @@
+//*****************************************************************************
+//
+// flash.c - Driver for programming the on-chip flash.
+//
+// Copyright (c) 2006-2014 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+// 
+//   Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// 
+//   Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the  
+//   distribution.
+// 
+//   Neither the name of Texas Instruments Incorporated nor the names of
+//   its contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// This is part of revision 2.1.0.12573 of the Tiva Peripheral Driver Library.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! \addtogroup flash_api
+//! @{
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/flash.h"
+
+//*****************************************************************************
+//
+// Errors reported by the flash controller once an erase or a write is over.
+//
+//*****************************************************************************
+#define FLASH_ERASE_ERRORS      (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |     \
+                                 FLASH_FCRIS_ERRIS)
+#define FLASH_PROGRAM_ERRORS    (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |     \
+                                 FLASH_FCRIS_INVDRIS | FLASH_FCRIS_PROGRIS)
+
+//*****************************************************************************
+//
+//! Erases a block of flash.
+//!
+//! \param ui32Address is the start address of the flash block to be erased.
+//!
+//! This function erases a 1-KB block of the on-chip flash.  After erasing,
+//! the block is filled with 0xFF bytes.  Read-only and execute-only blocks
+//! cannot be erased.
+//!
+//! This function does not return until the block has been erased.  Code
+//! fetched from flash stalls for the duration of the erase.
+//!
+//! \return Returns 0 on success, or -1 if an invalid block address was
+//! specified or the block is write-protected.
+//
+//*****************************************************************************
+int32_t
+FlashErase(uint32_t ui32Address)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(!(ui32Address & (FLASH_ERASE_SIZE - 1)));
+
+    //
+    // Clear the flash access and error interrupts.
+    //
+    HWREG(FLASH_FCMISC) = (FLASH_FCMISC_AMISC | FLASH_FCMISC_VOLTMISC |
+                           FLASH_FCMISC_ERMISC);
+
+    //
+    // Erase the block.
+    //
+    HWREG(FLASH_FMA) = ui32Address;
+    HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+
+    //
+    // Wait until the block has been erased.
+    //
+    while(HWREG(FLASH_FMC) & FLASH_FMC_ERASE)
+    {
+    }
+
+    //
+    // Return an error if an access violation or erase error occurred.
+    //
+    if(HWREG(FLASH_FCRIS) & FLASH_ERASE_ERRORS)
+    {
+        return(-1);
+    }
+
+    //
+    // Success.
+    //
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Programs flash.
+//!
+//! \param pui32Data is a pointer to the data to be programmed.
+//! \param ui32Address is the starting address in flash to be programmed.  Must
+//! be a multiple of four.
+//! \param ui32Count is the number of bytes to be programmed.  Must be a
+//! multiple of four.
+//!
+//! This function programs a sequence of words into the on-chip flash, one
+//! word at a time.  Programming can only clear bits, so each word should be
+//! programmed once between two erases of its block.
+//!
+//! This function does not return until the data has been programmed.
+//!
+//! \return Returns 0 on success, or -1 if a programming error is encountered.
+//
+//*****************************************************************************
+int32_t
+FlashProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(!(ui32Address & 3));
+    ASSERT(!(ui32Count & 3));
+
+    //
+    // Clear the flash access and error interrupts.
+    //
+    HWREG(FLASH_FCMISC) = (FLASH_FCMISC_AMISC | FLASH_FCMISC_VOLTMISC |
+                           FLASH_FCMISC_INVDMISC | FLASH_FCMISC_PROGMISC);
+
+    //
+    // Loop over the words to be programmed.
+    //
+    while(ui32Count)
+    {
+        //
+        // Program the next word.
+        //
+        HWREG(FLASH_FMA) = ui32Address;
+        HWREG(FLASH_FMD) = *pui32Data;
+        HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_WRITE;
+
+        //
+        // Wait until the word has been programmed.
+        //
+        while(HWREG(FLASH_FMC) & FLASH_FMC_WRITE)
+        {
+        }
+
+        //
+        // Increment to the next word.
+        //
+        pui32Data++;
+        ui32Address += 4;
+        ui32Count -= 4;
+    }
+
+    //
+    // Return an error if an access violation or program error occurred.
+    //
+    if(HWREG(FLASH_FCRIS) & FLASH_PROGRAM_ERRORS)
+    {
+        return(-1);
+    }
+
+    //
+    // Success.
+    //
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Gets the size of the on-chip flash.
+//!
+//! \return Returns the size of the flash in bytes.
+//
+//*****************************************************************************
+uint32_t
+FlashSizeGet(void)
+{
+    //
+    // The size register holds the number of 2-KB blocks minus one.
+    //
+    return(((HWREG(FLASH_FSIZE) & FLASH_FSIZE_SIZE_M) + 1) * 2048);
+}
+
+//*****************************************************************************
+//
+//! Gets the current interrupt status.
+//!
+//! \param bMasked is false if the raw interrupt status is required and true if
+//! the masked interrupt status is required.
+//!
+//! \return The current interrupt status, enumerated as a bit field of
+//! \b FLASH_INT_PROGRAM, \b FLASH_INT_ACCESS, \b FLASH_INT_EEPROM,
+//! \b FLASH_INT_VOLTAGE_ERR, \b FLASH_INT_DATA_ERR, \b FLASH_INT_ERASE_ERR
+//! and \b FLASH_INT_PROGRAM_ERR.
+//
+//*****************************************************************************
+uint32_t
+FlashIntStatus(bool bMasked)
+{
+    //
+    // Return either the interrupt status or the raw interrupt status as
+    // requested.
+    //
+    if(bMasked)
+    {
+        return(HWREG(FLASH_FCMISC));
+    }
+    else
+    {
+        return(HWREG(FLASH_FCRIS));
+    }
+}
+
+//*****************************************************************************
+//
+//! Clears flash controller interrupt sources.
+//!
+//! \param ui32IntFlags is the bit mask of the interrupt sources to be cleared,
+//! the same values as returned by FlashIntStatus().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FlashIntClear(uint32_t ui32IntFlags)
+{
+    HWREG(FLASH_FCMISC) = ui32IntFlags;
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
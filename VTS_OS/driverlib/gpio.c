@@ -46,6 +46,21 @@
 
 #include "driverlib/gpio.h"
 
+//*****************************************************************************
+//
+// ISRS
+//
+//
+//*****************************************************************************
+void (* GPIOD_Ptr )(void);
+void GPIOD_ISR(void){
+    //Clear The Flags before the callback so no edge is lost
+    HWREG(GPIO_PORTD_BASE + GPIO_O_ICR) = HWREG(GPIO_PORTD_BASE + GPIO_O_MIS);
+    if(GPIOD_Ptr != 0){
+        GPIOD_Ptr();
+    }
+}
+
 //*****************************************************************************
 //
 // A mapping of GPIO port address to interrupt number.
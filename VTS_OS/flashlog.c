@@ -0,0 +1,671 @@
+/******************************************************************************
+ * File Name: flashlog.c
+ *
+ * Description: Source file for the store-and-forward log. Position records
+ *              that cannot be delivered are appended to a ring of flash pages
+ *              and stay there until the server confirmed them:
+ *
+ *              slot : log seq | record (RecordPacked) | CRC-32 | ack word
+ *
+ *              A slot is programmed once after its page was erased and the ack
+ *              word is cleared to 0 on delivery, so no word is ever written
+ *              twice. The log seq grows with every append, the ring is
+ *              rebuilt at mount from the slots whose CRC matches: the head
+ *              follows the highest seq and the tail is the lowest seq not
+ *              acked. A slot cut by a power loss fails its CRC and is skipped,
+ *              a cut erase is repeated, so the log survives a power loss at
+ *              any point. At worst a record delivered just before the cut is
+ *              sent again, the server drops it by its sequence number.
+ *
+ *              The head erases the next page when it gets there, the pages
+ *              wear evenly and the oldest pending records are dropped once
+ *              the log is full. The storage is reached through a backend, the
+ *              internal flash on the target and a file on the host.
+ *
+ *              Delivered records stay readable until their page is erased,
+ *              which keeps the recent track for range queries by time. A
+ *              sparse index in RAM holds the oldest and newest record time of
+ *              each group of pages, and inside a group a page is told apart
+ *              by its first and last slots (records are appended in time
+ *              order). A query reads only the pages that may hold its range.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "flashlog.h"
+#include "crc32.h"
+#include <string.h>
+#if !defined(FlashLogHostBuild)
+#include <stdbool.h>
+#include "driverlib/flash.h"
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define FlashLogSlotWords   (FlashLogSlotSize/4)
+/* Word offsets in a slot */
+#define FlashLogSeqWord     0
+#define FlashLogDataWord    1
+#define FlashLogCrcWord     (FlashLogDataWord+FlashLogPayloadSize/4)
+#define FlashLogAckWord     (FlashLogCrcWord+1)
+/* Bytes the CRC is over and bytes programmed by an append */
+#define FlashLogCrcSize     (FlashLogCrcWord*4)
+#define FlashLogWriteSize   (FlashLogAckWord*4)
+
+/* State of a slot read back from flash */
+#define FlashLogSlotBlank   0
+#define FlashLogSlotValid   1
+#define FlashLogSlotTorn    2
+
+#if !defined(FlashLogHostBuild)
+/* Must match the LOG region of tm4c123gh6pm.lds */
+#define FlashLogInternalBase    0x00038000
+#define FlashLogInternalSize    0x00008000
+#endif
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t FlashLogReadSlot(uint32_t Slot,uint32_t *Words);
+static void FlashLogMountPage(uint32_t First);
+static void FlashLogMountSlot(uint32_t Slot,const uint32_t *Words);
+static uint8_t FlashLogPrepareHead(void);
+static void FlashLogFindTail(uint32_t From);
+static uint32_t FlashLogSlotTime(const uint32_t *Words);
+static void FlashLogIndexAdd(uint32_t Slot,uint32_t Time);
+static uint8_t FlashLogRangePage(const FlashLogRange_t *Range,uint32_t *Words);
+#if !defined(FlashLogHostBuild)
+static void FlashLogInternalRead(uint32_t Address,void *Data,uint32_t Size);
+#endif
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static const FlashLogBackend_t *FlashLog=NULL;
+static uint32_t FlashLogSlots;
+static uint32_t FlashLogSlotsPerPage;
+/* Slot the next record goes to, its page is erased once FlashLogHeadReady is set */
+static uint32_t FlashLogHead;
+static uint8_t  FlashLogHeadReady;
+/* Oldest pending slot, meaningful while FlashLogPending is not 0 */
+static uint32_t FlashLogTail;
+static uint32_t FlashLogPending;
+static uint32_t FlashLogNextSeq;
+/* Newest and oldest pending log seq met during the mount */
+static uint32_t FlashLogMaxSeq;
+static uint32_t FlashLogMinSeq;
+static FlashLogStats_t FlashLogStats;
+/* Time index: oldest and newest record time of each group of FlashLogIndexSpan pages, the oldest
+   is above the newest while the group holds no record with a time */
+static uint32_t FlashLogIndexMin[FlashLogIndexSize];
+static uint32_t FlashLogIndexMax[FlashLogIndexSize];
+static uint32_t FlashLogIndexSpan;
+
+#if !defined(FlashLogHostBuild)
+const FlashLogBackend_t FlashLogInternal={
+    FlashErase,
+    FlashProgram,
+    FlashLogInternalRead,
+    FlashLogInternalBase,
+    FlashLogInternalSize,
+    FLASH_ERASE_SIZE
+};
+#endif
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : FlashLogInit
+ * Description        : Mount the log of a backend: find the head and the oldest pending record.
+ *                      Pages are first told apart by their first and last slots, an erased page
+ *                      and a full page whose records were all delivered (acks go in order) are
+ *                      not read further, so the mount time follows the backlog and not the size
+ *                      of the flash. Slots found half written are skipped. The time index is
+ *                      built from the same slots.
+ * INPUTS             : const FlashLogBackend_t *Backend
+ * RETURNS            : uint8_t 1 when the log is ready
+ ***********************************************************************************************/
+uint8_t FlashLogInit(const FlashLogBackend_t *Backend)
+{
+    uint32_t Words[FlashLogSlotWords];
+    uint32_t Page;
+    uint32_t Last;
+    uint8_t  State;
+    FlashLog=NULL;
+    memset(&FlashLogStats,0,sizeof(FlashLogStats));
+    if(Backend->PageSize==0 || (Backend->PageSize%FlashLogSlotSize)!=0 ||
+       Backend->Size<Backend->PageSize*2 || (Backend->Size%Backend->PageSize)!=0)
+    {
+        return 0;
+    }
+    FlashLog=Backend;
+    FlashLogSlots=Backend->Size/FlashLogSlotSize;
+    FlashLogSlotsPerPage=Backend->PageSize/FlashLogSlotSize;
+    FlashLogHead=0;
+    FlashLogTail=0;
+    FlashLogPending=0;
+    FlashLogMaxSeq=0;
+    FlashLogIndexSpan=(Backend->Size/Backend->PageSize+FlashLogIndexSize-1)/FlashLogIndexSize;
+    memset(FlashLogIndexMin,0xFF,sizeof(FlashLogIndexMin));
+    memset(FlashLogIndexMax,0,sizeof(FlashLogIndexMax));
+    for(Page=0;Page<FlashLogSlots;Page+=FlashLogSlotsPerPage)
+    {
+        Last=Page+FlashLogSlotsPerPage-1;
+        State=FlashLogReadSlot(Page,Words);
+        if(State==FlashLogSlotValid)
+        {
+            FlashLogIndexAdd(Page,FlashLogSlotTime(Words));
+        }
+        if(State==FlashLogSlotBlank)
+        {
+            if(FlashLogReadSlot(Last,Words)==FlashLogSlotBlank)
+            {
+                continue;
+            }
+        }
+        else if(FlashLogReadSlot(Last,Words)==FlashLogSlotValid && Words[FlashLogAckWord]!=FlashLogBlank)
+        {
+            FlashLogMountSlot(Last,Words);
+            continue;
+        }
+        FlashLogMountPage(Page);
+    }
+    //A program that failed at the first slot of the head page leaves it looking erased
+    Page=FlashLogHead-(FlashLogHead%FlashLogSlotsPerPage);
+    if(FlashLogHead==Page && FlashLogReadSlot(Page,Words)==FlashLogSlotBlank &&
+       FlashLogReadSlot(Page+FlashLogSlotsPerPage-1,Words)==FlashLogSlotBlank)
+    {
+        FlashLogMountPage(Page);
+    }
+    FlashLogNextSeq=FlashLogMaxSeq+1;
+    return FlashLogPrepareHead();
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogAppend
+ * Description        : Write a record at the head. Entering a new page erases it first, the
+ *                      pending records it still held are dropped. On the internal flash the CPU
+ *                      stalls while a page is erased.
+ * INPUTS             : const Record_t *Record
+ * RETURNS            : uint8_t 1 when the record is stored
+ ***********************************************************************************************/
+uint8_t FlashLogAppend(const Record_t *Record)
+{
+    uint32_t Words[FlashLogSlotWords];
+    uint32_t Page;
+    uint32_t Slot;
+    if(FlashLog==NULL)
+    {
+        return 0;
+    }
+    if(!FlashLogHeadReady)
+    {
+        Page=FlashLogHead-(FlashLogHead%FlashLogSlotsPerPage);
+        for(Slot=Page;Slot<Page+FlashLogSlotsPerPage;Slot++)
+        {
+            if(FlashLogReadSlot(Slot,Words)==FlashLogSlotValid && Words[FlashLogAckWord]==FlashLogBlank)
+            {
+                FlashLogPending--;
+                FlashLogStats.Dropped++;
+            }
+        }
+        if(FlashLog->Erase(FlashLog->Base+Page*FlashLogSlotSize)!=0)
+        {
+            FlashLogStats.Errors++;
+            return 0;
+        }
+        FlashLogStats.Erases++;
+        FlashLogHeadReady=1;
+        //The head starts a new group of the time index, its older pages leave the index
+        if(((Page/FlashLogSlotsPerPage)%FlashLogIndexSpan)==0)
+        {
+            FlashLogIndexMin[Page/FlashLogSlotsPerPage/FlashLogIndexSpan]=FlashLogBlank;
+            FlashLogIndexMax[Page/FlashLogSlotsPerPage/FlashLogIndexSpan]=0;
+        }
+        if(FlashLogPending!=0 && (FlashLogTail-Page)<FlashLogSlotsPerPage)
+        {
+            FlashLogFindTail((Page+FlashLogSlotsPerPage)%FlashLogSlots);
+        }
+    }
+    Words[FlashLogSeqWord]=FlashLogNextSeq++;
+    RecordPack(Record,(uint8_t*)&Words[FlashLogDataWord]);
+    Words[FlashLogCrcWord]=Crc32((const uint8_t*)Words,FlashLogCrcSize);
+    Slot=FlashLogHead;
+    FlashLogHead=(FlashLogHead+1)%FlashLogSlots;
+    if((FlashLogHead%FlashLogSlotsPerPage)==0)
+    {
+        FlashLogHeadReady=0;
+    }
+    if(FlashLog->Program(Words,FlashLog->Base+Slot*FlashLogSlotSize,FlashLogWriteSize)!=0)
+    {
+        //The slot is left half written, the next append moves past it
+        FlashLogStats.Errors++;
+        return 0;
+    }
+    FlashLogIndexAdd(Slot,Record->Time);
+    if(FlashLogPending==0)
+    {
+        FlashLogTail=Slot;
+    }
+    FlashLogPending++;
+    FlashLogStats.Appended++;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogPeek
+ * Description        : Read the oldest pending record without removing it.
+ * INPUTS             : Record_t *Record
+ * RETURNS            : uint8_t 1 if a record is pending
+ ***********************************************************************************************/
+uint8_t FlashLogPeek(Record_t *Record)
+{
+    uint32_t Words[FlashLogSlotWords];
+    if(FlashLog==NULL || FlashLogPending==0)
+    {
+        return 0;
+    }
+    FlashLogReadSlot(FlashLogTail,Words);
+    RecordUnpack((const uint8_t*)&Words[FlashLogDataWord],Record);
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogPeekAt
+ * Description        : Read a pending record without removing it, 0 being the oldest. Walks the
+ *                      slots from the tail, meant for the few records of an upload batch.
+ * INPUTS             : uint32_t Index, Record_t *Record
+ * RETURNS            : uint8_t 1 if that many records are pending
+ ***********************************************************************************************/
+uint8_t FlashLogPeekAt(uint32_t Index,Record_t *Record)
+{
+    uint32_t Words[FlashLogSlotWords];
+    uint32_t Scanned;
+    uint32_t Slot;
+    if(FlashLog==NULL || Index>=FlashLogPending)
+    {
+        return 0;
+    }
+    Slot=FlashLogTail;
+    for(Scanned=0;Scanned<FlashLogSlots;Scanned++)
+    {
+        if(FlashLogReadSlot(Slot,Words)==FlashLogSlotValid && Words[FlashLogAckWord]==FlashLogBlank)
+        {
+            if(Index==0)
+            {
+                RecordUnpack((const uint8_t*)&Words[FlashLogDataWord],Record);
+                return 1;
+            }
+            Index--;
+        }
+        Slot=(Slot+1)%FlashLogSlots;
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogAck
+ * Description        : The oldest pending record was delivered, clear its ack word and move the
+ *                      tail to the next pending one.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void FlashLogAck(void)
+{
+    uint32_t Ack=0;
+    if(FlashLog==NULL || FlashLogPending==0)
+    {
+        return;
+    }
+    if(FlashLog->Program(&Ack,FlashLog->Base+FlashLogTail*FlashLogSlotSize+FlashLogAckWord*4,4)!=0)
+    {
+        FlashLogStats.Errors++;
+    }
+    FlashLogPending--;
+    FlashLogStats.Acked++;
+    if(FlashLogPending!=0)
+    {
+        FlashLogFindTail((FlashLogTail+1)%FlashLogSlots);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogCount
+ * Description        : Number of records waiting for delivery in the log.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t FlashLogCount(void)
+{
+    return FlashLogPending;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogGetPosition
+ * Description        : Where the log stands: the log seq of the next append, the slot it goes to
+ *                      and the oldest pending slot (equal to the head when nothing is pending).
+ * INPUTS             : uint32_t *NextSeq, uint32_t *Head, uint32_t *Tail
+ * RETURNS            : void
+ ***********************************************************************************************/
+void FlashLogGetPosition(uint32_t *NextSeq,uint32_t *Head,uint32_t *Tail)
+{
+    *NextSeq=FlashLogNextSeq;
+    *Head=FlashLogHead;
+    *Tail=(FlashLogPending!=0)?FlashLogTail:FlashLogHead;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogGetStats
+ * Description        : Log accounting since FlashLogInit.
+ * INPUTS             : void
+ * RETURNS            : const FlashLogStats_t*
+ ***********************************************************************************************/
+const FlashLogStats_t *FlashLogGetStats(void)
+{
+    return &FlashLogStats;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogRangeStart
+ * Description        : Start a query for the stored records taken between two times, delivered
+ *                      or not. The records come oldest first, from the page after the head
+ *                      around the ring up to the head.
+ * INPUTS             : FlashLogRange_t *Range, uint32_t From, uint32_t To (UTC Unix times, both
+ *                      included)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void FlashLogRangeStart(FlashLogRange_t *Range,uint32_t From,uint32_t To)
+{
+    uint32_t Page=FlashLogHead-(FlashLogHead%FlashLogSlotsPerPage);
+    Range->From=From;
+    Range->To=To;
+    Range->Slot=0;
+    Range->Left=0;
+    if(FlashLog==NULL)
+    {
+        return;
+    }
+    //A head page that was not erased yet still holds the oldest records
+    Range->Slot=FlashLogHeadReady?((Page+FlashLogSlotsPerPage)%FlashLogSlots):FlashLogHead;
+    Range->Left=(FlashLogHead+FlashLogSlots-Range->Slot)%FlashLogSlots;
+    if(Range->Left==0)
+    {
+        Range->Left=FlashLogSlots;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogRangeNext
+ * Description        : Read the next record of a query. Pages the index or their first and last
+ *                      slots place outside the range are stepped over without reading them.
+ *                      Records without a time never match. The head may overwrite pages the query
+ *                      did not reach yet, their newer records are then matched instead.
+ * INPUTS             : FlashLogRange_t *Range, Record_t *Record
+ * RETURNS            : uint8_t 1 if a record was found, 0 once the query reached the head
+ ***********************************************************************************************/
+uint8_t FlashLogRangeNext(FlashLogRange_t *Range,Record_t *Record)
+{
+    uint32_t Words[FlashLogSlotWords];
+    uint32_t Skip;
+    uint8_t  State;
+    if(FlashLog==NULL)
+    {
+        return 0;
+    }
+    while(Range->Left!=0)
+    {
+        if((Range->Slot%FlashLogSlotsPerPage)==0 && !FlashLogRangePage(Range,Words))
+        {
+            Skip=(Range->Left<FlashLogSlotsPerPage)?Range->Left:FlashLogSlotsPerPage;
+            Range->Slot=(Range->Slot+Skip)%FlashLogSlots;
+            Range->Left-=Skip;
+            continue;
+        }
+        State=FlashLogReadSlot(Range->Slot,Words);
+        FlashLogStats.RangeReads++;
+        Range->Slot=(Range->Slot+1)%FlashLogSlots;
+        Range->Left--;
+        if(State==FlashLogSlotValid)
+        {
+            RecordUnpack((const uint8_t*)&Words[FlashLogDataWord],Record);
+            if(Record->Time!=0 && Record->Time>=Range->From && Record->Time<=Range->To)
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogReadSlot
+ * Description        : Read a slot and tell if it is blank, holds a record or was cut while being
+ *                      written (or erased).
+ * INPUTS             : uint32_t Slot, uint32_t *Words (FlashLogSlotWords)
+ * RETURNS            : uint8_t FlashLogSlotBlank, FlashLogSlotValid or FlashLogSlotTorn
+ ***********************************************************************************************/
+static uint8_t FlashLogReadSlot(uint32_t Slot,uint32_t *Words)
+{
+    uint32_t Index;
+    FlashLog->Read(FlashLog->Base+Slot*FlashLogSlotSize,Words,FlashLogSlotSize);
+    for(Index=0;Index<FlashLogSlotWords;Index++)
+    {
+        if(Words[Index]!=FlashLogBlank)
+        {
+            break;
+        }
+    }
+    if(Index==FlashLogSlotWords)
+    {
+        return FlashLogSlotBlank;
+    }
+    if(Words[FlashLogSeqWord]==FlashLogBlank ||
+       Words[FlashLogCrcWord]!=Crc32((const uint8_t*)Words,FlashLogCrcSize))
+    {
+        return FlashLogSlotTorn;
+    }
+    return FlashLogSlotValid;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogMountPage
+ * Description        : Mount every slot of a page.
+ * INPUTS             : uint32_t First (first slot of the page)
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashLogMountPage(uint32_t First)
+{
+    uint32_t Words[FlashLogSlotWords];
+    uint32_t Slot;
+    uint8_t  State;
+    for(Slot=First;Slot<First+FlashLogSlotsPerPage;Slot++)
+    {
+        State=FlashLogReadSlot(Slot,Words);
+        if(State==FlashLogSlotTorn)
+        {
+            FlashLogStats.Torn++;
+        }
+        if(State==FlashLogSlotValid)
+        {
+            FlashLogMountSlot(Slot,Words);
+        }
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogMountSlot
+ * Description        : Account a valid slot found during the mount: the newest record sets the
+ *                      head, the oldest pending one the tail, and its time goes to the index.
+ * INPUTS             : uint32_t Slot, const uint32_t *Words
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashLogMountSlot(uint32_t Slot,const uint32_t *Words)
+{
+    FlashLogIndexAdd(Slot,FlashLogSlotTime(Words));
+    if(Words[FlashLogSeqWord]>=FlashLogMaxSeq)
+    {
+        FlashLogMaxSeq=Words[FlashLogSeqWord];
+        FlashLogHead=(Slot+1)%FlashLogSlots;
+    }
+    if(Words[FlashLogAckWord]==FlashLogBlank)
+    {
+        if(FlashLogPending==0 || Words[FlashLogSeqWord]<FlashLogMinSeq)
+        {
+            FlashLogMinSeq=Words[FlashLogSeqWord];
+            FlashLogTail=Slot;
+        }
+        FlashLogPending++;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogPrepareHead
+ * Description        : After the mount, make sure the head points to a blank slot. A slot cut by a
+ *                      power loss is stepped over, a page that is not blank from the head on is
+ *                      left for the next append to erase.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1
+ ***********************************************************************************************/
+static uint8_t FlashLogPrepareHead(void)
+{
+    uint32_t Words[FlashLogSlotWords];
+    uint32_t Slot;
+    while((FlashLogHead%FlashLogSlotsPerPage)!=0 && FlashLogReadSlot(FlashLogHead,Words)!=FlashLogSlotBlank)
+    {
+        FlashLogHead=(FlashLogHead+1)%FlashLogSlots;
+    }
+    FlashLogHeadReady=1;
+    for(Slot=FlashLogHead;Slot<FlashLogHead-(FlashLogHead%FlashLogSlotsPerPage)+FlashLogSlotsPerPage;Slot++)
+    {
+        if(FlashLogReadSlot(Slot,Words)!=FlashLogSlotBlank)
+        {
+            FlashLogHeadReady=0;
+            break;
+        }
+    }
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFindTail
+ * Description        : Move the tail to the first pending record from a slot on, going around the
+ *                      ring up to the head. Called while FlashLogPending is not 0.
+ * INPUTS             : uint32_t From
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashLogFindTail(uint32_t From)
+{
+    uint32_t Words[FlashLogSlotWords];
+    uint32_t Slot;
+    for(Slot=From;Slot!=FlashLogHead;Slot=(Slot+1)%FlashLogSlots)
+    {
+        if(FlashLogReadSlot(Slot,Words)==FlashLogSlotValid && Words[FlashLogAckWord]==FlashLogBlank)
+        {
+            FlashLogTail=Slot;
+            return;
+        }
+    }
+    //Nothing pending after all, the counter was off
+    FlashLogPending=0;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogSlotTime
+ * Description        : Time of the record held by a valid slot.
+ * INPUTS             : const uint32_t *Words
+ * RETURNS            : uint32_t UTC Unix time, 0 if not known
+ ***********************************************************************************************/
+static uint32_t FlashLogSlotTime(const uint32_t *Words)
+{
+    Record_t Record;
+    RecordUnpack((const uint8_t*)&Words[FlashLogDataWord],&Record);
+    return Record.Time;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogIndexAdd
+ * Description        : Widen the index entry of the group of a slot to the time of its record.
+ * INPUTS             : uint32_t Slot, uint32_t Time (0 when not known, left out)
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashLogIndexAdd(uint32_t Slot,uint32_t Time)
+{
+    uint32_t Entry=Slot/FlashLogSlotsPerPage/FlashLogIndexSpan;
+    if(Time==0)
+    {
+        return;
+    }
+    if(Time<FlashLogIndexMin[Entry])
+    {
+        FlashLogIndexMin[Entry]=Time;
+    }
+    if(Time>FlashLogIndexMax[Entry])
+    {
+        FlashLogIndexMax[Entry]=Time;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogRangePage
+ * Description        : Tell if the page a query is at may hold records of its range: the index
+ *                      entry of its group must overlap the range, then the page must not start
+ *                      after it or end before it, nor be erased. The group the head is in may
+ *                      still have pages written before its entry was reset, only their slots tell.
+ * INPUTS             : const FlashLogRange_t *Range, uint32_t *Words (scratch)
+ * RETURNS            : uint8_t 0 when the page can be stepped over
+ ***********************************************************************************************/
+static uint8_t FlashLogRangePage(const FlashLogRange_t *Range,uint32_t *Words)
+{
+    uint32_t Page=Range->Slot/FlashLogSlotsPerPage;
+    uint32_t Entry=Page/FlashLogIndexSpan;
+    uint32_t Time;
+    uint8_t  First;
+    uint8_t  Last;
+    if(Entry!=FlashLogHead/FlashLogSlotsPerPage/FlashLogIndexSpan &&
+       (FlashLogIndexMin[Entry]>Range->To || FlashLogIndexMax[Entry]<Range->From))
+    {
+        return 0;
+    }
+    FlashLogStats.RangeReads+=2;
+    First=FlashLogReadSlot(Range->Slot,Words);
+    if(First==FlashLogSlotValid)
+    {
+        Time=FlashLogSlotTime(Words);
+        if(Time!=0 && Time>Range->To)
+        {
+            return 0;
+        }
+    }
+    Last=FlashLogReadSlot(Range->Slot+FlashLogSlotsPerPage-1,Words);
+    if(Last==FlashLogSlotValid)
+    {
+        Time=FlashLogSlotTime(Words);
+        if(Time!=0 && Time<Range->From)
+        {
+            return 0;
+        }
+    }
+    //An erased page, only the head page may have records between two blank ends
+    return (First!=FlashLogSlotBlank || Last!=FlashLogSlotBlank || Page==FlashLogHead/FlashLogSlotsPerPage);
+}
+
+#if !defined(FlashLogHostBuild)
+/***********************************************************************************************
+ * Function Name      : FlashLogInternalRead
+ * Description        : The internal flash is memory mapped, a read is a copy.
+ * INPUTS             : uint32_t Address, void *Data, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashLogInternalRead(uint32_t Address,void *Data,uint32_t Size)
+{
+    memcpy(Data,(const void*)Address,Size);
+}
+#endif
@@ -0,0 +1,86 @@
+/******************************************************************************
+ * File Name: flashlog.h
+ *
+ * Description: Header file for the store-and-forward log of position records
+ *              kept in flash while the reports cannot be delivered.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_FLASHLOG_H_
+#define SRC_FLASHLOG_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+#include "record.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* A slot is log seq | payload | CRC-32 of both | ack word, a multiple of the flash word */
+#define FlashLogPayloadSize RecordPackedSize
+#define FlashLogSlotSize    32
+/* Value of a word nothing was programmed in since the page erase */
+#define FlashLogBlank       0xFFFFFFFFU
+/* Entries of the time index kept in RAM, each holds the oldest and newest record time of a group
+   of pages, as many pages as it takes to cover the log with this many entries */
+#define FlashLogIndexSize   64
+
+typedef struct{
+    /* Erase the page at Address, 0 on success */
+    int32_t (*Erase)(uint32_t Address);
+    /* Program Size bytes (a multiple of 4) of Data at Address, 0 on success */
+    int32_t (*Program)(uint32_t *Data,uint32_t Address,uint32_t Size);
+    /* Copy Size bytes from Address */
+    void    (*Read)(uint32_t Address,void *Data,uint32_t Size);
+    uint32_t Base;           /* Address of the first page */
+    uint32_t Size;           /* Bytes given to the log, a multiple of PageSize */
+    uint32_t PageSize;       /* Erase unit, a multiple of FlashLogSlotSize */
+}FlashLogBackend_t;
+
+typedef struct{
+    uint32_t Appended;       /* Records written */
+    uint32_t Acked;          /* Records confirmed delivered */
+    uint32_t Dropped;        /* Pending records erased because the log was full */
+    uint32_t Erases;         /* Pages erased, the wear of the whole region */
+    uint32_t Torn;           /* Slots found half written at mount and skipped */
+    uint32_t Errors;         /* Erase or program operations the backend failed */
+    uint32_t RangeReads;     /* Slots read by time range queries */
+}FlashLogStats_t;
+
+typedef struct{
+    uint32_t From;           /* UTC Unix times, both included */
+    uint32_t To;
+    uint32_t Slot;           /* Next slot to look at */
+    uint32_t Left;           /* Slots up to the head not looked at yet */
+}FlashLogRange_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+uint8_t FlashLogInit(const FlashLogBackend_t *Backend);
+uint8_t FlashLogAppend(const Record_t *Record);
+uint8_t FlashLogPeek(Record_t *Record);
+uint8_t FlashLogPeekAt(uint32_t Index,Record_t *Record);
+void FlashLogAck(void);
+uint32_t FlashLogCount(void);
+void FlashLogGetPosition(uint32_t *NextSeq,uint32_t *Head,uint32_t *Tail);
+const FlashLogStats_t *FlashLogGetStats(void);
+void FlashLogRangeStart(FlashLogRange_t *Range,uint32_t From,uint32_t To);
+uint8_t FlashLogRangeNext(FlashLogRange_t *Range,Record_t *Record);
+
+#if defined(FlashLogHostBuild)
+/* File standing for the flash on the host, see flashlog_file.c */
+const FlashLogBackend_t *FlashLogFileOpen(const char *Path,uint32_t Size,uint32_t PageSize);
+void FlashLogFileClose(void);
+void FlashLogFileCutAfter(int32_t Words);
+#else
+/* Region of the internal flash reserved by tm4c123gh6pm.lds */
+extern const FlashLogBackend_t FlashLogInternal;
+#endif
+
+#endif /* SRC_FLASHLOG_H_ */
@@ -0,0 +1,196 @@
+/******************************************************************************
+ * File Name: flashlog_file.c
+ *
+ * Description: Source file for the host backend of the store-and-forward
+ *              log. A file stands for the flash and behaves like it: erasing
+ *              sets a page to 0xFF and programming can only clear bits. A cut
+ *              can be armed to stop the writes after a number of words, as a
+ *              power loss would, to test the recovery of flashlog.c. Builds
+ *              with FlashLogHostBuild defined only.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(FlashLogHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "flashlog.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static int32_t FlashLogFileErase(uint32_t Address);
+static int32_t FlashLogFileProgram(uint32_t *Data,uint32_t Address,uint32_t Size);
+static void FlashLogFileRead(uint32_t Address,void *Data,uint32_t Size);
+static uint8_t FlashLogFileCut(void);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static FILE *FlashLogFile=NULL;
+static FlashLogBackend_t FlashLogFileBackend;
+/* Words still written before the power is cut, negative when no cut is armed */
+static int32_t FlashLogFileWords=-1;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFileOpen
+ * Description        : Open the file standing for the flash, a missing file is created erased.
+ * INPUTS             : const char *Path, uint32_t Size, uint32_t PageSize
+ * RETURNS            : const FlashLogBackend_t* or NULL if the file cannot be opened
+ ***********************************************************************************************/
+const FlashLogBackend_t *FlashLogFileOpen(const char *Path,uint32_t Size,uint32_t PageSize)
+{
+    uint32_t Blank=FlashLogBlank;
+    uint32_t Offset;
+    FlashLogFileClose();
+    FlashLogFile=fopen(Path,"r+b");
+    if(FlashLogFile==NULL)
+    {
+        FlashLogFile=fopen(Path,"w+b");
+        if(FlashLogFile==NULL)
+        {
+            return NULL;
+        }
+        for(Offset=0;Offset<Size;Offset+=4)
+        {
+            fwrite(&Blank,4,1,FlashLogFile);
+        }
+        fflush(FlashLogFile);
+    }
+    FlashLogFileBackend.Erase=FlashLogFileErase;
+    FlashLogFileBackend.Program=FlashLogFileProgram;
+    FlashLogFileBackend.Read=FlashLogFileRead;
+    FlashLogFileBackend.Base=0;
+    FlashLogFileBackend.Size=Size;
+    FlashLogFileBackend.PageSize=PageSize;
+    FlashLogFileWords=-1;
+    return &FlashLogFileBackend;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFileClose
+ * Description        : Close the file, as if the device was switched off.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void FlashLogFileClose(void)
+{
+    if(FlashLogFile!=NULL)
+    {
+        fclose(FlashLogFile);
+        FlashLogFile=NULL;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFileCutAfter
+ * Description        : Cut the power after this many more words were written, an erase counting
+ *                      as one word per 4 bytes. Every later write fails until the file is opened
+ *                      again. A negative count disarms the cut.
+ * INPUTS             : int32_t Words
+ * RETURNS            : void
+ ***********************************************************************************************/
+void FlashLogFileCutAfter(int32_t Words)
+{
+    FlashLogFileWords=Words;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFileErase
+ * Description        : Set a page to 0xFF. A cut leaves the first part of it erased only.
+ * INPUTS             : uint32_t Address
+ * RETURNS            : int32_t 0 on success, -1 when the power was cut
+ ***********************************************************************************************/
+static int32_t FlashLogFileErase(uint32_t Address)
+{
+    uint32_t Blank=FlashLogBlank;
+    uint32_t Offset;
+    fseek(FlashLogFile,(long)Address,SEEK_SET);
+    for(Offset=0;Offset<FlashLogFileBackend.PageSize;Offset+=4)
+    {
+        if(FlashLogFileCut())
+        {
+            fflush(FlashLogFile);
+            return -1;
+        }
+        fwrite(&Blank,4,1,FlashLogFile);
+    }
+    fflush(FlashLogFile);
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFileProgram
+ * Description        : Clear the bits of the words that are 0 in Data, one word at a time.
+ * INPUTS             : uint32_t *Data, uint32_t Address, uint32_t Size
+ * RETURNS            : int32_t 0 on success, -1 when the power was cut
+ ***********************************************************************************************/
+static int32_t FlashLogFileProgram(uint32_t *Data,uint32_t Address,uint32_t Size)
+{
+    uint32_t Word;
+    for(;Size>=4;Size-=4,Address+=4,Data++)
+    {
+        if(FlashLogFileCut())
+        {
+            fflush(FlashLogFile);
+            return -1;
+        }
+        fseek(FlashLogFile,(long)Address,SEEK_SET);
+        if(fread(&Word,4,1,FlashLogFile)!=1)
+        {
+            return -1;
+        }
+        Word&=*Data;
+        fseek(FlashLogFile,(long)Address,SEEK_SET);
+        fwrite(&Word,4,1,FlashLogFile);
+    }
+    fflush(FlashLogFile);
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFileRead
+ * Description        : Copy Size bytes from the file.
+ * INPUTS             : uint32_t Address, void *Data, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashLogFileRead(uint32_t Address,void *Data,uint32_t Size)
+{
+    fseek(FlashLogFile,(long)Address,SEEK_SET);
+    if(fread(Data,1,Size,FlashLogFile)!=Size)
+    {
+        memset(Data,0xFF,Size);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashLogFileCut
+ * Description        : Count down the words of an armed cut.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 once the power is cut
+ ***********************************************************************************************/
+static uint8_t FlashLogFileCut(void)
+{
+    if(FlashLogFileWords<0)
+    {
+        return 0;
+    }
+    if(FlashLogFileWords==0)
+    {
+        return 1;
+    }
+    FlashLogFileWords--;
+    return 0;
+}
+
+#endif /* FlashLogHostBuild */
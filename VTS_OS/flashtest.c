@@ -0,0 +1,629 @@
+/******************************************************************************
+ * File Name: flashtest.c
+ *
+ * Description: Host test of the recovery of the store-and-forward log from a
+ *              power loss, on the internal flash stand-in (flashlog_file.c)
+ *              and on the SPI NOR stand-in (spinor.c over spinor_file.c). For
+ *              an append, an ack and an erase of a page still holding pending
+ *              records, the power is cut after every possible number of words
+ *              (bytes on the SPI NOR) the operation writes. A failed append is
+ *              also followed by more appends before the power is lost, as a
+ *              brown-out the device runs through would. Each time the log
+ *              is mounted again and FlashLogInit must find the pending records
+ *              the cut left, in order and intact, with the tail on the oldest
+ *              and the head where the next append does not overwrite any of
+ *              them. A last case checks that the report queue hands a report
+ *              out of retries to the flash log. Builds with FlashLogHostBuild
+ *              and SpiNorHostBuild defined only, with flashlog.c,
+ *              flashlog_file.c, spinor.c, spinor_file.c, report.c, record.c
+ *              and crc32.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(FlashLogHostBuild) && defined(SpiNorHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "flashlog.h"
+#include "spinor.h"
+#include "report.h"
+#include "timesvc.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define FlashTestPath       "flashtest.bin"
+/* Four 1 KB pages of internal flash, and the smallest SPI NOR chip */
+#define FlashTestFileSize   4096
+#define FlashTestFilePage   1024
+#define FlashTestNorSize    65536
+/* Record seqs, the record appended after a recovery takes the last one */
+#define FlashTestMaxSeq     4096
+#define FlashTestAfterSeq   (FlashTestMaxSeq-1)
+
+typedef enum{
+    FlashTestAppendMid,      /* Append in the middle of a page */
+    FlashTestAppendPage,     /* Append entering a new page, erased first */
+    FlashTestAppendRetry,    /* Append entering a new page that fails, the device runs on */
+    FlashTestAckMid,         /* Ack in the middle of a page */
+    FlashTestAckPage,        /* Ack of the last pending record of a page */
+    FlashTestErase,          /* Append on a full log, erasing a page of pending records */
+    FlashTestCases
+}FlashTestCase_t;
+
+typedef struct{
+    const char *Name;
+    const FlashLogBackend_t *(*Open)(void);
+    void (*Close)(void);
+    void (*CutAfter)(int32_t Units);
+    uint32_t Size;           /* Bytes of the file */
+    uint32_t Unit;           /* Bytes a unit of the cut stands for */
+    uint32_t EraseStride;    /* Units between two cuts inside a page erase */
+}FlashTestMedium_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t FlashTestRun(const FlashTestMedium_t *Medium,FlashTestCase_t Case);
+static uint8_t FlashTestSetUp(const FlashTestMedium_t *Medium,FlashTestCase_t Case);
+static uint8_t FlashTestCut(const FlashTestMedium_t *Medium,FlashTestCase_t Case,int32_t Units,uint8_t *Done);
+static uint8_t FlashTestRecover(const FlashTestMedium_t *Medium,const char *Name,int32_t Units);
+static uint8_t FlashTestAppend(uint32_t Seq);
+static void FlashTestAck(uint32_t Count);
+static void FlashTestRecord(uint32_t Seq,Record_t *Record);
+static void FlashTestSave(const FlashTestMedium_t *Medium);
+static void FlashTestRestore(const FlashTestMedium_t *Medium);
+static const FlashLogBackend_t *FlashTestFileOpen(void);
+static const FlashLogBackend_t *FlashTestNorOpen(void);
+static uint8_t FlashTestNack(void);
+static uint8_t FlashTestStore(const Report_t *Report);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static const char *const FlashTestCaseNames[FlashTestCases]={"append mid page","append new page",
+    "append fails","ack mid page","ack page end","erase pending page"};
+static const FlashTestMedium_t FlashTestMedia[]={
+    {"internal",FlashTestFileOpen,FlashLogFileClose,FlashLogFileCutAfter,FlashTestFileSize,4,1},
+    /* A cut every 61 bytes of a sector erase lands at every offset of a slot */
+    {"spi nor",FlashTestNorOpen,SpiNorFileClose,SpiNorFileCutAfter,FlashTestNorSize,1,61}
+};
+static const FlashLogBackend_t *FlashTestBackend;
+/* Image of the flash once a case is set up, restored before every cut */
+static uint8_t  FlashTestImage[FlashTestNorSize];
+/* Slot of every record appended, pending records oldest first */
+static uint32_t FlashTestSlot[FlashTestMaxSeq];
+static uint32_t FlashTestPending[FlashTestMaxSeq];
+static uint32_t FlashTestPendingCount;
+/* Records that must and may be pending after the recovery */
+static uint8_t  FlashTestRequired[FlashTestMaxSeq];
+static uint8_t  FlashTestAllowed[FlashTestMaxSeq];
+/* Last record appended while setting up, and the slot the cut operation wrote to */
+static uint32_t FlashTestLastSeq;
+static uint32_t FlashTestAttempt;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Run every case on both media, then the case of the report queue.
+ * INPUTS             : void
+ * RETURNS            : int 0, 1 if a case failed
+ ***********************************************************************************************/
+int main(void)
+{
+    uint32_t Medium;
+    FlashTestCase_t Case;
+    uint8_t  Failed=0;
+    for(Medium=0;Medium<sizeof(FlashTestMedia)/sizeof(FlashTestMedia[0]);Medium++)
+    {
+        for(Case=FlashTestAppendMid;Case<FlashTestCases;Case++)
+        {
+            Failed|=FlashTestRun(&FlashTestMedia[Medium],Case);
+        }
+    }
+    Failed|=FlashTestNack();
+    remove(FlashTestPath);
+    printf("%s\n",Failed?"FAILED":"all passed");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestRun
+ * Description        : Cut the power of a case after 0, 1, 2... units until the operation gets to
+ *                      its end before the cut, recovering the log after each. A page erase is
+ *                      cut every EraseStride units.
+ * INPUTS             : const FlashTestMedium_t *Medium, FlashTestCase_t Case
+ * RETURNS            : uint8_t 0 when every recovery passed, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t FlashTestRun(const FlashTestMedium_t *Medium,FlashTestCase_t Case)
+{
+    int32_t  Units;
+    uint32_t Cuts=0;
+    uint8_t  Done=0;
+    if(!FlashTestSetUp(Medium,Case))
+    {
+        printf("%-8s %-19s FAIL set up\n",Medium->Name,FlashTestCaseNames[Case]);
+        return 1;
+    }
+    FlashTestSave(Medium);
+    for(Units=0;!Done;Cuts++)
+    {
+        if(FlashTestCut(Medium,Case,Units,&Done))
+        {
+            return 1;
+        }
+        Units+=(Case==FlashTestErase && (Units+Medium->EraseStride)*Medium->Unit<FlashTestBackend->PageSize) ?
+               Medium->EraseStride : 1;
+    }
+    printf("%-8s %-19s ok %u cut points\n",Medium->Name,FlashTestCaseNames[Case],(unsigned)Cuts);
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestSetUp
+ * Description        : Start from an erased flash and write the records of a case, leaving the
+ *                      log just before the operation to cut.
+ * INPUTS             : const FlashTestMedium_t *Medium, FlashTestCase_t Case
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+static uint8_t FlashTestSetUp(const FlashTestMedium_t *Medium,FlashTestCase_t Case)
+{
+    uint32_t PerPage;
+    uint32_t Count;
+    uint32_t Acks;
+    uint32_t Seq;
+    remove(FlashTestPath);
+    FlashTestBackend=Medium->Open();
+    if(FlashTestBackend==NULL || !FlashLogInit(FlashTestBackend))
+    {
+        return 0;
+    }
+    PerPage=FlashTestBackend->PageSize/FlashLogSlotSize;
+    FlashTestPendingCount=0;
+    switch(Case)
+    {
+    case FlashTestAppendMid:
+    case FlashTestAckMid:
+        Count=5;
+        Acks=2;
+        break;
+    case FlashTestAppendPage:
+    case FlashTestAppendRetry:
+        Count=PerPage;
+        Acks=PerPage-2;
+        break;
+    case FlashTestAckPage:
+        Count=PerPage+2;
+        Acks=PerPage-1;
+        break;
+    default:
+        Count=FlashTestBackend->Size/FlashLogSlotSize;
+        Acks=2;
+        break;
+    }
+    for(Seq=1;Seq<=Count;Seq++)
+    {
+        if(!FlashTestAppend(Seq))
+        {
+            return 0;
+        }
+    }
+    FlashTestAck(Acks);
+    Medium->Close();
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestCut
+ * Description        : Mount the set up log, cut the power after a number of units of the
+ *                      operation of the case and check the recovery. The records the operation
+ *                      touches may go either way unless it got to its end, or wrote nothing.
+ * INPUTS             : const FlashTestMedium_t *Medium, FlashTestCase_t Case, int32_t Units,
+ *                      uint8_t *Done (out: 1 when the operation ended before the cut)
+ * RETURNS            : uint8_t 0 when the recovery passed, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t FlashTestCut(const FlashTestMedium_t *Medium,FlashTestCase_t Case,int32_t Units,uint8_t *Done)
+{
+    Record_t Record;
+    uint32_t Index;
+    uint32_t NewSeq=FlashTestLastSeq+1;
+    uint32_t Seq;
+    uint32_t Head;
+    uint32_t Tail;
+    uint32_t PerPage;
+    FlashTestRestore(Medium);
+    FlashTestBackend=Medium->Open();
+    if(!FlashLogInit(FlashTestBackend) || FlashLogCount()!=FlashTestPendingCount)
+    {
+        printf("%-8s %-19s FAIL mount before the cut\n",Medium->Name,FlashTestCaseNames[Case]);
+        return 1;
+    }
+    memset(FlashTestRequired,0,sizeof(FlashTestRequired));
+    memset(FlashTestAllowed,0,sizeof(FlashTestAllowed));
+    for(Index=0;Index<FlashTestPendingCount;Index++)
+    {
+        FlashTestRequired[FlashTestPending[Index]]=1;
+        FlashTestAllowed[FlashTestPending[Index]]=1;
+    }
+    FlashLogGetPosition(&Seq,&Head,&Tail);
+    PerPage=FlashTestBackend->PageSize/FlashLogSlotSize;
+    FlashTestAttempt=Head;
+    Medium->CutAfter(Units);
+    if(Case==FlashTestAckMid || Case==FlashTestAckPage)
+    {
+        FlashLogAck();
+        *Done=(FlashLogGetStats()->Errors==0);
+        //An ack that cleared any bit of the ack word counts
+        FlashTestRequired[FlashTestPending[0]]=(Units==0);
+    }
+    else
+    {
+        FlashTestRecord(NewSeq,&Record);
+        *Done=(FlashLogAppend(&Record)!=0);
+        FlashTestAllowed[NewSeq]=(Units!=0);
+        FlashTestRequired[NewSeq]=*Done;
+        //The write failed but the power came back, the next appends must not be lost
+        if(Case==FlashTestAppendRetry && !*Done)
+        {
+            Medium->CutAfter(-1);
+            for(Seq=NewSeq+1;Seq<=NewSeq+2;Seq++)
+            {
+                FlashTestRecord(Seq,&Record);
+                FlashTestRequired[Seq]=FlashLogAppend(&Record);
+                FlashTestAllowed[Seq]=1;
+            }
+            FlashLogGetPosition(&Seq,&FlashTestAttempt,&Tail);
+        }
+        if(Case==FlashTestErase)
+        {
+            //The records of the page erased may survive a cut erase only
+            for(Index=0;Index<FlashTestPendingCount;Index++)
+            {
+                if(FlashTestSlot[FlashTestPending[Index]]<PerPage)
+                {
+                    FlashTestRequired[FlashTestPending[Index]]=0;
+                    FlashTestAllowed[FlashTestPending[Index]]=!*Done;
+                }
+            }
+        }
+    }
+    Medium->Close();
+    return FlashTestRecover(Medium,FlashTestCaseNames[Case],Units);
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestRecover
+ * Description        : Mount the log after a cut. The tail must be on the oldest pending record
+ *                      and the head on the slot written or the one after. A record is appended
+ *                      and the log mounted again: the pending records must then come back intact,
+ *                      in order, all the required ones and only allowed ones, and the new record
+ *                      last.
+ * INPUTS             : const FlashTestMedium_t *Medium, const char *Name, int32_t Units
+ * RETURNS            : uint8_t 0 when the recovery passed, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t FlashTestRecover(const FlashTestMedium_t *Medium,const char *Name,int32_t Units)
+{
+    Record_t Record;
+    Record_t Expected;
+    uint32_t Count;
+    uint32_t Last=0;
+    uint32_t Seq;
+    uint32_t Head;
+    uint32_t Tail;
+    uint32_t Dropped;
+    uint8_t  After=0;
+    const char *Error=NULL;
+    FlashTestBackend=Medium->Open();
+    if(!FlashLogInit(FlashTestBackend))
+    {
+        Error="mount";
+    }
+    Count=FlashLogCount();
+    FlashLogGetPosition(&Seq,&Head,&Tail);
+    if(Error==NULL && Count!=0 &&
+       (!FlashLogPeek(&Record) || Record.Seq>=FlashTestMaxSeq || Tail!=FlashTestSlot[Record.Seq]))
+    {
+        Error="tail not on the oldest pending record";
+    }
+    if(Error==NULL && Head!=FlashTestAttempt && Head!=(FlashTestAttempt+1)%(FlashTestBackend->Size/FlashLogSlotSize))
+    {
+        Error="head moved";
+    }
+    //The log goes on from there, entering a page may drop the oldest records
+    FlashTestRecord(FlashTestAfterSeq,&Expected);
+    if(Error==NULL && !FlashLogAppend(&Expected))
+    {
+        Error="append after the recovery";
+    }
+    Dropped=FlashLogGetStats()->Dropped;
+    Medium->Close();
+    FlashTestBackend=Medium->Open();
+    if(Error==NULL && (!FlashLogInit(FlashTestBackend) || FlashLogCount()!=Count-Dropped+1))
+    {
+        Error="pending records after the next append";
+    }
+    while(Error==NULL && FlashLogPeek(&Record))
+    {
+        if(Record.Seq==FlashTestAfterSeq)
+        {
+            After=1;
+            if(FlashLogCount()!=1)
+            {
+                Error="records after the next append";
+            }
+        }
+        else if(Record.Seq>=FlashTestMaxSeq || !FlashTestAllowed[Record.Seq] || Record.Seq<=Last)
+        {
+            Error="record not expected or out of order";
+        }
+        else
+        {
+            FlashTestRecord(Record.Seq,&Expected);
+            if(memcmp(&Record,&Expected,sizeof(Record))!=0)
+            {
+                Error="record damaged";
+            }
+            FlashTestAllowed[Record.Seq]=2;
+            Last=Record.Seq;
+        }
+        FlashLogAck();
+    }
+    for(Seq=0;Seq<FlashTestMaxSeq && Error==NULL;Seq++)
+    {
+        if(FlashTestRequired[Seq] && FlashTestAllowed[Seq]!=2)
+        {
+            Error="pending record lost";
+        }
+    }
+    if(Error==NULL && !After)
+    {
+        Error="next append lost";
+    }
+    Medium->Close();
+    if(Error!=NULL)
+    {
+        printf("%-8s %-19s FAIL cut after %d units: %s\n",Medium->Name,Name,(int)Units,Error);
+        return 1;
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestAppend
+ * Description        : Append a record while setting up, remembering its slot.
+ * INPUTS             : uint32_t Seq
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+static uint8_t FlashTestAppend(uint32_t Seq)
+{
+    Record_t Record;
+    uint32_t Next;
+    uint32_t Head;
+    uint32_t Tail;
+    uint32_t Index;
+    uint32_t PerPage=FlashTestBackend->PageSize/FlashLogSlotSize;
+    FlashLogGetPosition(&Next,&Head,&Tail);
+    FlashTestRecord(Seq,&Record);
+    if(!FlashLogAppend(&Record))
+    {
+        return 0;
+    }
+    //Entering a page drops the pending records it held
+    for(Index=0;Index<FlashTestPendingCount && (Head%PerPage)==0;)
+    {
+        if(FlashTestSlot[FlashTestPending[Index]]/PerPage==Head/PerPage)
+        {
+            memmove(&FlashTestPending[Index],&FlashTestPending[Index+1],
+                    (FlashTestPendingCount-Index-1)*sizeof(FlashTestPending[0]));
+            FlashTestPendingCount--;
+        }
+        else
+        {
+            Index++;
+        }
+    }
+    FlashTestSlot[Seq]=Head;
+    FlashTestLastSeq=Seq;
+    FlashTestPending[FlashTestPendingCount++]=Seq;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestAck
+ * Description        : Ack the oldest pending records while setting up.
+ * INPUTS             : uint32_t Count
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashTestAck(uint32_t Count)
+{
+    while(Count--!=0 && FlashTestPendingCount!=0)
+    {
+        FlashLogAck();
+        FlashTestPendingCount--;
+        memmove(FlashTestPending,&FlashTestPending[1],FlashTestPendingCount*sizeof(FlashTestPending[0]));
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestRecord
+ * Description        : The record of a seq, every field follows from it.
+ * INPUTS             : uint32_t Seq, Record_t *Record
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashTestRecord(uint32_t Seq,Record_t *Record)
+{
+    memset(Record,0,sizeof(*Record));
+    Record->Seq=Seq;
+    Record->Time=1700000000+Seq*5;
+    Record->Lat=30044420+(int32_t)Seq*7;
+    Record->Lon=-31235712-(int32_t)Seq*3;
+    Record->Speed=(uint16_t)(Seq%200);
+    Record->Course=(uint16_t)((Seq*2)%360);
+    Record->Flags=(uint8_t)(Seq&1);
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestSave
+ * Description        : Keep the image of the flash once a case is set up.
+ * INPUTS             : const FlashTestMedium_t *Medium
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashTestSave(const FlashTestMedium_t *Medium)
+{
+    FILE *File=fopen(FlashTestPath,"rb");
+    if(File!=NULL)
+    {
+        if(fread(FlashTestImage,1,Medium->Size,File)!=Medium->Size)
+        {
+            memset(FlashTestImage,0xFF,Medium->Size);
+        }
+        fclose(File);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestRestore
+ * Description        : Put the image of the flash back before the next cut.
+ * INPUTS             : const FlashTestMedium_t *Medium
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void FlashTestRestore(const FlashTestMedium_t *Medium)
+{
+    FILE *File=fopen(FlashTestPath,"wb");
+    if(File!=NULL)
+    {
+        fwrite(FlashTestImage,1,Medium->Size,File);
+        fclose(File);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestFileOpen
+ * Description        : The log on the internal flash stand-in.
+ * INPUTS             : void
+ * RETURNS            : const FlashLogBackend_t*
+ ***********************************************************************************************/
+static const FlashLogBackend_t *FlashTestFileOpen(void)
+{
+    return FlashLogFileOpen(FlashTestPath,FlashTestFileSize,FlashTestFilePage);
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestNorOpen
+ * Description        : The log on the whole SPI NOR stand-in.
+ * INPUTS             : void
+ * RETURNS            : const FlashLogBackend_t*
+ ***********************************************************************************************/
+static const FlashLogBackend_t *FlashTestNorOpen(void)
+{
+    const SpiNorBus_t *Bus=SpiNorFileOpen(FlashTestPath,FlashTestNorSize);
+    return (Bus!=NULL)?SpiNorInit(Bus):NULL;
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestNack
+ * Description        : Fail the upload of the newer of two queued reports until it runs out of
+ *                      retries: the queue must hand it to the flash log and let it go once it is
+ *                      stored, keep it while the log cannot take it, and keep the older report.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 0 when the case passed, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t FlashTestNack(void)
+{
+    Record_t Record;
+    uint32_t Older;
+    uint32_t Seq;
+    uint32_t Retry;
+    const char *Error=NULL;
+    remove(FlashTestPath);
+    FlashTestBackend=FlashTestFileOpen();
+    if(FlashTestBackend==NULL || !FlashLogInit(FlashTestBackend))
+    {
+        printf("%-8s %-19s FAIL set up\n","queue","nack to flash");
+        return 1;
+    }
+    ReportQueueInit();
+    ReportSetStoreCallBack(FlashTestStore);
+    Older=ReportQueuePush("3002.54321","3112.12345",50,90,0)->Seq;
+    Seq=ReportQueuePush("3002.54400","3112.12400",50,90,0)->Seq;
+    for(Retry=1;Retry<ReportMaxRetries;Retry++)
+    {
+        ReportQueueNack(Seq,0);
+    }
+    if(ReportQueueCount()!=2 || FlashLogCount()!=0)
+    {
+        Error="stored before its last retry";
+    }
+    //The log cannot take it while the power is cut, the report stays queued
+    FlashLogFileCutAfter(0);
+    ReportQueueNack(Seq,0);
+    FlashLogFileCutAfter(-1);
+    if(Error==NULL && (ReportQueueCount()!=2 || ReportGetStats()->Stored!=0))
+    {
+        Error="lost when the log failed";
+    }
+    ReportQueueNack(Seq,0);
+    if(Error==NULL && (ReportQueueCount()!=1 || ReportGetStats()->Stored!=1 || ReportGetStats()->Dropped!=0))
+    {
+        Error="not moved out of the queue";
+    }
+    if(Error==NULL && (ReportQueuePeek()->Seq!=Older || ReportQueuePeek()->Retries!=0))
+    {
+        Error="older report charged";
+    }
+    if(Error==NULL && (FlashLogCount()!=1 || !FlashLogPeek(&Record) || Record.Seq!=Seq))
+    {
+        Error="not in the flash log";
+    }
+    FlashLogFileClose();
+    printf("%-8s %-19s %s%s\n","queue","nack to flash",(Error!=NULL)?"FAIL ":"ok",(Error!=NULL)?Error:"");
+    return (Error!=NULL);
+}
+
+/***********************************************************************************************
+ * Function Name      : FlashTestStore
+ * Description        : Store of the reports out of retries, as GSMStoreReport (main.c) is.
+ * INPUTS             : const Report_t *Report
+ * RETURNS            : uint8_t 1 when stored
+ ***********************************************************************************************/
+static uint8_t FlashTestStore(const Report_t *Report)
+{
+    Record_t Record;
+    FlashTestRecord(Report->Seq,&Record);
+    return FlashLogAppend(&Record);
+}
+
+/*******************************************************************************
+ *                        Stand-ins of the clock and the kernel                *
+ *******************************************************************************/
+
+uint32_t TimeNow(void)
+{
+    return 0;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return 0;
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+#endif /* FlashLogHostBuild && SpiNorHostBuild */
@@ -0,0 +1,126 @@
+/******************************************************************************
+ * File Name: linkmon.c
+ *
+ * Description: Source file for the cellular link quality monitor. The signal
+ *              strength, network registration and GPRS attach state are
+ *              sampled periodically and turned into a score; transmissions are
+ *              deferred while the score is poor or a backoff is running after
+ *              failed attempts.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "linkmon.h"
+#include "SIM800.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static LinkQuality_t LinkQuality;
+/* Tick count before which no transmission is attempted */
+static TickType_t    LinkRetryTick=0;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : LinkMonitorSample
+ * Description        : Sample AT+CSQ, AT+CREG? and AT+CGATT? and update the link score. Must be
+ *                      called with the module taken (Sim800Take).
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t LinkMonitorSample(void)
+{
+    uint8_t Rssi,Registered,Attached;
+    if(Sim800GetSignalQuality(&Rssi)!=Gsmok || Sim800GetRegistration(&Registered)!=Gsmok
+            || Sim800GetAttach(&Attached)!=Gsmok)
+    {
+        //A module that does not answer is as good as no service
+        LinkQuality.Score=0;
+        return GsmError;
+    }
+    LinkQuality.Rssi=Rssi;
+    LinkQuality.Registered=Registered;
+    LinkQuality.Attached=Attached;
+    if(!Registered || !Attached || Rssi>31)
+    {
+        LinkQuality.Score=0;
+    }
+    else
+    {
+        LinkQuality.Score=(uint8_t)((Rssi*100)/31);
+    }
+    LinkQuality.Samples++;
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : LinkIsUsable
+ * Description        : Decide if a transmission is worth attempting now. Before the first sample
+ *                      the link is assumed usable. A refusal is counted as a deferred window.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 if the link may be used
+ ***********************************************************************************************/
+uint8_t LinkIsUsable(void)
+{
+    if(LinkQuality.Backoff!=0 && (int32_t)(xTaskGetTickCount()-LinkRetryTick)<0)
+    {
+        LinkQuality.Deferred++;
+        return 0;
+    }
+    if(LinkQuality.Samples!=0 && LinkQuality.Score<LinkMinScore)
+    {
+        LinkQuality.Deferred++;
+        return 0;
+    }
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : LinkReportResult
+ * Description        : Feed back the outcome of a transmission attempt. A failure starts or doubles
+ *                      the backoff, a success clears it.
+ * INPUTS             : uint32_t Result (Gsmok or GsmError)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void LinkReportResult(uint32_t Result)
+{
+    if(Result==Gsmok)
+    {
+        LinkQuality.Backoff=0;
+        return;
+    }
+    if(LinkQuality.Backoff==0)
+    {
+        LinkQuality.Backoff=LinkBackoffMin;
+    }
+    else if(LinkQuality.Backoff<LinkBackoffMax/2)
+    {
+        LinkQuality.Backoff*=2;
+    }
+    else
+    {
+        LinkQuality.Backoff=LinkBackoffMax;
+    }
+    LinkRetryTick=xTaskGetTickCount()+pdMS_TO_TICKS(LinkQuality.Backoff);
+}
+
+/***********************************************************************************************
+ * Function Name      : LinkGetQuality
+ * Description        : Last sampled state of the link.
+ * INPUTS             : void
+ * RETURNS            : const LinkQuality_t*
+ ***********************************************************************************************/
+const LinkQuality_t *LinkGetQuality(void)
+{
+    return &LinkQuality;
+}
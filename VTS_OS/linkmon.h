@@ -0,0 +1,51 @@
+/******************************************************************************
+ * File Name: linkmon.h
+ *
+ * Description: Header file for the cellular link quality monitor.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_LINKMON_H_
+#define SRC_LINKMON_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Period of the CSQ/CREG/CGATT sampling (ms) */
+#define LinkSamplePeriod    30000
+/* Lowest score that is worth a transmission attempt */
+#define LinkMinScore        30
+/* Wait after the first failed attempt (ms), doubled by every further failure */
+#define LinkBackoffMin      5000
+#define LinkBackoffMax      300000
+/* Samples in a row the module did not answer before it goes through Sim800Recover */
+#define LinkRecoverAfter    2
+
+typedef struct{
+    uint8_t  Rssi;           /* Last AT+CSQ rssi, 0..31 or 99 when not known */
+    uint8_t  Registered;     /* Registered to the home network or roaming */
+    uint8_t  Attached;       /* GPRS attached */
+    uint8_t  Score;          /* 0 (no service) to 100 (full signal) */
+    uint32_t Samples;        /* Successful samples since start up */
+    uint32_t Deferred;       /* Windows skipped because of a poor link or the backoff */
+    uint32_t Backoff;        /* Current wait after a failure (ms), 0 when the link works */
+}LinkQuality_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+uint32_t LinkMonitorSample(void);
+uint8_t LinkIsUsable(void);
+void LinkReportResult(uint32_t Result);
+const LinkQuality_t *LinkGetQuality(void);
+
+#endif /* SRC_LINKMON_H_ */
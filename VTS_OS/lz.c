@@ -0,0 +1,232 @@
+/******************************************************************************
+ * File Name: lz.c
+ *
+ * Description: Source file for a streaming LZSS compressor in the style of
+ *              heatshrink. The encoder only holds a window of LzWindowSize
+ *              bytes and the look ahead, whatever the length of the stream.
+ *              The output is a bit stream of tokens, most significant bit
+ *              first:
+ *
+ *              literal   : 1 | byte (8 bits)
+ *              reference : 0 | distance-1 (LzWindowBits) | length-LzMinMatch
+ *                          (LzLengthBits)
+ *
+ *              The last byte is padded with zero bits, fewer than a token.
+ *              No target dependency, the servers decompress with the same
+ *              file.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "lz.h"
+#include <string.h>
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static void LzEncodeStep(LzEncoder_t *Enc);
+static void LzPutBits(LzEncoder_t *Enc,uint32_t Value,uint8_t Count);
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : LzEncoderInit
+ * Description        : Start a new stream compressed into a buffer.
+ * INPUTS             : LzEncoder_t *Enc, uint8_t *Out, uint32_t OutSize
+ * RETURNS            : void
+ ***********************************************************************************************/
+void LzEncoderInit(LzEncoder_t *Enc,uint8_t *Out,uint32_t OutSize)
+{
+    Enc->Pos=0;
+    Enc->Fill=0;
+    Enc->Out=Out;
+    Enc->OutSize=OutSize;
+    Enc->OutLen=0;
+    Enc->Bits=0;
+    Enc->BitCount=0;
+    Enc->Overflow=0;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzEncoderPush
+ * Description        : Add bytes to the stream. Tokens are written as soon as a full look ahead is
+ *                      held, the rest waits for more bytes or LzEncoderFinish.
+ * INPUTS             : LzEncoder_t *Enc, const uint8_t *Data, uint32_t Size
+ * RETURNS            : uint8_t 1 while the output buffer did not overflow
+ ***********************************************************************************************/
+uint8_t LzEncoderPush(LzEncoder_t *Enc,const uint8_t *Data,uint32_t Size)
+{
+    uint16_t Shift;
+    while(Size!=0 && !Enc->Overflow)
+    {
+        if(Enc->Fill==sizeof(Enc->Buf))
+        {
+            // Drop what fell out of the window
+            Shift=Enc->Pos-LzWindowSize;
+            memmove(Enc->Buf,&Enc->Buf[Shift],Enc->Fill-Shift);
+            Enc->Pos-=Shift;
+            Enc->Fill-=Shift;
+        }
+        Enc->Buf[Enc->Fill++]=*Data++;
+        Size--;
+        if(Enc->Fill-Enc->Pos==LzLookahead)
+        {
+            LzEncodeStep(Enc);
+        }
+    }
+    return !Enc->Overflow;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzEncoderFinish
+ * Description        : Encode the bytes still held and pad the last output byte.
+ * INPUTS             : LzEncoder_t *Enc
+ * RETURNS            : uint32_t compressed size, 0 if the output buffer was too small
+ ***********************************************************************************************/
+uint32_t LzEncoderFinish(LzEncoder_t *Enc)
+{
+    while(Enc->Pos<Enc->Fill && !Enc->Overflow)
+    {
+        LzEncodeStep(Enc);
+    }
+    if(Enc->BitCount!=0)
+    {
+        LzPutBits(Enc,0,8-Enc->BitCount);
+    }
+    return Enc->Overflow?0:Enc->OutLen;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzDecode
+ * Description        : Decompress a whole stream. The output is the window of the references.
+ * INPUTS             : const uint8_t *In, uint32_t InSize, uint8_t *Out, uint32_t OutSize
+ * RETURNS            : uint32_t decompressed size, 0 for a malformed stream or a too small Out
+ ***********************************************************************************************/
+uint32_t LzDecode(const uint8_t *In,uint32_t InSize,uint8_t *Out,uint32_t OutSize)
+{
+    uint32_t Bit=0;
+    uint32_t Bits=InSize*8;
+    uint32_t Len=0;
+    uint32_t Value,Distance,Count;
+    uint8_t Literal,Width;
+    // A padding shorter than the shortest token ends the stream
+    while(Bits-Bit>=9)
+    {
+        Literal=(In[Bit>>3]>>(7-(Bit&7)))&1;
+        Bit++;
+        Width=Literal?8:(LzWindowBits+LzLengthBits);
+        if(Bits-Bit<Width)
+        {
+            break;
+        }
+        for(Value=0;Width!=0;Width--,Bit++)
+        {
+            Value=(Value<<1)|((In[Bit>>3]>>(7-(Bit&7)))&1);
+        }
+        if(Literal)
+        {
+            if(Len==OutSize)
+            {
+                return 0;
+            }
+            Out[Len++]=(uint8_t)Value;
+            continue;
+        }
+        Distance=(Value>>LzLengthBits)+1;
+        Count=(Value&((1<<LzLengthBits)-1))+LzMinMatch;
+        if(Distance>Len || Len+Count>OutSize)
+        {
+            return 0;
+        }
+        // Byte by byte, a reference may overlap the bytes it produces
+        while(Count!=0)
+        {
+            Out[Len]=Out[Len-Distance];
+            Len++;
+            Count--;
+        }
+    }
+    return Len;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzEncodeStep
+ * Description        : Write the token of the bytes at Pos, the longest match in the window or a
+ *                      literal. A match may run into the look ahead.
+ * INPUTS             : LzEncoder_t *Enc
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void LzEncodeStep(LzEncoder_t *Enc)
+{
+    const uint8_t *Ahead=&Enc->Buf[Enc->Pos];
+    uint16_t Limit=Enc->Fill-Enc->Pos;
+    uint16_t Start=(Enc->Pos>LzWindowSize)?(Enc->Pos-LzWindowSize):0;
+    uint16_t Best=0;
+    uint16_t BestStart=0;
+    uint16_t Cand,Count;
+    if(Limit>LzLookahead)
+    {
+        Limit=LzLookahead;
+    }
+    // Nearest candidates first, an equal match keeps the shorter distance
+    for(Cand=Enc->Pos;Cand-->Start && Best<Limit;)
+    {
+        if(Enc->Buf[Cand]!=Ahead[0])
+        {
+            continue;
+        }
+        for(Count=1;Count<Limit && Enc->Buf[Cand+Count]==Ahead[Count];Count++)
+        {
+        }
+        if(Count>Best)
+        {
+            Best=Count;
+            BestStart=Cand;
+        }
+    }
+    if(Best>=LzMinMatch)
+    {
+        LzPutBits(Enc,0,1);
+        LzPutBits(Enc,Enc->Pos-BestStart-1,LzWindowBits);
+        LzPutBits(Enc,Best-LzMinMatch,LzLengthBits);
+        Enc->Pos+=Best;
+    }
+    else
+    {
+        LzPutBits(Enc,0x100|Ahead[0],9);
+        Enc->Pos++;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : LzPutBits
+ * Description        : Append the low Count bits of a value to the output, most significant first.
+ * INPUTS             : LzEncoder_t *Enc, uint32_t Value, uint8_t Count
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void LzPutBits(LzEncoder_t *Enc,uint32_t Value,uint8_t Count)
+{
+    while(Count!=0)
+    {
+        Count--;
+        Enc->Bits|=(uint8_t)(((Value>>Count)&1)<<(7-Enc->BitCount));
+        if(++Enc->BitCount==8)
+        {
+            if(Enc->OutLen==Enc->OutSize)
+            {
+                Enc->Overflow=1;
+                return;
+            }
+            Enc->Out[Enc->OutLen++]=Enc->Bits;
+            Enc->Bits=0;
+            Enc->BitCount=0;
+        }
+    }
+}
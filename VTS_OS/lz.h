@@ -0,0 +1,50 @@
+/******************************************************************************
+ * File Name: lz.h
+ *
+ * Description: Header file for the fixed memory LZSS compressor.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_LZ_H_
+#define SRC_LZ_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Window of 2^LzWindowBits bytes the matches are searched in */
+#define LzWindowBits        8
+#define LzWindowSize        (1<<LzWindowBits)
+/* Match lengths LzMinMatch .. LzMinMatch+2^LzLengthBits-1 */
+#define LzLengthBits        4
+#define LzMinMatch          2
+#define LzLookahead         ((1<<LzLengthBits)+LzMinMatch-1)
+
+typedef struct{
+    uint8_t   Buf[LzWindowSize+LzLookahead];  /* Window then the bytes not encoded yet */
+    uint16_t  Pos;           /* First byte not encoded yet */
+    uint16_t  Fill;          /* Bytes held in Buf */
+    uint8_t  *Out;
+    uint32_t  OutSize;
+    uint32_t  OutLen;
+    uint8_t   Bits;          /* Bits waiting for a full output byte, from the top */
+    uint8_t   BitCount;
+    uint8_t   Overflow;      /* Set once Out was too small */
+}LzEncoder_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+void LzEncoderInit(LzEncoder_t *Enc,uint8_t *Out,uint32_t OutSize);
+uint8_t LzEncoderPush(LzEncoder_t *Enc,const uint8_t *Data,uint32_t Size);
+uint32_t LzEncoderFinish(LzEncoder_t *Enc);
+uint32_t LzDecode(const uint8_t *In,uint32_t InSize,uint8_t *Out,uint32_t OutSize);
+
+#endif /* SRC_LZ_H_ */
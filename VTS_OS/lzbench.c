@@ -0,0 +1,372 @@
+/******************************************************************************
+ * File Name: lzbench.c
+ *
+ * Description: Host benchmark of the LZSS compressor on tracks. Each drive
+ *              given as a CSV file of "unix_time,lat_deg,lon_deg,speed_kmh,
+ *              course_deg" lines, or the drives of trackbench.c made up when
+ *              no file is given, is written in the forms the firmware sends or
+ *              stores: the "seq,lat,lon" lines of a batch upload, the compact
+ *              record batches and the track blocks. Every unit is compressed
+ *              on its own, as it would be on the target, and decoded back. It
+ *              prints the bytes per fix before and after, the ratio and the
+ *              cycles per input byte of the encoder and the decoder. Builds with
+ *              LzHostBuild defined only, with lz.c, track.c, record.c and
+ *              crc32.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(LzHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "lz.h"
+#include "track.h"
+#include "transport.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LzBenchCycles()     __rdtsc()
+#else
+#include <time.h>
+#define LzBenchCycles()     ((uint64_t)clock())
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define LzBenchMaxFixes     100000
+/* Units are compressed this many times to time them */
+#define LzBenchRepeat       4
+/* Micro degrees of latitude per meter */
+#define LzBenchPerMeter     8.983
+#define LzBenchPi           3.14159265358979
+/* Room for a unit that does not shrink: 9 bits a byte */
+#define LzBenchUnitSize     TrackBlockSize
+#define LzBenchPackedSize   (LzBenchUnitSize*9/8+2)
+
+typedef enum{
+    LzBenchBody,             /* Text of a batch upload, ReportBatchSize fixes */
+    LzBenchRecords,          /* Compact record batch, ReportBatchSize fixes */
+    LzBenchTrack,            /* Track block, one flash page */
+    LzBenchForms
+}LzBenchForm_t;
+
+typedef struct{
+    uint32_t Units;
+    uint32_t Raw;            /* Bytes before compression */
+    uint32_t Packed;         /* Bytes after compression */
+    uint64_t EncodeCycles;
+    uint64_t DecodeCycles;
+}LzBenchResult_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t LzBenchLoad(const char *Path,Record_t *Fixes,uint32_t Max);
+static uint32_t LzBenchDrive(Record_t *Fixes,uint32_t Count,uint32_t Period,uint32_t MaxSpeed,uint8_t Parked);
+static uint8_t LzBenchRun(const char *Name,const Record_t *Fixes,uint32_t Count);
+static uint32_t LzBenchUnit(LzBenchForm_t Form,const Record_t *Fixes,uint32_t Count,uint32_t *Used,uint8_t *Unit);
+static uint32_t LzBenchCoordinate(int32_t MicroDegrees,char *Coordinate);
+static uint8_t LzBenchCompress(const uint8_t *Unit,uint32_t Size,LzBenchResult_t *Result);
+static uint32_t LzBenchRandom(void);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static const char *const LzBenchFormNames[LzBenchForms]={"batch body","record batch","track block"};
+static Record_t LzBenchFixes[LzBenchMaxFixes];
+static uint32_t LzBenchSeed=12345;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Benchmark the drives given on the command line, or the made up ones.
+ * INPUTS             : int argc, char *argv[] (CSV files)
+ * RETURNS            : int 0, 1 if a unit did not decode back
+ ***********************************************************************************************/
+int main(int argc,char *argv[])
+{
+    uint32_t Count;
+    uint8_t  Failed=0;
+    int Index;
+    printf("%-16s %-13s %6s %8s %8s %6s %8s %8s\n",
+           "drive","form","units","raw B/fx","lz B/fx","ratio","enc c/B","dec c/B");
+    if(argc<2)
+    {
+        Count=LzBenchDrive(LzBenchFixes,10080,60,0,1);
+        Failed|=LzBenchRun("parked 7d@60s",LzBenchFixes,Count);
+        Count=LzBenchDrive(LzBenchFixes,8640,5,50,0);
+        Failed|=LzBenchRun("city 12h@5s",LzBenchFixes,Count);
+        Count=LzBenchDrive(LzBenchFixes,86400,1,120,0);
+        Failed|=LzBenchRun("highway 24h@1s",LzBenchFixes,Count);
+        Count=LzBenchDrive(LzBenchFixes,1440,60,120,0);
+        Failed|=LzBenchRun("highway 24h@60s",LzBenchFixes,Count);
+    }
+    for(Index=1;Index<argc;Index++)
+    {
+        Count=LzBenchLoad(argv[Index],LzBenchFixes,LzBenchMaxFixes);
+        Failed|=LzBenchRun(argv[Index],LzBenchFixes,Count);
+    }
+    printf("%s\n",Failed?"FAILED":"all passed");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzBenchLoad
+ * Description        : Read a drive from a CSV file, lines that do not parse are skipped.
+ * INPUTS             : const char *Path, Record_t *Fixes, uint32_t Max
+ * RETURNS            : uint32_t number of fixes read
+ ***********************************************************************************************/
+static uint32_t LzBenchLoad(const char *Path,Record_t *Fixes,uint32_t Max)
+{
+    FILE *File=fopen(Path,"r");
+    char Line[160];
+    unsigned long Time;
+    double Lat,Lon,Speed,Course;
+    uint32_t Count=0;
+    if(File==NULL)
+    {
+        fprintf(stderr,"cannot open %s\n",Path);
+        return 0;
+    }
+    while(Count<Max && fgets(Line,sizeof(Line),File)!=NULL)
+    {
+        if(sscanf(Line,"%lu,%lf,%lf,%lf,%lf",&Time,&Lat,&Lon,&Speed,&Course)!=5)
+        {
+            continue;
+        }
+        Fixes[Count].Seq=Count+1;
+        Fixes[Count].Time=(uint32_t)Time;
+        Fixes[Count].Lat=(int32_t)lround(Lat*1e6);
+        Fixes[Count].Lon=(int32_t)lround(Lon*1e6);
+        Fixes[Count].Speed=(uint16_t)lround(Speed);
+        Fixes[Count].Course=(uint16_t)lround(Course);
+        Fixes[Count].Flags=0;
+        Count++;
+    }
+    fclose(File);
+    return Count;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzBenchDrive
+ * Description        : Make up the drive TrackBenchDrive (trackbench.c) makes with the same seed:
+ *                      the vehicle speeds up and slows down, stops now and then and turns at
+ *                      random, and the GPS adds a few meters of noise. A parked drive only has
+ *                      the noise.
+ * INPUTS             : Record_t *Fixes, uint32_t Count, uint32_t Period (s), uint32_t MaxSpeed
+ *                      (km/h), uint8_t Parked
+ * RETURNS            : uint32_t Count
+ ***********************************************************************************************/
+static uint32_t LzBenchDrive(Record_t *Fixes,uint32_t Count,uint32_t Period,uint32_t MaxSpeed,uint8_t Parked)
+{
+    double Lat=30.044420;
+    double Lon=31.235712;
+    double Speed=0;
+    double Course=90;
+    double Meters;
+    uint32_t Stop=0;
+    uint32_t Index;
+    for(Index=0;Index<Count;Index++)
+    {
+        if(!Parked)
+        {
+            if(Stop!=0)
+            {
+                Stop--;
+                Speed=0;
+            }
+            else if(LzBenchRandom()%200==0)
+            {
+                Stop=30+LzBenchRandom()%60;
+            }
+            else
+            {
+                Speed+=(double)(LzBenchRandom()%11)-5;
+                Speed=(Speed<0)?0:(Speed>MaxSpeed)?MaxSpeed:Speed;
+                Course+=(LzBenchRandom()%50==0)?90.0:((double)(LzBenchRandom()%5)-2)*0.5;
+                Course=fmod(Course+360,360);
+            }
+            Meters=Speed/3.6*Period;
+            Lat+=Meters*cos(Course*LzBenchPi/180)*LzBenchPerMeter/1e6;
+            Lon+=Meters*sin(Course*LzBenchPi/180)*LzBenchPerMeter/cos(Lat*LzBenchPi/180)/1e6;
+        }
+        Fixes[Index].Seq=Index+1;
+        Fixes[Index].Time=1700000000+Index*Period;
+        Fixes[Index].Lat=(int32_t)lround(Lat*1e6)+(int32_t)(LzBenchRandom()%61)-30;
+        Fixes[Index].Lon=(int32_t)lround(Lon*1e6)+(int32_t)(LzBenchRandom()%61)-30;
+        Fixes[Index].Speed=(uint16_t)lround(Speed);
+        Fixes[Index].Course=(uint16_t)lround(Course)%360;
+        Fixes[Index].Flags=0;
+    }
+    return Count;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzBenchRun
+ * Description        : Write a drive in every form, compress each unit on its own, decode it back
+ *                      and print the figures of each form.
+ * INPUTS             : const char *Name, const Record_t *Fixes, uint32_t Count
+ * RETURNS            : uint8_t 0 when every unit decoded back, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t LzBenchRun(const char *Name,const Record_t *Fixes,uint32_t Count)
+{
+    static uint8_t Unit[LzBenchUnitSize];
+    LzBenchResult_t Result;
+    LzBenchForm_t Form;
+    uint32_t Index;
+    uint32_t Used;
+    uint32_t Size;
+    if(Count==0)
+    {
+        return 0;
+    }
+    for(Form=LzBenchBody;Form<LzBenchForms;Form++)
+    {
+        memset(&Result,0,sizeof(Result));
+        for(Index=0;Index<Count;Index+=Used)
+        {
+            Size=LzBenchUnit(Form,&Fixes[Index],Count-Index,&Used,Unit);
+            if(Used==0 || LzBenchCompress(Unit,Size,&Result))
+            {
+                printf("%-16s %-13s FAIL unit at fix %u\n",Name,LzBenchFormNames[Form],(unsigned)Index);
+                return 1;
+            }
+        }
+        printf("%-16s %-13s %6u %8.2f %8.2f %6.2f %8.0f %8.0f\n",Name,LzBenchFormNames[Form],
+               (unsigned)Result.Units,(double)Result.Raw/Count,(double)Result.Packed/Count,
+               (double)Result.Raw/Result.Packed,(double)Result.EncodeCycles/LzBenchRepeat/Result.Raw,
+               (double)Result.DecodeCycles/LzBenchRepeat/Result.Raw);
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzBenchUnit
+ * Description        : Write the next unit of a form from the fixes: the body of a batch upload
+ *                      as HttpBatchTransport builds it, a record batch as RecordTcpTransport
+ *                      sends it, or a track block.
+ * INPUTS             : LzBenchForm_t Form, const Record_t *Fixes, uint32_t Count (fixes left),
+ *                      uint32_t *Used (out: fixes in the unit), uint8_t *Unit (LzBenchUnitSize)
+ * RETURNS            : uint32_t size of the unit
+ ***********************************************************************************************/
+static uint32_t LzBenchUnit(LzBenchForm_t Form,const Record_t *Fixes,uint32_t Count,uint32_t *Used,uint8_t *Unit)
+{
+    RecordEncoder_t Records;
+    TrackEncoder_t Track;
+    char     Line[40];
+    uint32_t Size=0;
+    uint32_t Len;
+    uint32_t Index=0;
+    switch(Form)
+    {
+    case LzBenchBody:
+        for(;Index<Count && Index<ReportBatchSize;Index++)
+        {
+            Len=snprintf(Line,sizeof(Line),"%u,",(unsigned)Fixes[Index].Seq);
+            Len+=LzBenchCoordinate(Fixes[Index].Lat,&Line[Len]);
+            Line[Len++]=',';
+            Len+=LzBenchCoordinate(Fixes[Index].Lon,&Line[Len]);
+            Line[Len++]='\n';
+            if(Size+Len>TransportBatchBodySize)
+            {
+                break;
+            }
+            memcpy(&Unit[Size],Line,Len);
+            Size+=Len;
+        }
+        break;
+    case LzBenchRecords:
+        RecordEncoderInit(&Records,Unit,TransportRecordBatchSize);
+        while(Index<Count && Index<ReportBatchSize && RecordEncode(&Records,&Fixes[Index]))
+        {
+            Index++;
+        }
+        Size=Records.Len;
+        break;
+    default:
+        TrackEncoderInit(&Track,Unit,TrackSpeedStep,TrackHeadingStep);
+        while(Index<Count && TrackEncode(&Track,&Fixes[Index]))
+        {
+            Index++;
+        }
+        Size=TrackEncoderFinish(&Track);
+        break;
+    }
+    *Used=Index;
+    return Size;
+}
+
+/***********************************************************************************************
+ * Function Name      : LzBenchCoordinate
+ * Description        : Write a coordinate the way GPSFromMicroDegrees (HAL/gps.c) does, NMEA
+ *                      ddmm.mmmm with a leading '-' for the southern or western hemisphere.
+ * INPUTS             : int32_t MicroDegrees, char *Coordinate
+ * RETURNS            : uint32_t characters written
+ ***********************************************************************************************/
+static uint32_t LzBenchCoordinate(int32_t MicroDegrees,char *Coordinate)
+{
+    uint32_t Value=(MicroDegrees<0)?(uint32_t)(-MicroDegrees):(uint32_t)MicroDegrees;
+    uint32_t Minutes=((Value%1000000)*6)/10;
+    return (uint32_t)sprintf(Coordinate,"%s%u%02u.%04u",(MicroDegrees<0)?"-":"",(unsigned)(Value/1000000),
+                             (unsigned)(Minutes/10000),(unsigned)(Minutes%10000));
+}
+
+/***********************************************************************************************
+ * Function Name      : LzBenchCompress
+ * Description        : Compress a unit, time the encoder and the decoder and check the round trip.
+ * INPUTS             : const uint8_t *Unit, uint32_t Size, LzBenchResult_t *Result
+ * RETURNS            : uint8_t 0 when the unit decoded back, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t LzBenchCompress(const uint8_t *Unit,uint32_t Size,LzBenchResult_t *Result)
+{
+    static LzEncoder_t Enc;
+    static uint8_t Packed[LzBenchPackedSize];
+    static uint8_t Decoded[LzBenchUnitSize];
+    uint32_t PackedSize=0;
+    uint32_t DecodedSize=0;
+    uint64_t Start;
+    uint32_t Repeat;
+    Start=LzBenchCycles();
+    for(Repeat=0;Repeat<LzBenchRepeat;Repeat++)
+    {
+        LzEncoderInit(&Enc,Packed,sizeof(Packed));
+        LzEncoderPush(&Enc,Unit,Size);
+        PackedSize=LzEncoderFinish(&Enc);
+    }
+    Result->EncodeCycles+=LzBenchCycles()-Start;
+    Start=LzBenchCycles();
+    for(Repeat=0;Repeat<LzBenchRepeat;Repeat++)
+    {
+        DecodedSize=LzDecode(Packed,PackedSize,Decoded,sizeof(Decoded));
+    }
+    Result->DecodeCycles+=LzBenchCycles()-Start;
+    Result->Units++;
+    Result->Raw+=Size;
+    Result->Packed+=PackedSize;
+    return (PackedSize==0 || DecodedSize!=Size || memcmp(Decoded,Unit,Size)!=0);
+}
+
+/***********************************************************************************************
+ * Function Name      : LzBenchRandom
+ * Description        : Repeatable pseudo random numbers, the same drives on every host.
+ * INPUTS             : void
+ * RETURNS            : uint32_t 0 to 32767
+ ***********************************************************************************************/
+static uint32_t LzBenchRandom(void)
+{
+    LzBenchSeed=LzBenchSeed*1103515245+12345;
+    return (LzBenchSeed>>16)&0x7FFF;
+}
+
+#endif /* LzHostBuild */
@@ -36,6 +36,15 @@
 #include "stdint.h"
 #include "HAL/gps.h"
 #include "SIM800.h"
+#include "report.h"
+#include "transport.h"
+#include "linkmon.h"
+#include "timesvc.h"
+#include "flashlog.h"
+#include "HAL/spinor_hw.h"
+#include "meta.h"
+#include "drain.h"
+#include "mqtt.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "timers.h"
@@ -51,6 +60,12 @@
 #define  GPS_Priorities     (1)
 #define  GPSRead_Priority   (2)
 #define  GSM_Priorities     (3)
+/*Task stacks in words. The GSM tasks run the transport and SIM800 call chains, the deepest being
+  DrainRun > MQTT connect > Sim800SocketSend > Sim800Await at about 880 bytes in a -fstack-usage
+  build, plus the FPU exception frame. GSMStackFree keeps their high water marks to check them*/
+#define  GPS_StackSize      (100)
+#define  GSM_StackSize      (256)
+#define  Link_StackSize     (224)
 
 /*Synchronization Flags*/
 #define GPS_RecFlag     (1<<0)
@@ -67,25 +82,20 @@
  *                               Global_Variables Declaration                  *
  *******************************************************************************/
 uint8_t RecieveBuffer[Trans_SIZE];
-extern uint8_t buffer2[Sim800BufSize];
 
 /*Variables to store TIME,SPEED, COURSE OVER GROUND*/
 float Time, Speed, currentCOG;
+/*Date of the last GPRMC as ddmmyy*/
+uint32_t Date;
 UTurn_Status CMovementStatus=STRAIGHT_LINE;
 UTurn_Status PMovementStatus=STRAIGHT_LINE;
 char State;
 
 /* Buffers to store the Langitude and Latitude */
-char Longitude[12]="31.202", Latitude[12]="31";
+char Longitude[GPSCoordinateSize]="31.202", Latitude[GPSCoordinateSize]="31";
 
-/*Commands for GSMCheckConnection and GSMSendSequence */
-extern uint8_t     InitHTTP[14];
-extern uint8_t     EnableHTTPS[15];
-extern uint8_t     SetCIDPAR[22];
-extern uint8_t     HTTPRequest[136];
-extern uint8_t     TERMINATEHTTP[14];
-char     RQSTLink[200];
-uint8_t* Commands[4]={SetCIDPAR,(uint8_t*)RQSTLink,HTTPRequest,TERMINATEHTTP};
+/*Transport used by GSMCheckConnection and GSMSendSequence */
+const Transport_t *GSMTransport=&TransportDefault;
 
 /*Create Task Handles Create */
 xTaskHandle GPSParseHand = NULL;
@@ -94,6 +104,9 @@ xTaskHandle GPSProcessDataHand = NULL;
 xTaskHandle SetTimerRateHand = NULL;
 xTaskHandle GSMCheckConnectionHand = NULL;
 xTaskHandle GSMSendSequenceHand = NULL;
+xTaskHandle GSMLinkMonitorHand = NULL;
+/*Fewest free stack words seen of CheckConnection, SendSequence and LinkMonitor*/
+UBaseType_t GSMStackFree[3];
 
 /* Declare a variable to hold the created event group. */
 EventGroupHandle_t FlagsEventGroup;
@@ -119,11 +132,23 @@ void SetTimerRate( void* pvParamter);
 void GSMCheckConnection(void* pvParamter);
 /* Function to Send a Sequence of Commands To GSM Module */
 void GSMSendSequence(void* pvParamter);
+/* Sample the quality of the cellular link in the background */
+void GSMLinkMonitor(void* pvParamter);
+/* Send the pending reports by SMS while GPRS is not available */
+static void GSMSendFallback(void);
+/* Move the pending reports to the flash log while no link is available */
+static void GSMStoreReports(void);
+/* Write one report to the flash log */
+static uint8_t GSMStoreReport(const Report_t *Report);
+/* Save the hot metadata to the EEPROM */
+static void GSMSaveMeta(void);
 
 
 /*GSMTimer Callback*/
 void GSMTimerCallback( TimerHandle_t GSMTimer )
 {
+    /* Start waking the module now, the latency elapses while the report is being queued */
+    Sim800WakeUp();
     xEventGroupSetBits( FlagsEventGroup,  TimerFlag );
 }
 /* GPSSetFlag CallBack */
@@ -136,22 +161,45 @@ void sim800recieve(void)
 {
     xEventGroupSetBitsFromISR( FlagsEventGroup,  GSM_RecFlag ,pdFALSE);
 }
+/* Stack overflow hook, halt like configASSERT so the debugger shows the task */
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+    taskDISABLE_INTERRUPTS();
+    for(;;);
+}
 
 /*******************************************************************************
  *                               Main                                          *
  *******************************************************************************/
 int main(void)
 {
+    const FlashLogBackend_t *LogBackend;
     //Create FreeRTOS Tasks
-    xTaskCreate(GPSParse,"GPSParse",100,NULL,GPS_Priorities,&GPSParseHand);
-    xTaskCreate(GPSRead,"GPSIssueRead",100,NULL,GPSRead_Priority,&GPSReadHand);
-    xTaskCreate(GPSProcessData,"GPSProcess",100,NULL,GPS_Priorities,&GPSProcessDataHand);
-    xTaskCreate(SetTimerRate,"SetTimerPeriod",100,NULL,GPS_Priorities,&SetTimerRateHand);
-    xTaskCreate(GSMCheckConnection,"CheckConnection",100,NULL,GPS_Priorities,&GSMCheckConnectionHand);
-    xTaskCreate(GSMSendSequence,"SendSequence",100,NULL,GSM_Priorities,&GSMSendSequenceHand);
+    xTaskCreate(GPSParse,"GPSParse",GPS_StackSize,NULL,GPS_Priorities,&GPSParseHand);
+    xTaskCreate(GPSRead,"GPSIssueRead",GPS_StackSize,NULL,GPSRead_Priority,&GPSReadHand);
+    xTaskCreate(GPSProcessData,"GPSProcess",GPS_StackSize,NULL,GPS_Priorities,&GPSProcessDataHand);
+    xTaskCreate(SetTimerRate,"SetTimerPeriod",GPS_StackSize,NULL,GPS_Priorities,&SetTimerRateHand);
+    xTaskCreate(GSMCheckConnection,"CheckConnection",GSM_StackSize,NULL,GPS_Priorities,&GSMCheckConnectionHand);
+    xTaskCreate(GSMSendSequence,"SendSequence",GSM_StackSize,NULL,GSM_Priorities,&GSMSendSequenceHand);
+    xTaskCreate(GSMLinkMonitor,"LinkMonitor",Link_StackSize,NULL,GPS_Priorities,&GSMLinkMonitorHand);
     /*Create Semaphore for the Data and Movement Variables */
     vSemaphoreCreateBinary(DataSemaphore);
     vSemaphoreCreateBinary(MovementSemaphore);
+    /*Start with an empty queue of pending reports*/
+    ReportQueueInit();
+    /*Mount the log of the reports kept in flash across power losses, on the external SPI NOR flash when one answers*/
+    LogBackend=SpiNorInit(&SpiNorSsi);
+    FlashLogInit((LogBackend!=NULL)?LogBackend:&FlashLogInternal);
+    /*Reports that run out of retries are kept in the flash log too*/
+    ReportSetStoreCallBack(GSMStoreReport);
+    /*Continue the sequence numbers and start from the last fix of the previous run*/
+    if(MetaInit(&MetaEeprom)){
+        ReportSetNextSeq(MetaGet()->ReportSeq);
+        if(MetaGet()->FixTime!=0){
+            GPSFromMicroDegrees(MetaGet()->FixLon,Longitude);
+            GPSFromMicroDegrees(MetaGet()->FixLat,Latitude);
+        }
+    }
     /* Attempt to create the event group. */
     FlagsEventGroup = xEventGroupCreate();
     GSMTimer = xTimerCreate("GSMTimer",pdMS_TO_TICKS( 30000 ),
@@ -165,6 +213,8 @@ int main(void)
     GPSSetReceptionCallBack(GPSSetFlag);
     GSMInit();
     GSMSetReceptionCallBack(sim800recieve);
+    /*Take up the range requests the server sends on the MQTT downlink*/
+    MqttSetMessageCallBack(DrainDownlink);
     /* Set the Interrupts  to be less than the FreeRTOS ISRs priorities*/
     IntPrioritySet(INT_UART2, 0xE0);
     IntPrioritySet(INT_UART1, 0xE0);
@@ -197,7 +247,7 @@ void GPSParse( void* pvParamter){
         {
             //Ensure Atomic Access to the Parsed Data Variables
             if(xSemaphoreTake(DataSemaphore,portMAX_DELAY)){
-            GPSParseRawData((char*)RecieveBuffer, &Time, Longitude, Latitude, &Speed, &currentCOG,&State);
+            GPSParseRawData((char*)RecieveBuffer, &Time, &Date, Longitude, Latitude, &Speed, &currentCOG,&State);
             }
             xSemaphoreGive(DataSemaphore);
             xEventGroupSetBits( FlagsEventGroup,  GPS_ParseFlag );
@@ -239,6 +289,7 @@ void GPSRead( void* pvParamter){/*Higher Periority Process*/
  ***********************************************************************************************/
 void GPSProcessData( void* pvParamter){
     EventBits_t uxBits;
+    TickType_t LastFixTick=0;
     while(1){
         uxBits = xEventGroupWaitBits( FlagsEventGroup, GPS_NewReadIssued,  pdTRUE, pdTRUE, timeoutvalue );
         //Clear Flag on return
@@ -246,9 +297,18 @@ void GPSProcessData( void* pvParamter){
         {
             //Ensure Atomic Access to the Parsed Data Variables
             if(xSemaphoreTake(DataSemaphore,portMAX_DELAY)){
+                //Only a valid fix disciplines the clock
+                if(State=='A'){
+                    TimeSetFromGps(Time, Date);
+                    //Keep the odometer and the last good fix for the next run
+                    if(LastFixTick!=0){
+                        MetaAddDistance((uint16_t)Speed, (xTaskGetTickCount()-LastFixTick)*portTICK_PERIOD_MS);
+                    }
+                    LastFixTick=xTaskGetTickCount();
+                    MetaSetFix(GPSToMicroDegrees(Latitude), GPSToMicroDegrees(Longitude), TimeNow());
+                }
                 if(State=='A' || State=='V' ){
                 //if(State=='V' ){ //That is how it should be
-                    Sim800PrepareLink(RQSTLink,Longitude, Latitude);
                     //Ensure Atomic Access to the movement Variable
                     if(xSemaphoreTake(MovementSemaphore,portMAX_DELAY)){
                         CMovementStatus=GPSDetectUTurn(currentCOG,Speed);
@@ -314,53 +374,64 @@ void SetTimerRate( void* pvParamter){
 }
 /***********************************************************************************************
  * Function Name      : GSMCheckConnection
- * Description        : Check GSM Connection before sending the Data
+ * Description        : Queue a report of the current position and check GSM Connection before
+ *                      sending the Data
  * INPUTS             : void* pvParameter
  * RETURNS            : void
  ***********************************************************************************************/
 void GSMCheckConnection(void* pvParamter){
     EventBits_t uxBits;
+    //Sequence number after the newest queued report, to be covered by the metadata store
+    uint32_t NextSeq=0;
     while(1){
         uxBits = xEventGroupWaitBits( FlagsEventGroup, GPS_ValidFlag|TimerFlag,  pdTRUE, pdTRUE, timeoutvalue );
         //Wait and Clear both Flags on return
         if( ( uxBits & ( GPS_ValidFlag|TimerFlag) ) == ( GPS_ValidFlag|TimerFlag) )
         {
-            uint8_t check_cnt=0;
-            while(check_cnt<5){
-                char *P={0};
-                char *err={0};
-                uint32_t reslen=5;
-                uint32_t comlen=strlen((const char*)EnableHTTPS);
-                //The Response buffer is supposed to the size of the transmitted data + received data +20 margin error
-                reslen+=20+comlen;
-                GSMReceiveResponse(buffer2, reslen);
-                GSMSend((uint8_t *)EnableHTTPS,comlen);
-                P=strstr((const char*)buffer2,"OK");
-                while(*P!='O')
-                {
-                    P=strstr((const char*)buffer2,"OK");
-                    err=strstr((const char*)buffer2,"ERROR");
-                    if(*err=='E')
-                    {
-                        //Reset buffer to recieve new info
-                        memset(buffer2,'\0',reslen);
-                        break;
-                    }
-                }
-                if(*P=='O')
-                {
-                    xEventGroupSetBits( FlagsEventGroup,  GSM_ConFlag );
-                    //Reset buffer to recieve new info
-                    memset(buffer2,'\0',reslen);
-                    break;
-                }else{
-                    //Reset buffer to recieve new info
-                    memset(buffer2,'\0',reslen);
-                    check_cnt++;
+            uint32_t Result;
+            uint8_t Priority=0;
+            Report_t *Report;
+            //Reports taken while turning are sent without waiting for a full batch
+            if(xSemaphoreTake(MovementSemaphore,portMAX_DELAY)){
+                Priority=(CMovementStatus!=STRAIGHT_LINE);
+            }
+            xSemaphoreGive(MovementSemaphore);
+            //Give the fix of this window a sequence number, it stays queued until delivered
+            if(xSemaphoreTake(DataSemaphore,portMAX_DELAY)){
+                //NULL when the queue is full while an upload runs, the fix is dropped
+                Report=ReportQueuePush(Longitude, Latitude, (uint16_t)Speed, (uint16_t)currentCOG, Priority);
+                if(Report!=NULL){
+                    NextSeq=Report->Seq+1;
                 }
             }
-            if(check_cnt==5){
-                //Send to EEPROM
+            xSemaphoreGive(DataSemaphore);
+            //The sequence numbers are recorded as used before the reports can leave. When the save
+            //fails they stay queued and the save is retried in the next window
+            if(NextSeq!=0 && MetaIsMounted() && !MetaReserveSeq(NextSeq)){
+                continue;
+            }
+            //A batching transport only connects once a batch is due or a backlog waits in flash
+            if(GSMTransport->WaitForBatch && !ReportBatchReady() && !DrainDue()){
+                continue;
+            }
+            //A poor link or a running backoff defers the window, the reports stay queued
+            if(!LinkIsUsable()){
+                GSMSendFallback();
+                continue;
+            }
+            Sim800Take();
+#if TransportBenchmark
+            //Every other window goes through the other transport, compare them with TransportGetCost
+            GSMTransport=(GSMTransport==&TransportBenchA)?&TransportBenchB:&TransportBenchA;
+#endif
+            Result=GSMTransport->Open();
+            Sim800Give();
+            LinkReportResult(Result);
+            if(Result==Gsmok)
+            {
+                xEventGroupSetBits( FlagsEventGroup,  GSM_ConFlag );
+            }else{
+                GSMSendFallback();
             }
         }
         else /* xEventGroupWaitBits() returned because of timeout */
@@ -370,8 +441,11 @@ void GSMCheckConnection(void* pvParamter){
 }
 /***********************************************************************************************
  * Function Name      : GSMSendSequence
- * Description        : Function to Send a Sequence of Commands In which the data is written to
- *                      the google sheet through the GSM Module
+ * Description        : Function to Send the pending reports to the server through the GSM Module
+ *                      using the selected transport: the live reports first, then the backlog
+ *                      stored in flash during an outage, as DrainRun schedules them. A report only
+ *                      leaves the queue or the log once the transport confirmed it (a 2xx
+ *                      +HTTPACTION status for HTTP).
  * INPUTS             : void* pvParameter
  * RETURNS            : void
  ***********************************************************************************************/
@@ -382,47 +456,128 @@ void GSMSendSequence(void* pvParamter){
         //Wait and Clear both Flags on return
         if( ( uxBits & ( GSM_ConFlag ) )== ( GSM_ConFlag) )
         {
-            uint8_t check_cnt=0,comman_index=0;
-            while(comman_index<4){
-                char *P={0};
-                char *err={0};
-                uint32_t reslen=5;
-                uint32_t comlen=strlen((const char*)Commands[comman_index]);
-                //The Response buffer is supposed to the size of the transmitted data + received data +20 margin error
-                reslen+=20+comlen;
-                GSMReceiveResponse(buffer2, reslen);
-                GSMSend(Commands[comman_index],comlen);
-                P=strstr((const char*)buffer2,"OK");
-                while(*P!='O')
-                {
-                    P=strstr((const char*)buffer2,"OK");
-                    err=strstr((const char*)buffer2,"ERROR");
-                    if(*err=='E')
-                    {
-                        //Reset buffer to recieve new info
-                        memset(buffer2,'\0',reslen);
-                        break;
-                    }
-                }
-                if(*P=='O')
-                {
-                    //Reset buffer to recieve new info
-                    memset(buffer2,'\0',reslen);
-                    check_cnt=0;
-                    comman_index++;
-                }else{
-                    //Reset buffer to recieve new info
-                    memset(buffer2,'\0',reslen);
-                    check_cnt++;
-                    if(check_cnt==5){
-                        //send to EEPROM
-                        break;
-                    }
-                }
-            }
+            Sim800Take();
+            DrainRun(GSMTransport);
+            Sim800Give();
         }
         else /* xEventGroupWaitBits() returned because of timeout */
         {
         }
     }
 }
+/***********************************************************************************************
+ * Function Name      : GSMLinkMonitor
+ * Description        : Periodically sample the signal strength, registration and GPRS attach state
+ *                      so GSMCheckConnection can defer transmissions while the link is poor, and
+ *                      read the network time while GPS does not keep the clock. A module that
+ *                      stopped answering is recovered with Sim800Recover.
+ * INPUTS             : void* pvParameter
+ * RETURNS            : void
+ ***********************************************************************************************/
+void GSMLinkMonitor(void* pvParamter){
+    uint8_t Missed=0;
+    while(1){
+        Sim800Take();
+        if(LinkMonitorSample()==Gsmok){
+            Missed=0;
+        }
+        else if(++Missed>=LinkRecoverAfter){
+            //The module is wedged, restart it and drop the connection the transport thinks it has
+            if(Sim800Recover()==Gsmok){
+                GSMTransport->Close();
+                Missed=0;
+            }
+        }
+        //Without a recent GPS fix the clock follows the network time
+        if(TimeNeedsNetwork()){
+            TimeSyncFromNetwork();
+        }
+        Sim800Give();
+        //Save the metadata that changed since the last sample
+        GSMSaveMeta();
+        GSMStackFree[0]=uxTaskGetStackHighWaterMark(GSMCheckConnectionHand);
+        GSMStackFree[1]=uxTaskGetStackHighWaterMark(GSMSendSequenceHand);
+        GSMStackFree[2]=uxTaskGetStackHighWaterMark(NULL);
+        vTaskDelay(pdMS_TO_TICKS(LinkSamplePeriod));
+    }
+}
+/***********************************************************************************************
+ * Function Name      : GSMSendFallback
+ * Description        : GPRS is not available, pack the pending reports into one SMS if the network
+ *                      still registers the module, a batch is due and the SMS budget allows it.
+ *                      Otherwise a due batch is moved to the flash log and the reports that are not
+ *                      due yet stay queued for the next window.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMSendFallback(void){
+    uint32_t Count;
+    uint16_t Status=0;
+    const LinkQuality_t *Link=LinkGetQuality();
+    if(!ReportBatchReady()){
+        return;
+    }
+    if((Link->Samples!=0 && !Link->Registered) || !SmsFallbackAllowed()){
+        GSMStoreReports();
+        return;
+    }
+    Sim800Take();
+    if(SmsTransport.Open()==Gsmok){
+        ReportQueueSetSending(1);
+        Count=ReportQueueCount();
+        if(TransportSendBatch(&SmsTransport,&Count,&Status)==Gsmok){
+            while(Count!=0){
+                ReportQueueAck(Status);
+                Count--;
+            }
+        }
+        ReportQueueSetSending(0);
+    }
+    Sim800Give();
+}
+/***********************************************************************************************
+ * Function Name      : GSMStoreReports
+ * Description        : Write the pending reports to the flash log, oldest first, so they survive a
+ *                      power loss while the link is down. A report leaves the queue once stored.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMStoreReports(void){
+    Report_t *Report;
+    //An upload still running owns the queue, the reports are stored in a later window
+    if(ReportQueueIsSending()){
+        return;
+    }
+    while((Report=ReportQueuePeek())!=NULL){
+        if(!GSMStoreReport(Report)){
+            break;
+        }
+        ReportQueueStored();
+    }
+}
+/***********************************************************************************************
+ * Function Name      : GSMStoreReport
+ * Description        : Write a report to the flash log as a compact record.
+ * INPUTS             : const Report_t *Report
+ * RETURNS            : uint8_t 1 when stored, 0 otherwise
+ ***********************************************************************************************/
+static uint8_t GSMStoreReport(const Report_t *Report){
+    Record_t Record;
+    TransportToRecord(&Record,Report);
+    return FlashLogAppend(&Record);
+}
+/***********************************************************************************************
+ * Function Name      : GSMSaveMeta
+ * Description        : Record where the flash log stands and save the metadata that changed, at
+ *                      the pace of the link samples to spare the EEPROM.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void GSMSaveMeta(void){
+    uint32_t LogSeq;
+    uint32_t Head;
+    uint32_t Tail;
+    FlashLogGetPosition(&LogSeq,&Head,&Tail);
+    MetaSetLog(LogSeq,Head,Tail);
+    MetaFlush();
+}
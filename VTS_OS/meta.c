@@ -0,0 +1,299 @@
+/******************************************************************************
+ * File Name: meta.c
+ *
+ * Description: Source file for the metadata store. The values change too
+ *              often to rewrite a flash page for each of them, they are kept
+ *              in the EEPROM instead:
+ *
+ *              copy : generation | Meta_t | CRC-32 of both
+ *
+ *              Every save writes a new copy in the next slot of a ring of
+ *              MetaSlots EEPROM blocks with the generation counted up, which
+ *              spreads the wear over the ring. At mount the copy of the
+ *              highest generation with a good CRC wins, a copy cut by a power
+ *              loss leaves the one before it in use.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "meta.h"
+#include "crc32.h"
+#include <string.h>
+#if !defined(MetaHostBuild)
+#include <stdbool.h>
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Word offsets in a copy */
+#define MetaGenWord         0
+#define MetaDataWord        1
+#define MetaCrcWord         (MetaDataWord+sizeof(Meta_t)/4)
+#define MetaCopyWords       (MetaCrcWord+1)
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t MetaSave(void);
+#if !defined(MetaHostBuild)
+static uint32_t MetaEepromInit(void);
+#endif
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static const MetaBackend_t *MetaStore=NULL;
+static Meta_t      Meta;
+/* Slot of the copy in use and changes not saved yet */
+static uint32_t    MetaSlot;
+static uint8_t     MetaDirty;
+/* Distance below a metre not added to the odometer yet (mm) */
+static uint32_t    MetaOdometerMm;
+static MetaStats_t MetaStats;
+
+#if !defined(MetaHostBuild)
+const MetaBackend_t MetaEeprom={
+    MetaEepromInit,
+    EEPROMRead,
+    EEPROMProgram,
+    2048
+};
+#endif
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : MetaInit
+ * Description        : Start the storage and load the newest good copy. Without one every value
+ *                      starts at 0.
+ * INPUTS             : const MetaBackend_t *Backend
+ * RETURNS            : uint8_t 1 if a saved copy was found
+ ***********************************************************************************************/
+uint8_t MetaInit(const MetaBackend_t *Backend)
+{
+    uint32_t Words[MetaCopyWords];
+    uint32_t Slot;
+    uint8_t  Found=0;
+    MetaStore=NULL;
+    memset(&Meta,0,sizeof(Meta));
+    memset(&MetaStats,0,sizeof(MetaStats));
+    MetaSlot=MetaSlots-1;
+    MetaDirty=0;
+    MetaOdometerMm=0;
+    if(Backend->Size<MetaSlots*MetaSlotSize || Backend->Init()!=0)
+    {
+        return 0;
+    }
+    MetaStore=Backend;
+    for(Slot=0;Slot<MetaSlots;Slot++)
+    {
+        MetaStore->Read(Words,Slot*MetaSlotSize,sizeof(Words));
+        if(Words[MetaCrcWord]!=Crc32((const uint8_t*)Words,MetaCrcWord*4))
+        {
+            //A blank slot fails the CRC as well, only count the ones that were written
+            if(Words[MetaGenWord]!=0xFFFFFFFFU)
+            {
+                MetaStats.Torn++;
+            }
+            continue;
+        }
+        if(!Found || Words[MetaGenWord]>MetaStats.Generation)
+        {
+            MetaStats.Generation=Words[MetaGenWord];
+            memcpy(&Meta,&Words[MetaDataWord],sizeof(Meta));
+            MetaSlot=Slot;
+            Found=1;
+        }
+    }
+    return Found;
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaGet
+ * Description        : Values as loaded at mount and updated since.
+ * INPUTS             : void
+ * RETURNS            : const Meta_t*
+ ***********************************************************************************************/
+const Meta_t *MetaGet(void)
+{
+    return &Meta;
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaReserveSeq
+ * Description        : Make sure the report sequence numbers below NextSeq are recorded as used
+ *                      before a report carrying one of them leaves. A new block of MetaSeqBlock
+ *                      numbers is saved at once when the reserved ones run out, so a reset never
+ *                      gives a sequence number the server already received. The block only counts
+ *                      as reserved once the save succeeded.
+ * INPUTS             : uint32_t NextSeq, the sequence number the next report gets
+ * RETURNS            : uint8_t 1 when NextSeq is covered by the saved copy
+ ***********************************************************************************************/
+uint8_t MetaReserveSeq(uint32_t NextSeq)
+{
+    uint32_t Reserved=Meta.ReportSeq;
+    if(NextSeq<=Reserved)
+    {
+        return 1;
+    }
+    //MetaSave writes the values of Meta, the new block is taken back if the save fails
+    Meta.ReportSeq=NextSeq+MetaSeqBlock;
+    if(!MetaSave())
+    {
+        Meta.ReportSeq=Reserved;
+        return 0;
+    }
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaSetLog
+ * Description        : Record the position of the flash log, saved with the next flush.
+ * INPUTS             : uint32_t LogSeq, uint32_t Head, uint32_t Tail
+ * RETURNS            : void
+ ***********************************************************************************************/
+void MetaSetLog(uint32_t LogSeq,uint32_t Head,uint32_t Tail)
+{
+    if(Meta.LogSeq!=LogSeq || Meta.LogHead!=Head || Meta.LogTail!=Tail)
+    {
+        Meta.LogSeq=LogSeq;
+        Meta.LogHead=Head;
+        Meta.LogTail=Tail;
+        MetaDirty=1;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaAddDistance
+ * Description        : Add the distance driven at a speed for some time to the odometer. A gap
+ *                      longer than MetaOdometerMaxGap (lost fixes) is counted as that long.
+ * INPUTS             : uint16_t Speed (km/h), uint32_t Ms
+ * RETURNS            : void
+ ***********************************************************************************************/
+void MetaAddDistance(uint16_t Speed,uint32_t Ms)
+{
+    if(Ms>MetaOdometerMaxGap)
+    {
+        Ms=MetaOdometerMaxGap;
+    }
+    //1 km/h is 1000 m in 3600000 ms, 10 mm every 36 ms
+    MetaOdometerMm+=((uint32_t)Speed*Ms*10)/36;
+    if(MetaOdometerMm>=1000)
+    {
+        Meta.Odometer+=MetaOdometerMm/1000;
+        MetaOdometerMm%=1000;
+        MetaDirty=1;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaSetFix
+ * Description        : Record the last valid fix, saved with the next flush.
+ * INPUTS             : int32_t Lat, int32_t Lon (micro degrees), uint32_t Time (UTC Unix time)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void MetaSetFix(int32_t Lat,int32_t Lon,uint32_t Time)
+{
+    if(Meta.FixLat!=Lat || Meta.FixLon!=Lon)
+    {
+        Meta.FixLat=Lat;
+        Meta.FixLon=Lon;
+        Meta.FixTime=Time;
+        MetaDirty=1;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaFlush
+ * Description        : Save the values if any of them changed since the last save. Called at a
+ *                      slow pace, every call that saves wears one copy.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 when nothing is left unsaved
+ ***********************************************************************************************/
+uint8_t MetaFlush(void)
+{
+    if(!MetaDirty)
+    {
+        return 1;
+    }
+    return MetaSave();
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaIsMounted
+ * Description        : Tell if MetaInit started the storage, with or without a saved copy.
+ * INPUTS             : void
+ * RETURNS            : uint8_t
+ ***********************************************************************************************/
+uint8_t MetaIsMounted(void)
+{
+    return MetaStore!=NULL;
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaGetStats
+ * Description        : Store accounting since MetaInit.
+ * INPUTS             : void
+ * RETURNS            : const MetaStats_t*
+ ***********************************************************************************************/
+const MetaStats_t *MetaGetStats(void)
+{
+    return &MetaStats;
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaSave
+ * Description        : Write the values as a new copy in the slot after the one in use. The copy
+ *                      in use stays untouched until the new one is complete.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+static uint8_t MetaSave(void)
+{
+    uint32_t Words[MetaCopyWords];
+    uint32_t Slot=(MetaSlot+1)%MetaSlots;
+    if(MetaStore==NULL)
+    {
+        return 0;
+    }
+    Words[MetaGenWord]=MetaStats.Generation+1;
+    memcpy(&Words[MetaDataWord],&Meta,sizeof(Meta));
+    Words[MetaCrcWord]=Crc32((const uint8_t*)Words,MetaCrcWord*4);
+    if(MetaStore->Program(Words,Slot*MetaSlotSize,sizeof(Words))!=0)
+    {
+        MetaStats.Errors++;
+        return 0;
+    }
+    MetaStats.Generation++;
+    MetaStats.Writes++;
+    MetaSlot=Slot;
+    MetaDirty=0;
+    return 1;
+}
+
+#if !defined(MetaHostBuild)
+/***********************************************************************************************
+ * Function Name      : MetaEepromInit
+ * Description        : Clock the EEPROM and let it finish a write a reset interrupted.
+ * INPUTS             : void
+ * RETURNS            : uint32_t EEPROM_INIT_OK (0) when the EEPROM is ready
+ ***********************************************************************************************/
+static uint32_t MetaEepromInit(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0))
+    {
+    }
+    return EEPROMInit();
+}
+#endif
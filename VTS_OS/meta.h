@@ -0,0 +1,82 @@
+/******************************************************************************
+ * File Name: meta.h
+ *
+ * Description: Header file for the store of the small values that change
+ *              often and must survive a reset: sequence counters, flash log
+ *              pointers, odometer and last good fix.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_META_H_
+#define SRC_META_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Copies kept in a ring, one EEPROM block each, the newest one with a good CRC wins */
+#define MetaSlots           16
+#define MetaSlotSize        64
+/* Report sequence numbers are reserved this many at a time */
+#define MetaSeqBlock        64
+/* Longest gap between two fixes the odometer integrates the speed over (ms) */
+#define MetaOdometerMaxGap  5000
+
+typedef struct{
+    uint32_t ReportSeq;      /* Report sequence numbers from this one on were never used */
+    uint32_t LogSeq;         /* Log seq the flash log appends next */
+    uint32_t LogHead;        /* Slot the flash log appends to */
+    uint32_t LogTail;        /* Oldest pending slot of the flash log */
+    uint32_t Odometer;       /* Metres driven */
+    int32_t  FixLat;         /* Last valid fix in micro degrees */
+    int32_t  FixLon;
+    uint32_t FixTime;        /* UTC Unix time of the last valid fix, 0 if there was none */
+}Meta_t;
+
+typedef struct{
+    /* Start the storage, 0 when it is ready */
+    uint32_t (*Init)(void);
+    /* Copy Size bytes (a multiple of 4) from Address */
+    void     (*Read)(uint32_t *Data,uint32_t Address,uint32_t Size);
+    /* Write Size bytes (a multiple of 4) at Address, 0 on success */
+    uint32_t (*Program)(uint32_t *Data,uint32_t Address,uint32_t Size);
+    uint32_t Size;           /* Bytes available, at least MetaSlots*MetaSlotSize */
+}MetaBackend_t;
+
+typedef struct{
+    uint32_t Generation;     /* Generation of the copy in use */
+    uint32_t Writes;         /* Copies written since MetaInit */
+    uint32_t Torn;           /* Copies found with a bad CRC at mount */
+    uint32_t Errors;         /* Writes the backend failed */
+}MetaStats_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+uint8_t MetaInit(const MetaBackend_t *Backend);
+const Meta_t *MetaGet(void);
+uint8_t MetaReserveSeq(uint32_t NextSeq);
+void MetaSetLog(uint32_t LogSeq,uint32_t Head,uint32_t Tail);
+void MetaAddDistance(uint16_t Speed,uint32_t Ms);
+void MetaSetFix(int32_t Lat,int32_t Lon,uint32_t Time);
+uint8_t MetaFlush(void);
+uint8_t MetaIsMounted(void);
+const MetaStats_t *MetaGetStats(void);
+
+#if defined(MetaHostBuild)
+/* File standing for the EEPROM on the host, see meta_file.c */
+const MetaBackend_t *MetaFileOpen(const char *Path);
+void MetaFileClose(void);
+#else
+/* The 2 KB EEPROM of the TM4C123 */
+extern const MetaBackend_t MetaEeprom;
+#endif
+
+#endif /* SRC_META_H_ */
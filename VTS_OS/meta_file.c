@@ -0,0 +1,133 @@
+/******************************************************************************
+ * File Name: meta_file.c
+ *
+ * Description: Source file for the host backend of the metadata store. A file
+ *              of the size of the TM4C123 EEPROM stands for it, so the store
+ *              keeps its values from one run to the next. Builds with
+ *              MetaHostBuild defined only.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(MetaHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "meta.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define MetaFileSize        2048
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t MetaFileInit(void);
+static void MetaFileRead(uint32_t *Data,uint32_t Address,uint32_t Size);
+static uint32_t MetaFileProgram(uint32_t *Data,uint32_t Address,uint32_t Size);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static FILE *MetaFile=NULL;
+static const MetaBackend_t MetaFileBackend={
+    MetaFileInit,
+    MetaFileRead,
+    MetaFileProgram,
+    MetaFileSize
+};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : MetaFileOpen
+ * Description        : Open the file standing for the EEPROM, a missing file is created erased.
+ * INPUTS             : const char *Path
+ * RETURNS            : const MetaBackend_t* or NULL if the file cannot be opened
+ ***********************************************************************************************/
+const MetaBackend_t *MetaFileOpen(const char *Path)
+{
+    uint8_t Blank[MetaFileSize];
+    MetaFileClose();
+    MetaFile=fopen(Path,"r+b");
+    if(MetaFile==NULL)
+    {
+        MetaFile=fopen(Path,"w+b");
+        if(MetaFile==NULL)
+        {
+            return NULL;
+        }
+        memset(Blank,0xFF,sizeof(Blank));
+        fwrite(Blank,1,sizeof(Blank),MetaFile);
+        fflush(MetaFile);
+    }
+    return &MetaFileBackend;
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaFileClose
+ * Description        : Close the file, as if the device was switched off.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void MetaFileClose(void)
+{
+    if(MetaFile!=NULL)
+    {
+        fclose(MetaFile);
+        MetaFile=NULL;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaFileInit
+ * Description        : The file is ready once opened.
+ * INPUTS             : void
+ * RETURNS            : uint32_t 0 when a file is open
+ ***********************************************************************************************/
+static uint32_t MetaFileInit(void)
+{
+    return (MetaFile!=NULL)?0:1;
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaFileRead
+ * Description        : Copy Size bytes from the file.
+ * INPUTS             : uint32_t *Data, uint32_t Address, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void MetaFileRead(uint32_t *Data,uint32_t Address,uint32_t Size)
+{
+    fseek(MetaFile,(long)Address,SEEK_SET);
+    if(fread(Data,1,Size,MetaFile)!=Size)
+    {
+        memset(Data,0xFF,Size);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : MetaFileProgram
+ * Description        : Write Size bytes to the file, the EEPROM needs no erase before a write.
+ * INPUTS             : uint32_t *Data, uint32_t Address, uint32_t Size
+ * RETURNS            : uint32_t 0 on success
+ ***********************************************************************************************/
+static uint32_t MetaFileProgram(uint32_t *Data,uint32_t Address,uint32_t Size)
+{
+    fseek(MetaFile,(long)Address,SEEK_SET);
+    if(fwrite(Data,1,Size,MetaFile)!=Size)
+    {
+        return 1;
+    }
+    fflush(MetaFile);
+    return 0;
+}
+
+#endif /* MetaHostBuild */
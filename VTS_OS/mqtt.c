@@ -0,0 +1,458 @@
+/******************************************************************************
+ * File Name: mqtt.c
+ *
+ * Description: Source file for a small MQTT 3.1.1 client on the SIM800 TCP
+ *              connection. It keeps one session open, publishes positions and
+ *              events with QoS 0 or 1 and receives the downlink configuration
+ *              topic. All buffers are static.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "mqtt.h"
+#include "dns.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t MqttTransportOpen(void);
+static uint32_t MqttTransportSend(const Report_t *Report,uint16_t *Status);
+static void MqttTransportClose(void);
+static uint32_t MqttPutString(uint8_t *Buf,const char *Str);
+static uint32_t MqttSendPacket(uint8_t Type,uint32_t BodySize);
+static uint32_t MqttWaitFor(uint8_t Type,uint16_t PacketId);
+static uint8_t MqttProcess(uint8_t Type,uint16_t PacketId);
+static void MqttHandlePublish(uint8_t Flags,const uint8_t *Body,uint32_t BodySize);
+static uint16_t MqttNewPacketId(void);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Outgoing packet, the body is built after the 2 byte fixed header */
+static uint8_t  MqttTxBuf[MqttTxBufSize];
+/* Bytes received from the broker and not processed yet */
+static uint8_t  MqttRxBuf[MqttRxBufSize];
+static uint32_t MqttRxLen=0;
+static char     MqttTopicBuf[MqttTopicBufSize];
+static uint8_t  MqttFrame[TransportFrameSize];
+static uint16_t MqttPacketId=0;
+static uint8_t  MqttConnected=0;
+/* Tick of the last packet sent, drives the keep alive ping */
+static TickType_t MqttLastTx=0;
+static void (*MqttMessageCallback)(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize)=NULL;
+
+static TransportStats_t MqttStats;
+const Transport_t MqttTransport={"MQTT",MqttTransportOpen,MqttTransportSend,MqttTransportClose,NULL,0,&MqttStats};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : MqttConnect
+ * Description        : Open the TCP connection to the broker, start a clean session and
+ *                      subscribe to the configuration topic.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t MqttConnect(void)
+{
+    uint8_t *Body=&MqttTxBuf[2];
+    uint32_t Size=0;
+    MqttConnected=0;
+    MqttRxLen=0;
+    if(DnsSocketOpen("TCP",MqttBrokerHost,MqttBrokerPort)!=Gsmok)
+    {
+        return GsmError;
+    }
+    Size+=MqttPutString(&Body[Size],"MQTT");
+    Body[Size++]=4;                         // Protocol level 3.1.1
+    Body[Size++]=0x02;                      // Clean session
+    Body[Size++]=(uint8_t)(MqttKeepAlive>>8);
+    Body[Size++]=(uint8_t)MqttKeepAlive;
+    Size+=MqttPutString(&Body[Size],MqttClientId);
+    if(MqttSendPacket(MqttConnectPkt,Size)!=Gsmok || MqttWaitFor(MqttConnackPkt,0)!=Gsmok)
+    {
+        Sim800SocketClose();
+        return GsmError;
+    }
+    MqttConnected=1;
+    if(MqttSubscribe(MqttConfigTopic,1)!=Gsmok)
+    {
+        MqttDisconnect();
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttDisconnect
+ * Description        : End the session and close the connection to the broker.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void MqttDisconnect(void)
+{
+    if(MqttConnected)
+    {
+        MqttSendPacket(MqttDisconnectPkt,0);
+        MqttConnected=0;
+    }
+    Sim800SocketClose();
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttPublish
+ * Description        : Publish a message. With QoS 1 it only succeeds once the broker sent the
+ *                      matching PUBACK.
+ * INPUTS             : const char *Topic, const uint8_t *Payload, uint32_t PayloadSize,
+ *                      uint8_t Qos (0 or 1)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t MqttPublish(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize,uint8_t Qos)
+{
+    uint8_t *Body=&MqttTxBuf[2];
+    uint32_t Size=0;
+    uint16_t PacketId=0;
+    if(!MqttConnected || 2+2+strlen(Topic)+2+PayloadSize>MqttTxBufSize)
+    {
+        return GsmError;
+    }
+    Size+=MqttPutString(&Body[Size],Topic);
+    if(Qos!=0)
+    {
+        PacketId=MqttNewPacketId();
+        Body[Size++]=(uint8_t)(PacketId>>8);
+        Body[Size++]=(uint8_t)PacketId;
+    }
+    memcpy(&Body[Size],Payload,PayloadSize);
+    Size+=PayloadSize;
+    if(MqttSendPacket(MqttPublishPkt|(Qos!=0 ? 0x02 : 0x00),Size)!=Gsmok)
+    {
+        return GsmError;
+    }
+    if(Qos!=0)
+    {
+        return MqttWaitFor(MqttPubackPkt,PacketId);
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttPublishEvent
+ * Description        : Publish a text event on the event topic with QoS 1.
+ * INPUTS             : const char *Event
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t MqttPublishEvent(const char *Event)
+{
+    return MqttPublish(MqttEventTopic,(const uint8_t *)Event,strlen(Event),1);
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttSubscribe
+ * Description        : Subscribe to a topic and wait for the SUBACK granting it.
+ * INPUTS             : const char *Topic, uint8_t Qos
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t MqttSubscribe(const char *Topic,uint8_t Qos)
+{
+    uint8_t *Body=&MqttTxBuf[2];
+    uint32_t Size=0;
+    uint16_t PacketId=MqttNewPacketId();
+    if(!MqttConnected || 2+2+2+strlen(Topic)+1>MqttTxBufSize)
+    {
+        return GsmError;
+    }
+    Body[Size++]=(uint8_t)(PacketId>>8);
+    Body[Size++]=(uint8_t)PacketId;
+    Size+=MqttPutString(&Body[Size],Topic);
+    Body[Size++]=Qos;
+    if(MqttSendPacket(MqttSubscribePkt,Size)!=Gsmok)
+    {
+        return GsmError;
+    }
+    return MqttWaitFor(MqttSubackPkt,PacketId);
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttPoll
+ * Description        : Deliver the downlink messages waiting in the module and keep the session
+ *                      alive with a PINGREQ once half the keep alive period passed idle.
+ * INPUTS             : void
+ * RETURNS            : uint32_t Gsmok while the session is up
+ ***********************************************************************************************/
+uint32_t MqttPoll(void)
+{
+    uint32_t Received=0;
+    if(!MqttConnected)
+    {
+        return GsmError;
+    }
+    if(Sim800SocketReceive(&MqttRxBuf[MqttRxLen],MqttRxBufSize-MqttRxLen,&Received)==Gsmok)
+    {
+        MqttRxLen+=Received;
+        MqttProcess(0,0);
+    }
+    if((xTaskGetTickCount()-MqttLastTx)>=pdMS_TO_TICKS(MqttKeepAlive*500UL))
+    {
+        if(MqttSendPacket(MqttPingreqPkt,0)!=Gsmok || MqttWaitFor(MqttPingrespPkt,0)!=Gsmok)
+        {
+            MqttConnected=0;
+            return GsmError;
+        }
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttSetMessageCallBack
+ * Description        : Set the function called for every message received on a subscribed topic.
+ * INPUTS             : void (*Callback)(const char *Topic, const uint8_t *Payload, uint32_t Size)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void MqttSetMessageCallBack(void (*Callback)(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize))
+{
+    MqttMessageCallback=Callback;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTransportOpen
+ * Description        : Connect to the broker unless the session is up, in which case the downlink
+ *                      is polled and the session kept alive.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t MqttTransportOpen(void)
+{
+    if(MqttConnected && MqttPoll()==Gsmok)
+    {
+        return Gsmok;
+    }
+    return MqttConnect();
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTransportSend
+ * Description        : Publish the report as a framed position record on the position topic.
+ * INPUTS             : const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t MqttTransportSend(const Report_t *Report,uint16_t *Status)
+{
+    uint32_t Size=TransportBuildFrame(MqttFrame,Report);
+    (void)Status;
+    if(MqttPublish(MqttPositionTopic,MqttFrame,Size,MqttPositionQos)!=Gsmok)
+    {
+        MqttConnected=0;
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTransportClose
+ * Description        : End the MQTT session.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void MqttTransportClose(void)
+{
+    MqttDisconnect();
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttPutString
+ * Description        : Write a length prefixed MQTT string.
+ * INPUTS             : uint8_t *Buf, const char *Str
+ * RETURNS            : uint32_t bytes written
+ ***********************************************************************************************/
+static uint32_t MqttPutString(uint8_t *Buf,const char *Str)
+{
+    uint32_t Len=strlen(Str);
+    Buf[0]=(uint8_t)(Len>>8);
+    Buf[1]=(uint8_t)Len;
+    memcpy(&Buf[2],Str,Len);
+    return Len+2;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttSendPacket
+ * Description        : Add the fixed header to the body built in MqttTxBuf and send the packet.
+ * INPUTS             : uint8_t Type (with its flags), uint32_t BodySize (below 128)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t MqttSendPacket(uint8_t Type,uint32_t BodySize)
+{
+    MqttTxBuf[0]=Type;
+    MqttTxBuf[1]=(uint8_t)BodySize;
+    if(Sim800SocketSend(MqttTxBuf,BodySize+2)!=Gsmok)
+    {
+        return GsmError;
+    }
+    MqttLastTx=xTaskGetTickCount();
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttWaitFor
+ * Description        : Read from the broker until the wanted packet arrived or the acknowledge
+ *                      timeout expired. Messages received meanwhile are delivered as usual.
+ * INPUTS             : uint8_t Type, uint16_t PacketId (0 for packets without an id)
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t MqttWaitFor(uint8_t Type,uint16_t PacketId)
+{
+    uint32_t Received;
+    TickType_t Start=xTaskGetTickCount();
+    while((xTaskGetTickCount()-Start)<pdMS_TO_TICKS(MqttAckTimeout))
+    {
+        Received=0;
+        if(Sim800SocketReceive(&MqttRxBuf[MqttRxLen],MqttRxBufSize-MqttRxLen,&Received)==Gsmok)
+        {
+            MqttRxLen+=Received;
+        }
+        if(MqttProcess(Type,PacketId))
+        {
+            return Gsmok;
+        }
+        if(Received==0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+    return GsmError;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttProcess
+ * Description        : Handle every complete packet in the receive buffer.
+ * INPUTS             : uint8_t Type, uint16_t PacketId the packet waited for, Type 0 for none
+ * RETURNS            : uint8_t 1 if the packet waited for was received
+ ***********************************************************************************************/
+static uint8_t MqttProcess(uint8_t Type,uint16_t PacketId)
+{
+    uint8_t Found=0;
+    uint32_t Size;
+    uint16_t Id;
+    while(MqttRxLen>=2)
+    {
+        // Packets of 128 bytes or more never fit, drop everything to resynchronize
+        if(MqttRxBuf[1]&0x80)
+        {
+            MqttRxLen=0;
+            break;
+        }
+        Size=2+MqttRxBuf[1];
+        if(MqttRxLen<Size)
+        {
+            if(Size>MqttRxBufSize)
+            {
+                MqttRxLen=0;
+            }
+            break;
+        }
+        Id=(Size>=4) ? (uint16_t)((MqttRxBuf[2]<<8)|MqttRxBuf[3]) : 0;
+        switch(MqttRxBuf[0]&0xF0)
+        {
+        case MqttConnackPkt:
+            // The return code is the second byte of the body, 0 means accepted
+            if(Type==MqttConnackPkt && Size==4 && MqttRxBuf[3]==0)
+            {
+                Found=1;
+            }
+            break;
+        case MqttPubackPkt:
+        case MqttPingrespPkt:
+            if(Type==(MqttRxBuf[0]&0xF0) && Id==PacketId)
+            {
+                Found=1;
+            }
+            break;
+        case MqttSubackPkt:
+            // A granted QoS of 0x80 means the subscription was refused
+            if(Type==MqttSubackPkt && Id==PacketId && Size==5 && MqttRxBuf[4]!=0x80)
+            {
+                Found=1;
+            }
+            break;
+        case MqttPublishPkt:
+            MqttHandlePublish(MqttRxBuf[0]&0x0F,&MqttRxBuf[2],Size-2);
+            break;
+        default:
+            break;
+        }
+        MqttRxLen-=Size;
+        memmove(MqttRxBuf,&MqttRxBuf[Size],MqttRxLen);
+    }
+    return Found;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttHandlePublish
+ * Description        : Deliver a message from the broker to the callback and acknowledge it when
+ *                      it was sent with QoS 1.
+ * INPUTS             : uint8_t Flags, const uint8_t *Body, uint32_t BodySize
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void MqttHandlePublish(uint8_t Flags,const uint8_t *Body,uint32_t BodySize)
+{
+    uint32_t TopicLen;
+    uint32_t Offset;
+    uint16_t PacketId=0;
+    uint8_t  Qos=(Flags>>1)&0x03;
+    if(BodySize<2)
+    {
+        return;
+    }
+    TopicLen=((uint32_t)Body[0]<<8)|Body[1];
+    Offset=2+TopicLen;
+    if(Qos!=0)
+    {
+        if(Offset+2>BodySize)
+        {
+            return;
+        }
+        PacketId=(uint16_t)((Body[Offset]<<8)|Body[Offset+1]);
+        Offset+=2;
+    }
+    if(Offset>BodySize || TopicLen>=MqttTopicBufSize)
+    {
+        return;
+    }
+    memcpy(MqttTopicBuf,&Body[2],TopicLen);
+    MqttTopicBuf[TopicLen]='\0';
+    if(MqttMessageCallback!=NULL)
+    {
+        MqttMessageCallback(MqttTopicBuf,&Body[Offset],BodySize-Offset);
+    }
+    if(Qos==1)
+    {
+        MqttTxBuf[2]=(uint8_t)(PacketId>>8);
+        MqttTxBuf[3]=(uint8_t)PacketId;
+        MqttSendPacket(MqttPubackPkt,2);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttNewPacketId
+ * Description        : Get the next packet identifier, 0 is not a valid identifier.
+ * INPUTS             : void
+ * RETURNS            : uint16_t
+ ***********************************************************************************************/
+static uint16_t MqttNewPacketId(void)
+{
+    MqttPacketId++;
+    if(MqttPacketId==0)
+    {
+        MqttPacketId=1;
+    }
+    return MqttPacketId;
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+ * File Name: mqtt.h
+ *
+ * Description: Header file for the MQTT 3.1.1 client running on the SIM800
+ *              TCP connection.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_MQTT_H_
+#define SRC_MQTT_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "transport.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Broker and session, modify them with your own broker and device */
+#define MqttBrokerHost          TransportServerHost
+#define MqttBrokerPort          1883
+#define MqttClientId            "vts-0001"
+#define MqttKeepAlive           120         /* Seconds */
+#define MqttTopic(Leaf)         "vts/" MqttClientId "/" Leaf
+#define MqttPositionTopic       MqttTopic("pos")
+#define MqttEventTopic          MqttTopic("evt")
+#define MqttConfigTopic         MqttTopic("cfg")
+#define MqttPositionQos         1
+
+/* Packets are kept below 128 bytes so the remaining length is a single byte */
+#define MqttTxBufSize           96
+#define MqttRxBufSize           96
+#define MqttTopicBufSize        32
+/* Time in ms the broker is given to acknowledge a packet */
+#define MqttAckTimeout          10000
+
+/* Control packet types, upper nibble of the fixed header */
+#define MqttConnectPkt          0x10
+#define MqttConnackPkt          0x20
+#define MqttPublishPkt          0x30
+#define MqttPubackPkt           0x40
+#define MqttSubscribePkt        0x82
+#define MqttSubackPkt           0x90
+#define MqttPingreqPkt          0xC0
+#define MqttPingrespPkt         0xD0
+#define MqttDisconnectPkt       0xE0
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+uint32_t MqttConnect(void);
+void MqttDisconnect(void);
+uint32_t MqttPublish(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize,uint8_t Qos);
+uint32_t MqttPublishEvent(const char *Event);
+uint32_t MqttSubscribe(const char *Topic,uint8_t Qos);
+uint32_t MqttPoll(void);
+void MqttSetMessageCallBack(void (*Callback)(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize));
+
+#endif /* SRC_MQTT_H_ */
@@ -0,0 +1,450 @@
+/******************************************************************************
+ * File Name: mqtttest.c
+ *
+ * Description: Host test of the MQTT client against a stand-in broker on the
+ *              socket calls of the SIM800 driver. The stand-in checks every
+ *              packet the client sends and answers it as a 3.1.1 broker does:
+ *              CONNECT and CONNACK, SUBSCRIBE and SUBACK, QoS 1 PUBLISH and
+ *              PUBACK, PINGREQ and PINGRESP, and a downlink PUBLISH to the
+ *              message callback. It can refuse the session or the subscription,
+ *              lose a PUBACK, send a stray one, stop answering pings and split
+ *              its answers in single bytes. It is not a full broker: retained
+ *              messages, QoS 2 and the will are not modelled. Builds with
+ *              MqttHostBuild defined only, with mqtt.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(MqttHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "mqtt.h"
+#include "dns.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define MqttTestOutSize     256
+#define MqttTestTopicSize   48
+#define MqttTestDataSize    96
+/* Id of the downlink message sent by the broker */
+#define MqttTestDownlinkId  0x1234
+
+typedef struct{
+    uint32_t Packets[16];    /* Packets received from the client, by type */
+    uint32_t Bad;            /* Packets the broker could not read */
+    uint32_t Opens;          /* Connections opened */
+    uint32_t Closes;         /* Connections closed */
+    char     Topic[MqttTestTopicSize];   /* Topic of the last SUBSCRIBE or PUBLISH */
+    uint8_t  Data[MqttTestDataSize];     /* Payload of the last PUBLISH */
+    uint32_t DataSize;
+    uint8_t  Qos;            /* QoS of the last SUBSCRIBE or PUBLISH */
+    uint16_t PubackId;       /* Id of the last PUBACK from the client */
+}MqttTestBroker_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t MqttTestCheck(const char *Name,uint8_t Passed);
+static void MqttTestReset(void);
+static void MqttTestQueue(const uint8_t *Packet,uint32_t Size);
+static void MqttTestDownlink(const char *Topic,const char *Payload,uint8_t Qos);
+static uint32_t MqttTestGetString(const uint8_t *Data,uint32_t Size,char *Str);
+static void MqttTestMessage(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static TickType_t       MqttTestNow;
+static MqttTestBroker_t MqttTestBroker;
+/* Bytes the broker sent and the client did not read yet */
+static uint8_t          MqttTestOut[MqttTestOutSize];
+static uint32_t         MqttTestOutLen;
+/* Behaviour of the broker */
+static uint32_t         MqttTestChunk;
+static uint8_t          MqttTestConnackCode;
+static uint8_t          MqttTestGranted;
+static uint8_t          MqttTestDropPubacks;
+static uint8_t          MqttTestStrayPuback;
+static uint8_t          MqttTestPing;
+/* Last message given to the callback */
+static char             MqttTestRxTopic[MqttTestTopicSize];
+static char             MqttTestRxData[MqttTestDataSize];
+static uint32_t         MqttTestRxCount;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Run a session through the MqttTransport interface the GSM tasks use and
+ *                      the broker failures it has to survive.
+ * INPUTS             : void
+ * RETURNS            : int 0, 1 if a case failed
+ ***********************************************************************************************/
+int main(void)
+{
+    Report_t Report;
+    uint16_t Status=0;
+    uint32_t Sent;
+    TickType_t Start;
+    uint8_t  Failed=0;
+    memset(&Report,0,sizeof(Report));
+    MqttSetMessageCallBack(MqttTestMessage);
+    //A session starts with the configuration topic subscribed
+    MqttTestReset();
+    Failed|=MqttTestCheck("connect and subscribe",MqttTransport.Open()==Gsmok &&
+                          MqttTestBroker.Packets[MqttConnectPkt>>4]==1 &&
+                          MqttTestBroker.Packets[MqttSubscribePkt>>4]==1 &&
+                          strcmp(MqttTestBroker.Topic,MqttConfigTopic)==0 && MqttTestBroker.Qos==1);
+    //A position is published with QoS 1 and confirmed by its PUBACK
+    Report.Seq=7;
+    Failed|=MqttTestCheck("QoS 1 position",MqttTransport.Send(&Report,&Status)==Gsmok &&
+                          strcmp(MqttTestBroker.Topic,MqttPositionTopic)==0 && MqttTestBroker.Qos==1 &&
+                          MqttTestBroker.DataSize==TransportFrameSize && MqttTestBroker.Data[3]==7);
+    //The PUBACK of another packet does not confirm it, the answers come a byte at a time
+    MqttTestStrayPuback=1;
+    MqttTestChunk=1;
+    Report.Seq=8;
+    Failed|=MqttTestCheck("stray PUBACK, split answers",MqttTransport.Send(&Report,&Status)==Gsmok &&
+                          MqttTestBroker.Data[3]==8);
+    MqttTestStrayPuback=0;
+    MqttTestChunk=MqttTestOutSize;
+    //A lost PUBACK fails the report after the timeout and the next window connects again
+    MqttTestDropPubacks=1;
+    Report.Seq=9;
+    Start=MqttTestNow;
+    Sent=MqttTestBroker.Packets[MqttPublishPkt>>4];
+    Failed|=MqttTestCheck("lost PUBACK",MqttTransport.Send(&Report,&Status)!=Gsmok &&
+                          MqttTestBroker.Packets[MqttPublishPkt>>4]==Sent+1 &&
+                          (MqttTestNow-Start)>=pdMS_TO_TICKS(MqttAckTimeout));
+    MqttTestDropPubacks=0;
+    Failed|=MqttTestCheck("reconnect after a loss",MqttTransport.Open()==Gsmok &&
+                          MqttTestBroker.Packets[MqttConnectPkt>>4]==2 &&
+                          MqttTransport.Send(&Report,&Status)==Gsmok && MqttTestBroker.Data[3]==9);
+    //Downlink messages reach the callback, the QoS 1 one is acknowledged with its id
+    MqttTestDownlink(MqttConfigTopic,"period=30",1);
+    Failed|=MqttTestCheck("downlink QoS 1",MqttPoll()==Gsmok && MqttTestRxCount==1 &&
+                          strcmp(MqttTestRxTopic,MqttConfigTopic)==0 &&
+                          strcmp(MqttTestRxData,"period=30")==0 &&
+                          MqttTestBroker.PubackId==MqttTestDownlinkId);
+    Sent=MqttTestBroker.Packets[MqttPubackPkt>>4];
+    MqttTestDownlink(MqttConfigTopic,"period=60",0);
+    Failed|=MqttTestCheck("downlink QoS 0",MqttPoll()==Gsmok && MqttTestRxCount==2 &&
+                          strcmp(MqttTestRxData,"period=60")==0 &&
+                          MqttTestBroker.Packets[MqttPubackPkt>>4]==Sent);
+    //An idle session pings once half the keep alive passed, and ends when the broker is gone
+    MqttTestNow+=pdMS_TO_TICKS(MqttKeepAlive*500UL);
+    Failed|=MqttTestCheck("keep alive",MqttPoll()==Gsmok && MqttTestBroker.Packets[MqttPingreqPkt>>4]==1);
+    MqttTestPing=0;
+    MqttTestNow+=pdMS_TO_TICKS(MqttKeepAlive*500UL);
+    Failed|=MqttTestCheck("no PINGRESP",MqttPoll()!=Gsmok && MqttTestBroker.Packets[MqttPingreqPkt>>4]==2);
+    //A session or subscription the broker refuses is not used
+    MqttTestReset();
+    MqttTestConnackCode=5;
+    Failed|=MqttTestCheck("CONNACK refused",MqttConnect()!=Gsmok &&
+                          MqttTestBroker.Packets[MqttSubscribePkt>>4]==0 &&
+                          MqttTestBroker.Closes==1 && MqttPublishEvent("boot")!=Gsmok);
+    MqttTestReset();
+    MqttTestGranted=0x80;
+    Failed|=MqttTestCheck("SUBACK failure",MqttConnect()!=Gsmok &&
+                          MqttTestBroker.Packets[MqttDisconnectPkt>>4]==1 && MqttTestBroker.Closes==1);
+    //Closing the transport ends the session
+    MqttTestReset();
+    Failed|=MqttTestCheck("disconnect",MqttTransport.Open()==Gsmok && MqttPublishEvent("boot")==Gsmok &&
+                          strcmp(MqttTestBroker.Topic,MqttEventTopic)==0 &&
+                          (MqttTransport.Close(),MqttTestBroker.Packets[MqttDisconnectPkt>>4]==1) &&
+                          MqttTestBroker.Closes==1 && MqttPoll()!=Gsmok);
+    Failed|=MqttTestCheck("well formed packets",MqttTestBroker.Bad==0);
+    printf("%s\n",Failed?"FAILED":"all passed");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTestCheck
+ * Description        : Print the result of a case.
+ * INPUTS             : const char *Name, uint8_t Passed
+ * RETURNS            : uint8_t 0 when the case passed, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t MqttTestCheck(const char *Name,uint8_t Passed)
+{
+    printf("%-28s %s\n",Name,Passed?"ok":"FAIL");
+    return !Passed;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTestReset
+ * Description        : Start a new broker that accepts everything and answers at once.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void MqttTestReset(void)
+{
+    memset(&MqttTestBroker,0,sizeof(MqttTestBroker));
+    MqttTestOutLen=0;
+    MqttTestChunk=MqttTestOutSize;
+    MqttTestConnackCode=0;
+    MqttTestGranted=1;
+    MqttTestDropPubacks=0;
+    MqttTestStrayPuback=0;
+    MqttTestPing=1;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTestQueue
+ * Description        : Send a packet from the broker to the client.
+ * INPUTS             : const uint8_t *Packet, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void MqttTestQueue(const uint8_t *Packet,uint32_t Size)
+{
+    if(MqttTestOutLen+Size<=MqttTestOutSize)
+    {
+        memcpy(&MqttTestOut[MqttTestOutLen],Packet,Size);
+        MqttTestOutLen+=Size;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTestDownlink
+ * Description        : Publish a message from the broker to the client.
+ * INPUTS             : const char *Topic, const char *Payload, uint8_t Qos (0 or 1)
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void MqttTestDownlink(const char *Topic,const char *Payload,uint8_t Qos)
+{
+    uint8_t  Packet[MqttTestOutSize];
+    uint32_t Size=2;
+    uint32_t Len=strlen(Topic);
+    Packet[0]=MqttPublishPkt|(Qos<<1);
+    Packet[Size++]=(uint8_t)(Len>>8);
+    Packet[Size++]=(uint8_t)Len;
+    memcpy(&Packet[Size],Topic,Len);
+    Size+=Len;
+    if(Qos!=0)
+    {
+        Packet[Size++]=(uint8_t)(MqttTestDownlinkId>>8);
+        Packet[Size++]=(uint8_t)MqttTestDownlinkId;
+    }
+    memcpy(&Packet[Size],Payload,strlen(Payload));
+    Size+=strlen(Payload);
+    Packet[1]=(uint8_t)(Size-2);
+    MqttTestQueue(Packet,Size);
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTestGetString
+ * Description        : Read a length prefixed MQTT string.
+ * INPUTS             : const uint8_t *Data, uint32_t Size (bytes left), char *Str
+ *                      (MqttTestTopicSize bytes)
+ * RETURNS            : uint32_t bytes read, 0 if the string does not fit
+ ***********************************************************************************************/
+static uint32_t MqttTestGetString(const uint8_t *Data,uint32_t Size,char *Str)
+{
+    uint32_t Len;
+    if(Size<2)
+    {
+        return 0;
+    }
+    Len=((uint32_t)Data[0]<<8)|Data[1];
+    if(Len+2>Size || Len>=MqttTestTopicSize)
+    {
+        return 0;
+    }
+    memcpy(Str,&Data[2],Len);
+    Str[Len]='\0';
+    return Len+2;
+}
+
+/***********************************************************************************************
+ * Function Name      : MqttTestMessage
+ * Description        : Message callback of the client.
+ * INPUTS             : const char *Topic, const uint8_t *Payload, uint32_t PayloadSize
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void MqttTestMessage(const char *Topic,const uint8_t *Payload,uint32_t PayloadSize)
+{
+    strncpy(MqttTestRxTopic,Topic,MqttTestTopicSize-1);
+    if(PayloadSize>=MqttTestDataSize)
+    {
+        PayloadSize=MqttTestDataSize-1;
+    }
+    memcpy(MqttTestRxData,Payload,PayloadSize);
+    MqttTestRxData[PayloadSize]='\0';
+    MqttTestRxCount++;
+}
+
+/*******************************************************************************
+ *                   Stand-ins of the module, the broker and the kernel        *
+ *******************************************************************************/
+
+/* The broker reads the packet the client sent and queues its answer */
+uint32_t Sim800SocketSend(const uint8_t *Data,uint32_t DataSize)
+{
+    static const uint8_t ConnectHead[]={0,4,'M','Q','T','T',4,0x02,MqttKeepAlive>>8,MqttKeepAlive&0xFF};
+    uint8_t  Answer[5];
+    uint32_t Offset=2;
+    uint32_t Len;
+    uint16_t Id=0;
+    char     ClientId[MqttTestTopicSize];
+    if(DataSize<2 || Data[1]!=DataSize-2)
+    {
+        MqttTestBroker.Bad++;
+        return Gsmok;
+    }
+    MqttTestBroker.Packets[Data[0]>>4]++;
+    switch(Data[0])
+    {
+    case MqttConnectPkt:
+        if(DataSize<2+sizeof(ConnectHead) || memcmp(&Data[2],ConnectHead,sizeof(ConnectHead))!=0 ||
+           MqttTestGetString(&Data[2+sizeof(ConnectHead)],DataSize-2-sizeof(ConnectHead),ClientId)!=
+           DataSize-2-sizeof(ConnectHead) || strcmp(ClientId,MqttClientId)!=0)
+        {
+            MqttTestBroker.Bad++;
+        }
+        Answer[0]=MqttConnackPkt;
+        Answer[1]=2;
+        Answer[2]=0;
+        Answer[3]=MqttTestConnackCode;
+        MqttTestQueue(Answer,4);
+        break;
+    case MqttSubscribePkt:
+        Id=(uint16_t)((Data[2]<<8)|Data[3]);
+        Len=MqttTestGetString(&Data[4],DataSize-4,MqttTestBroker.Topic);
+        if(Id==0 || Len==0 || 4+Len+1!=DataSize)
+        {
+            MqttTestBroker.Bad++;
+            break;
+        }
+        MqttTestBroker.Qos=Data[4+Len];
+        Answer[0]=MqttSubackPkt;
+        Answer[1]=3;
+        Answer[2]=Data[2];
+        Answer[3]=Data[3];
+        Answer[4]=MqttTestGranted;
+        MqttTestQueue(Answer,5);
+        break;
+    case MqttPublishPkt:
+    case MqttPublishPkt|0x02:
+        MqttTestBroker.Qos=(Data[0]>>1)&0x03;
+        Len=MqttTestGetString(&Data[Offset],DataSize-Offset,MqttTestBroker.Topic);
+        Offset+=Len;
+        if(MqttTestBroker.Qos!=0 && Len!=0 && Offset+2<=DataSize)
+        {
+            Id=(uint16_t)((Data[Offset]<<8)|Data[Offset+1]);
+            Offset+=2;
+        }
+        if(Len==0 || (MqttTestBroker.Qos!=0 && Id==0) || DataSize-Offset>MqttTestDataSize)
+        {
+            MqttTestBroker.Bad++;
+            break;
+        }
+        MqttTestBroker.DataSize=DataSize-Offset;
+        memcpy(MqttTestBroker.Data,&Data[Offset],MqttTestBroker.DataSize);
+        if(MqttTestBroker.Qos==0 || MqttTestDropPubacks)
+        {
+            break;
+        }
+        Answer[0]=MqttPubackPkt;
+        Answer[1]=2;
+        if(MqttTestStrayPuback)
+        {
+            Answer[2]=(uint8_t)((Id+1)>>8);
+            Answer[3]=(uint8_t)(Id+1);
+            MqttTestQueue(Answer,4);
+        }
+        Answer[2]=(uint8_t)(Id>>8);
+        Answer[3]=(uint8_t)Id;
+        MqttTestQueue(Answer,4);
+        break;
+    case MqttPubackPkt:
+        if(DataSize!=4)
+        {
+            MqttTestBroker.Bad++;
+            break;
+        }
+        MqttTestBroker.PubackId=(uint16_t)((Data[2]<<8)|Data[3]);
+        break;
+    case MqttPingreqPkt:
+        if(MqttTestPing)
+        {
+            Answer[0]=MqttPingrespPkt;
+            Answer[1]=0;
+            MqttTestQueue(Answer,2);
+        }
+        break;
+    case MqttDisconnectPkt:
+        break;
+    default:
+        MqttTestBroker.Bad++;
+        break;
+    }
+    return Gsmok;
+}
+
+/* The bytes the broker sent, at most MqttTestChunk at a time */
+uint32_t Sim800SocketReceive(uint8_t *Data,uint32_t MaxSize,uint32_t *Received)
+{
+    uint32_t Size=MqttTestOutLen;
+    if(Size>MaxSize)
+    {
+        Size=MaxSize;
+    }
+    if(Size>MqttTestChunk)
+    {
+        Size=MqttTestChunk;
+    }
+    memcpy(Data,MqttTestOut,Size);
+    MqttTestOutLen-=Size;
+    memmove(MqttTestOut,&MqttTestOut[Size],MqttTestOutLen);
+    *Received=Size;
+    return Gsmok;
+}
+
+void Sim800SocketClose(void)
+{
+    MqttTestBroker.Closes++;
+}
+
+uint32_t DnsSocketOpen(const char *Mode,const char *Host,uint16_t Port)
+{
+    MqttTestBroker.Opens++;
+    MqttTestOutLen=0;
+    if(strcmp(Mode,"TCP")!=0 || Port!=MqttBrokerPort)
+    {
+        MqttTestBroker.Bad++;
+    }
+    return Gsmok;
+}
+
+/* The broker only reads the sequence number of the position record */
+uint32_t TransportBuildFrame(uint8_t *Frame,const Report_t *Report)
+{
+    memset(Frame,0,TransportFrameSize);
+    Frame[0]=TransportFrameStart;
+    Frame[1]=TransportFramePosition;
+    Frame[2]=TransportFrameSize-4;
+    Frame[3]=(uint8_t)Report->Seq;
+    return TransportFrameSize;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return MqttTestNow;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    MqttTestNow+=xTicksToDelay;
+}
+
+#endif /* MqttHostBuild */
@@ -0,0 +1,348 @@
+/******************************************************************************
+ * File Name: record.c
+ *
+ * Description: Source file for the compact binary position record. A batch
+ *              starts with the absolute values of its first fix and every
+ *              record is a delta of the one before it:
+ *
+ *              batch  : 'R' | count | seq | time (u32 LE) | lat | lon | records
+ *              record : head | [seq delta] | [time (u32 LE)] | dlat | dlon |
+ *                       dspeed | dheading
+ *              head   : seconds since the previous record << 3 | flags
+ *
+ *              Every other number is a LEB128 varint, the signed ones zig-zag
+ *              mapped so small steps either way take a single byte. The file
+ *              has no target dependency, the same decoder builds on the host
+ *              that reads the batches.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "record.h"
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define RecordZigZag(V)     (((uint32_t)(V)<<1)^(uint32_t)((int32_t)(V)>>31))
+#define RecordUnZigZag(V)   ((int32_t)((V)>>1)^-(int32_t)((V)&1))
+/* Heading step and the number of steps in a turn */
+#define RecordHeadingStep   2
+#define RecordHeadings      (360/RecordHeadingStep)
+/* The packed form keeps the flags above the 9 bits of the course */
+#define RecordPackedCourse  0x01FF
+#define RecordPackedFlags   12
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t RecordPutVarint(uint8_t *Buf,uint32_t Value);
+static uint32_t RecordGetVarint(const uint8_t *Buf,uint32_t Size,uint32_t *Value);
+static void RecordPutU32(uint8_t *Buf,uint32_t Value);
+static uint32_t RecordGetU32(const uint8_t *Buf);
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : RecordEncoderInit
+ * Description        : Start an empty batch in a buffer.
+ * INPUTS             : RecordEncoder_t *Enc, uint8_t *Buf, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+void RecordEncoderInit(RecordEncoder_t *Enc,uint8_t *Buf,uint32_t Size)
+{
+    Enc->Buf=Buf;
+    Enc->Size=Size;
+    Enc->Len=0;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordEncode
+ * Description        : Append a record to the batch. The first record also writes the header with
+ *                      its absolute values, so its own deltas are zero. Nothing is written when
+ *                      the record does not fit.
+ * INPUTS             : RecordEncoder_t *Enc, const Record_t *Record
+ * RETURNS            : uint8_t 1 if the record was appended
+ ***********************************************************************************************/
+uint8_t RecordEncode(RecordEncoder_t *Enc,const Record_t *Record)
+{
+    uint8_t Out[RecordHeaderMax+RecordMaxSize];
+    uint32_t Len=0;
+    uint32_t Head;
+    int32_t Heading;
+    if(Enc->Len==0)
+    {
+        Out[Len++]=RecordBatchType;
+        Out[Len++]=0;
+        Len+=RecordPutVarint(&Out[Len],Record->Seq);
+        RecordPutU32(&Out[Len],Record->Time);
+        Len+=4;
+        Len+=RecordPutVarint(&Out[Len],RecordZigZag(Record->Lat));
+        Len+=RecordPutVarint(&Out[Len],RecordZigZag(Record->Lon));
+        Enc->Prev=*Record;
+        Enc->Prev.Seq=Record->Seq-1;
+        Enc->Prev.Speed=0;
+        Enc->Prev.Course=0;
+    }
+    else if(Enc->Buf[1]==RecordBatchMax)
+    {
+        return 0;
+    }
+    Head=Record->Flags&RecordFlagPriority;
+    if(Record->Seq!=Enc->Prev.Seq+1)
+    {
+        Head|=RecordFlagSeqGap;
+    }
+    // The clock went back, became known or jumped further than the head varint holds
+    if(Record->Time<Enc->Prev.Time || (Enc->Prev.Time==0 && Record->Time!=0) ||
+       Record->Time-Enc->Prev.Time>RecordTimeDeltaMax)
+    {
+        Head|=RecordFlagTimeAbs;
+    }
+    else
+    {
+        Head|=(Record->Time-Enc->Prev.Time)<<RecordFlagBits;
+    }
+    Len+=RecordPutVarint(&Out[Len],Head);
+    if(Head&RecordFlagSeqGap)
+    {
+        Len+=RecordPutVarint(&Out[Len],RecordZigZag(Record->Seq-Enc->Prev.Seq));
+    }
+    if(Head&RecordFlagTimeAbs)
+    {
+        RecordPutU32(&Out[Len],Record->Time);
+        Len+=4;
+    }
+    Len+=RecordPutVarint(&Out[Len],RecordZigZag(Record->Lat-Enc->Prev.Lat));
+    Len+=RecordPutVarint(&Out[Len],RecordZigZag(Record->Lon-Enc->Prev.Lon));
+    Len+=RecordPutVarint(&Out[Len],RecordZigZag((int32_t)Record->Speed-(int32_t)Enc->Prev.Speed));
+    // The shorter way round: a turn from 358 to 2 degrees is +2 steps, not -178
+    Heading=(int32_t)((Record->Course%360)/RecordHeadingStep)-(int32_t)(Enc->Prev.Course/RecordHeadingStep);
+    if(Heading>=RecordHeadings/2)
+    {
+        Heading-=RecordHeadings;
+    }
+    else if(Heading<-RecordHeadings/2)
+    {
+        Heading+=RecordHeadings;
+    }
+    Len+=RecordPutVarint(&Out[Len],RecordZigZag(Heading));
+    if(Enc->Len+Len>Enc->Size)
+    {
+        return 0;
+    }
+    memcpy(&Enc->Buf[Enc->Len],Out,Len);
+    Enc->Len+=Len;
+    Enc->Buf[1]++;
+    Enc->Prev=*Record;
+    // The next delta starts from the heading the decoder sees
+    Enc->Prev.Course=(uint16_t)(((Record->Course%360)/RecordHeadingStep)*RecordHeadingStep);
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordDecode
+ * Description        : Read the records of a batch back. All flags are returned in Flags and the
+ *                      course is rounded down to the 2 degree step.
+ * INPUTS             : const uint8_t *Buf, uint32_t Size, Record_t *Records, uint32_t MaxRecords
+ * RETURNS            : uint32_t number of records decoded, 0 for a malformed batch
+ ***********************************************************************************************/
+uint32_t RecordDecode(const uint8_t *Buf,uint32_t Size,Record_t *Records,uint32_t MaxRecords)
+{
+    Record_t Prev;
+    uint32_t Count,Index,Value,Used;
+    uint32_t Pos=2;
+    if(Size<2 || Buf[0]!=RecordBatchType)
+    {
+        return 0;
+    }
+    Count=Buf[1];
+    if(Count>MaxRecords)
+    {
+        return 0;
+    }
+    memset(&Prev,0,sizeof(Prev));
+    if((Used=RecordGetVarint(&Buf[Pos],Size-Pos,&Value))==0)
+    {
+        return 0;
+    }
+    Pos+=Used;
+    Prev.Seq=Value-1;
+    if(Pos+4>Size)
+    {
+        return 0;
+    }
+    Prev.Time=RecordGetU32(&Buf[Pos]);
+    Pos+=4;
+    if((Used=RecordGetVarint(&Buf[Pos],Size-Pos,&Value))==0)
+    {
+        return 0;
+    }
+    Pos+=Used;
+    Prev.Lat=RecordUnZigZag(Value);
+    if((Used=RecordGetVarint(&Buf[Pos],Size-Pos,&Value))==0)
+    {
+        return 0;
+    }
+    Pos+=Used;
+    Prev.Lon=RecordUnZigZag(Value);
+    for(Index=0;Index<Count;Index++)
+    {
+        Record_t *Record=&Records[Index];
+        uint32_t Fields[5];
+        uint32_t Head;
+        uint8_t Field;
+        if((Used=RecordGetVarint(&Buf[Pos],Size-Pos,&Head))==0)
+        {
+            return 0;
+        }
+        Pos+=Used;
+        Record->Flags=(uint8_t)(Head&((1<<RecordFlagBits)-1));
+        Record->Seq=Prev.Seq+1;
+        Record->Time=Prev.Time+(Head>>RecordFlagBits);
+        if(Head&RecordFlagSeqGap)
+        {
+            if((Used=RecordGetVarint(&Buf[Pos],Size-Pos,&Value))==0)
+            {
+                return 0;
+            }
+            Pos+=Used;
+            Record->Seq=Prev.Seq+(uint32_t)RecordUnZigZag(Value);
+        }
+        if(Head&RecordFlagTimeAbs)
+        {
+            if(Pos+4>Size)
+            {
+                return 0;
+            }
+            Record->Time=RecordGetU32(&Buf[Pos]);
+            Pos+=4;
+        }
+        // Lat, lon, speed and heading deltas
+        for(Field=0;Field<4;Field++)
+        {
+            if((Used=RecordGetVarint(&Buf[Pos],Size-Pos,&Fields[Field]))==0)
+            {
+                return 0;
+            }
+            Pos+=Used;
+        }
+        Record->Lat=Prev.Lat+RecordUnZigZag(Fields[0]);
+        Record->Lon=Prev.Lon+RecordUnZigZag(Fields[1]);
+        Record->Speed=(uint16_t)(Prev.Speed+RecordUnZigZag(Fields[2]));
+        Fields[4]=(uint32_t)((int32_t)(Prev.Course/RecordHeadingStep)+RecordUnZigZag(Fields[3])+RecordHeadings)%RecordHeadings;
+        Record->Course=(uint16_t)(Fields[4]*RecordHeadingStep);
+        Prev=*Record;
+    }
+    return Count;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordPack
+ * Description        : Store a record in its fixed size form, every field little endian and the
+ *                      course sharing its 16 bits with the flags. Used where records must be found
+ *                      again one by one, like the slots of the flash log.
+ * INPUTS             : const Record_t *Record, uint8_t *Buf (RecordPackedSize bytes)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void RecordPack(const Record_t *Record,uint8_t *Buf)
+{
+    uint16_t Course=(uint16_t)((Record->Course&RecordPackedCourse)|(Record->Flags<<RecordPackedFlags));
+    RecordPutU32(&Buf[0],Record->Seq);
+    RecordPutU32(&Buf[4],Record->Time);
+    RecordPutU32(&Buf[8],(uint32_t)Record->Lat);
+    RecordPutU32(&Buf[12],(uint32_t)Record->Lon);
+    Buf[16]=(uint8_t)Record->Speed;
+    Buf[17]=(uint8_t)(Record->Speed>>8);
+    Buf[18]=(uint8_t)Course;
+    Buf[19]=(uint8_t)(Course>>8);
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordUnpack
+ * Description        : Load a record stored by RecordPack.
+ * INPUTS             : const uint8_t *Buf (RecordPackedSize bytes), Record_t *Record
+ * RETURNS            : void
+ ***********************************************************************************************/
+void RecordUnpack(const uint8_t *Buf,Record_t *Record)
+{
+    uint16_t Course=(uint16_t)(Buf[18]|(Buf[19]<<8));
+    Record->Seq=RecordGetU32(&Buf[0]);
+    Record->Time=RecordGetU32(&Buf[4]);
+    Record->Lat=(int32_t)RecordGetU32(&Buf[8]);
+    Record->Lon=(int32_t)RecordGetU32(&Buf[12]);
+    Record->Speed=(uint16_t)(Buf[16]|(Buf[17]<<8));
+    Record->Course=Course&RecordPackedCourse;
+    Record->Flags=(uint8_t)(Course>>RecordPackedFlags);
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordPutVarint
+ * Description        : Write a LEB128 varint, 7 bits per byte, least significant group first.
+ * INPUTS             : uint8_t *Buf (at least 5 bytes), uint32_t Value
+ * RETURNS            : uint32_t bytes written
+ ***********************************************************************************************/
+static uint32_t RecordPutVarint(uint8_t *Buf,uint32_t Value)
+{
+    uint32_t Len=0;
+    while(Value>=0x80)
+    {
+        Buf[Len++]=(uint8_t)(Value|0x80);
+        Value>>=7;
+    }
+    Buf[Len++]=(uint8_t)Value;
+    return Len;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordGetVarint
+ * Description        : Read a LEB128 varint.
+ * INPUTS             : const uint8_t *Buf, uint32_t Size (bytes left), uint32_t *Value
+ * RETURNS            : uint32_t bytes read, 0 when the varint is cut or longer than 32 bits
+ ***********************************************************************************************/
+static uint32_t RecordGetVarint(const uint8_t *Buf,uint32_t Size,uint32_t *Value)
+{
+    uint32_t Len=0;
+    *Value=0;
+    while(Len<Size && Len<5)
+    {
+        *Value|=(uint32_t)(Buf[Len]&0x7F)<<(7*Len);
+        if((Buf[Len++]&0x80)==0)
+        {
+            return Len;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordPutU32
+ * Description        : Store a 32 bit value little endian.
+ * INPUTS             : uint8_t *Buf, uint32_t Value
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void RecordPutU32(uint8_t *Buf,uint32_t Value)
+{
+    Buf[0]=(uint8_t)Value;
+    Buf[1]=(uint8_t)(Value>>8);
+    Buf[2]=(uint8_t)(Value>>16);
+    Buf[3]=(uint8_t)(Value>>24);
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordGetU32
+ * Description        : Load a 32 bit little endian value.
+ * INPUTS             : const uint8_t *Buf
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t RecordGetU32(const uint8_t *Buf)
+{
+    return (uint32_t)Buf[0]|((uint32_t)Buf[1]<<8)|((uint32_t)Buf[2]<<16)|((uint32_t)Buf[3]<<24);
+}
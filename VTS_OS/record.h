@@ -0,0 +1,67 @@
+/******************************************************************************
+ * File Name: record.h
+ *
+ * Description: Header file for the compact binary position record.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_RECORD_H_
+#define SRC_RECORD_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* First byte of a batch */
+#define RecordBatchType     'R'
+/* Largest encoded record: head, seq gap, absolute time, lat, lon, speed and heading */
+#define RecordMaxSize       32
+/* Type, count, base seq, base time, base lat and lon */
+#define RecordHeaderMax     21
+/* Most records in a batch, the count is a single byte */
+#define RecordBatchMax      255
+/* Fixed size form kept in the flash log: seq, time, lat, lon, speed and flags with the course */
+#define RecordPackedSize    20
+
+/* Record flags, kept in the low bits of the head varint */
+#define RecordFlagPriority  0x01     /* Taken during a U-turn or a curve */
+#define RecordFlagSeqGap    0x02     /* Seq does not follow the previous one, its delta follows */
+#define RecordFlagTimeAbs   0x04     /* The clock went back, became known or jumped, the absolute time follows */
+#define RecordFlagBits      3
+/* Largest time delta kept in the head varint, a larger one goes as RecordFlagTimeAbs */
+#define RecordTimeDeltaMax  (0xFFFFFFFFU>>RecordFlagBits)
+
+typedef struct{
+    uint32_t Seq;
+    uint32_t Time;           /* UTC Unix time, 0 if not known */
+    int32_t  Lat;            /* Micro degrees */
+    int32_t  Lon;
+    uint16_t Speed;          /* km/h */
+    uint16_t Course;         /* Degrees, sent in 2 degree steps */
+    uint8_t  Flags;          /* RecordFlagPriority as input, all flags after decoding */
+}Record_t;
+
+typedef struct{
+    uint8_t  *Buf;
+    uint32_t  Size;
+    uint32_t  Len;           /* Bytes written so far */
+    Record_t  Prev;          /* Record the next one is a delta of */
+}RecordEncoder_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+void RecordEncoderInit(RecordEncoder_t *Enc,uint8_t *Buf,uint32_t Size);
+uint8_t RecordEncode(RecordEncoder_t *Enc,const Record_t *Record);
+uint32_t RecordDecode(const uint8_t *Buf,uint32_t Size,Record_t *Records,uint32_t MaxRecords);
+void RecordPack(const Record_t *Record,uint8_t *Buf);
+void RecordUnpack(const uint8_t *Buf,Record_t *Record);
+
+#endif /* SRC_RECORD_H_ */
@@ -0,0 +1,226 @@
+/******************************************************************************
+ * File Name: recordtest.c
+ *
+ * Description: Host round trip test of the compact record batches. Each case
+ *              encodes a list of records, decodes the batch back and compares
+ *              every field: a steady drive, a clock that becomes known after
+ *              records without a time, gaps in time of 2^29 s and more, a clock
+ *              that goes back, sequence gaps, negative coordinates, headings
+ *              crossing north, and full batches and buffers. Builds with
+ *              RecordHostBuild defined only, with record.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(RecordHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "record.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define RecordTestMax       RecordBatchMax
+#define RecordTestBufSize   (RecordHeaderMax+RecordBatchMax*RecordMaxSize)
+/* Headings are sent in 2 degree steps */
+#define RecordTestStep      2
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t RecordTestRun(const char *Name,const Record_t *Records,uint32_t Count);
+static uint8_t RecordTestLimits(void);
+static void RecordTestFill(Record_t *Record,uint32_t Seq,uint32_t Time,int32_t Lat,int32_t Lon);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static Record_t RecordTestIn[RecordTestMax];
+static Record_t RecordTestOut[RecordTestMax];
+static uint8_t  RecordTestBuf[RecordTestBufSize];
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Run every case and print its result.
+ * INPUTS             : void
+ * RETURNS            : int 0, 1 if a case failed
+ ***********************************************************************************************/
+int main(void)
+{
+    uint32_t Index;
+    uint8_t  Failed=0;
+    //A steady drive north east at 1 Hz
+    for(Index=0;Index<RecordTestMax;Index++)
+    {
+        RecordTestFill(&RecordTestIn[Index],1000+Index,1692000000+Index,30044000+Index*90,31235000+Index*70);
+        RecordTestIn[Index].Speed=(uint16_t)(40+Index%20);
+        RecordTestIn[Index].Course=(uint16_t)((Index*3)%360);
+        RecordTestIn[Index].Flags=(uint8_t)((Index%17==0)?RecordFlagPriority:0);
+    }
+    Failed|=RecordTestRun("steady drive",RecordTestIn,RecordTestMax);
+    //No time before the first fix, then the UTC time
+    RecordTestFill(&RecordTestIn[0],1,0,30044000,31235000);
+    RecordTestFill(&RecordTestIn[1],2,0,30044100,31235100);
+    RecordTestFill(&RecordTestIn[2],3,1692000000,30044200,31235200);
+    RecordTestFill(&RecordTestIn[3],4,1692000005,30044300,31235300);
+    Failed|=RecordTestRun("unknown then valid time",RecordTestIn,4);
+    //A valid time first, then records without a time
+    RecordTestFill(&RecordTestIn[0],1,1692000000,30044000,31235000);
+    RecordTestFill(&RecordTestIn[1],2,0,30044100,31235100);
+    RecordTestFill(&RecordTestIn[2],3,1692000010,30044200,31235200);
+    Failed|=RecordTestRun("valid then unknown time",RecordTestIn,3);
+    //Gaps around the largest delta the head varint holds
+    RecordTestFill(&RecordTestIn[0],1,1,0,0);
+    RecordTestFill(&RecordTestIn[1],2,1+RecordTimeDeltaMax,0,0);
+    RecordTestFill(&RecordTestIn[2],3,2+2*RecordTimeDeltaMax,0,0);
+    RecordTestFill(&RecordTestIn[3],4,0xFFFFFFFFU,0,0);
+    RecordTestFill(&RecordTestIn[4],5,0xFFFFFFFFU,0,0);
+    Failed|=RecordTestRun("large time gaps",RecordTestIn,5);
+    RecordTestFill(&RecordTestIn[0],1,1692000000,0,0);
+    RecordTestFill(&RecordTestIn[1],2,1692000000+(1U<<29),0,0);
+    RecordTestFill(&RecordTestIn[2],3,1692000000+(1U<<29)+(1U<<30),0,0);
+    Failed|=RecordTestRun("2^29 s gaps",RecordTestIn,3);
+    //The clock is set back by the network time
+    RecordTestFill(&RecordTestIn[0],1,1692000100,0,0);
+    RecordTestFill(&RecordTestIn[1],2,1692000000,0,0);
+    RecordTestFill(&RecordTestIn[2],3,1692000001,0,0);
+    Failed|=RecordTestRun("clock back",RecordTestIn,3);
+    //Sequence gaps both ways, to the ends of the coordinates and headings across north
+    RecordTestFill(&RecordTestIn[0],0xFFFFFFF0U,1692000000,-90000000,-180000000);
+    RecordTestFill(&RecordTestIn[1],5,1692000001,90000000,180000000);
+    RecordTestFill(&RecordTestIn[2],3,1692000002,-33868820,151209296);
+    RecordTestFill(&RecordTestIn[3],0x80000003U,1692000003,-33868830,-151209296);
+    for(Index=0;Index<4;Index++)
+    {
+        RecordTestIn[Index].Course=(uint16_t)((Index&1)?2:358);
+        RecordTestIn[Index].Speed=(uint16_t)((Index&1)?0:250);
+    }
+    Failed|=RecordTestRun("seq gaps and ends",RecordTestIn,4);
+    Failed|=RecordTestLimits();
+    printf("%s\n",Failed?"FAILED":"all passed");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordTestRun
+ * Description        : Encode records into one batch, decode it and compare them field by field.
+ *                      The heading comes back in RecordTestStep degree steps.
+ * INPUTS             : const char *Name, const Record_t *Records, uint32_t Count
+ * RETURNS            : uint8_t 0 when the records came back, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t RecordTestRun(const char *Name,const Record_t *Records,uint32_t Count)
+{
+    RecordEncoder_t Enc;
+    uint32_t Index;
+    uint32_t Decoded;
+    RecordEncoderInit(&Enc,RecordTestBuf,sizeof(RecordTestBuf));
+    for(Index=0;Index<Count;Index++)
+    {
+        if(!RecordEncode(&Enc,&Records[Index]))
+        {
+            printf("%-26s FAIL record %u not encoded\n",Name,(unsigned)Index);
+            return 1;
+        }
+    }
+    Decoded=RecordDecode(RecordTestBuf,Enc.Len,RecordTestOut,RecordTestMax);
+    if(Decoded!=Count)
+    {
+        printf("%-26s FAIL %u of %u records decoded\n",Name,(unsigned)Decoded,(unsigned)Count);
+        return 1;
+    }
+    for(Index=0;Index<Count;Index++)
+    {
+        const Record_t *In=&Records[Index];
+        const Record_t *Out=&RecordTestOut[Index];
+        if(Out->Seq!=In->Seq || Out->Time!=In->Time || Out->Lat!=In->Lat || Out->Lon!=In->Lon ||
+           Out->Speed!=In->Speed || Out->Course!=((In->Course%360)/RecordTestStep)*RecordTestStep ||
+           (Out->Flags&RecordFlagPriority)!=(In->Flags&RecordFlagPriority))
+        {
+            printf("%-26s FAIL record %u: seq %u/%u time %u/%u lat %d/%d lon %d/%d speed %u/%u course %u/%u\n",
+                   Name,(unsigned)Index,(unsigned)In->Seq,(unsigned)Out->Seq,(unsigned)In->Time,(unsigned)Out->Time,
+                   (int)In->Lat,(int)Out->Lat,(int)In->Lon,(int)Out->Lon,(unsigned)In->Speed,(unsigned)Out->Speed,
+                   (unsigned)In->Course,(unsigned)Out->Course);
+            return 1;
+        }
+    }
+    printf("%-26s ok %u records in %u bytes\n",Name,(unsigned)Count,(unsigned)Enc.Len);
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordTestLimits
+ * Description        : A batch takes RecordBatchMax records, an encoder refuses a record that does
+ *                      not fit its buffer, and a cut batch does not decode.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 0 when the limits hold, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t RecordTestLimits(void)
+{
+    RecordEncoder_t Enc;
+    Record_t Record;
+    uint32_t Index;
+    RecordTestFill(&Record,1,1692000000,0,0);
+    RecordEncoderInit(&Enc,RecordTestBuf,sizeof(RecordTestBuf));
+    for(Index=0;Index<RecordBatchMax;Index++)
+    {
+        Record.Seq++;
+        if(!RecordEncode(&Enc,&Record))
+        {
+            printf("%-26s FAIL record %u refused\n","limits",(unsigned)Index);
+            return 1;
+        }
+    }
+    if(RecordEncode(&Enc,&Record))
+    {
+        printf("%-26s FAIL record past RecordBatchMax taken\n","limits");
+        return 1;
+    }
+    if(RecordDecode(RecordTestBuf,Enc.Len-1,RecordTestOut,RecordTestMax)!=0)
+    {
+        printf("%-26s FAIL cut batch decoded\n","limits");
+        return 1;
+    }
+    RecordEncoderInit(&Enc,RecordTestBuf,RecordHeaderMax);
+    if(!RecordEncode(&Enc,&Record))
+    {
+        printf("%-26s FAIL first record refused\n","limits");
+        return 1;
+    }
+    Index=Enc.Len;
+    Record.Seq+=1000;
+    Record.Lat=-89999999;
+    if(RecordEncode(&Enc,&Record) || Enc.Len!=Index)
+    {
+        printf("%-26s FAIL record past the buffer taken\n","limits");
+        return 1;
+    }
+    printf("%-26s ok\n","limits");
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordTestFill
+ * Description        : Set a record with no speed, heading or flags.
+ * INPUTS             : Record_t *Record, uint32_t Seq, uint32_t Time, int32_t Lat, int32_t Lon
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void RecordTestFill(Record_t *Record,uint32_t Seq,uint32_t Time,int32_t Lat,int32_t Lon)
+{
+    memset(Record,0,sizeof(*Record));
+    Record->Seq=Seq;
+    Record->Time=Time;
+    Record->Lat=Lat;
+    Record->Lon=Lon;
+}
+
+#endif /* RecordHostBuild */
@@ -0,0 +1,351 @@
+/******************************************************************************
+ * File Name: report.c
+ *
+ * Description: Source file for the pending position report queue. Every fix
+ *              that is due for upload gets a monotonic sequence number and
+ *              stays queued until the server confirms it with a 2xx status.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "report.h"
+#include "timesvc.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Ring of pending reports, oldest at ReportHead */
+static Report_t      ReportQueue[ReportQueueSize];
+static uint8_t       ReportHead=0;
+static uint8_t       ReportCount=0;
+/* Sequence number given to the next report */
+static uint32_t      ReportNextSeq=1;
+static ReportStats_t ReportStats;
+/* Set while a transport sends queued reports, they must not be dropped from under it */
+static volatile uint8_t ReportSending=0;
+/* Keeps a report that ran out of retries, returns 0 when it could not */
+static uint8_t (*ReportStore)(const Report_t *Report)=NULL;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static void ReportQueueDrop(void);
+static uint32_t ReportQueueFind(uint32_t Seq);
+static void ReportQueueRemove(uint32_t Index);
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueInit
+ * Description        : Empty the pending queue and reset the delivery statistics.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void ReportQueueInit(void)
+{
+    ReportHead=0;
+    ReportCount=0;
+    memset(&ReportStats,0,sizeof(ReportStats));
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportSetNextSeq
+ * Description        : Continue the sequence numbers of a previous run, restored from the metadata
+ *                      store, so the server never sees a sequence number twice.
+ * INPUTS             : uint32_t Seq, the sequence number the next report gets
+ * RETURNS            : void
+ ***********************************************************************************************/
+void ReportSetNextSeq(uint32_t Seq)
+{
+    if(Seq!=0){
+        ReportNextSeq=Seq;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueuePush
+ * Description        : Queue a new report with the next sequence number. When the queue is full
+ *                      the oldest report is dropped to make room for the new one, unless a
+ *                      transport is sending the queued reports: the oldest may be on its way and
+ *                      its ack would then remove another report, the new one is dropped instead.
+ * INPUTS             : const char *Lon, const char *Lat, uint16_t Speed (km/h),
+ *                      uint16_t Course (degrees), uint8_t Priority
+ * RETURNS            : Report_t* the queued report, NULL if it was dropped
+ ***********************************************************************************************/
+Report_t *ReportQueuePush(const char *Lon, const char *Lat, uint16_t Speed, uint16_t Course, uint8_t Priority)
+{
+    Report_t *Report;
+    taskENTER_CRITICAL();
+    if(ReportCount==ReportQueueSize){
+        if(ReportSending){
+            ReportStats.Dropped++;
+            taskEXIT_CRITICAL();
+            return NULL;
+        }
+        ReportQueueDrop();
+    }
+    Report=&ReportQueue[(ReportHead+ReportCount)%ReportQueueSize];
+    Report->Seq=ReportNextSeq++;
+    Report->Retries=0;
+    Report->Priority=Priority;
+    Report->Speed=Speed;
+    Report->Course=Course;
+    Report->Tick=xTaskGetTickCount();
+    Report->Time=TimeNow();
+    Report->SentTick=0;
+    Report->Acked=0;
+    strncpy(Report->Longitude,Lon,sizeof(Report->Longitude)-1);
+    Report->Longitude[sizeof(Report->Longitude)-1]='\0';
+    strncpy(Report->Latitude,Lat,sizeof(Report->Latitude)-1);
+    Report->Latitude[sizeof(Report->Latitude)-1]='\0';
+    ReportCount++;
+    ReportStats.Queued++;
+    taskEXIT_CRITICAL();
+    return Report;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueuePeek
+ * Description        : Get the oldest pending report without removing it.
+ * INPUTS             : void
+ * RETURNS            : Report_t* or NULL if nothing is pending
+ ***********************************************************************************************/
+Report_t *ReportQueuePeek(void)
+{
+    if(ReportCount==0){
+        return NULL;
+    }
+    return &ReportQueue[ReportHead];
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueuePeekAt
+ * Description        : Get a pending report without removing it, 0 being the oldest.
+ * INPUTS             : uint32_t Index
+ * RETURNS            : Report_t* or NULL if fewer reports are pending
+ ***********************************************************************************************/
+Report_t *ReportQueuePeekAt(uint32_t Index)
+{
+    if(Index>=ReportCount){
+        return NULL;
+    }
+    return &ReportQueue[(ReportHead+Index)%ReportQueueSize];
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportBatchReady
+ * Description        : Decide if the pending reports are worth a batch upload: enough of them are
+ *                      queued, the oldest one waited too long or one of them has priority.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 if a batch should be sent now
+ ***********************************************************************************************/
+uint8_t ReportBatchReady(void)
+{
+    uint32_t Index;
+    if(ReportCount==0){
+        return 0;
+    }
+    if(ReportCount>=ReportBatchSize){
+        return 1;
+    }
+    if((xTaskGetTickCount()-ReportQueue[ReportHead].Tick)>=pdMS_TO_TICKS(ReportBatchMaxAge)){
+        return 1;
+    }
+    for(Index=0;Index<ReportCount;Index++){
+        if(ReportQueue[(ReportHead+Index)%ReportQueueSize].Priority){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueAck
+ * Description        : The oldest report was confirmed by the server, remove it from the queue.
+ * INPUTS             : uint16_t HttpStatus
+ * RETURNS            : void
+ ***********************************************************************************************/
+void ReportQueueAck(uint16_t HttpStatus)
+{
+    taskENTER_CRITICAL();
+    if(ReportCount!=0){
+        ReportHead=(ReportHead+1)%ReportQueueSize;
+        ReportCount--;
+        ReportStats.Delivered++;
+    }
+    ReportStats.LastHttpStatus=HttpStatus;
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueNack
+ * Description        : An upload of the report with sequence number Seq failed. It stays queued
+ *                      for the next window until it runs out of retries, then it is handed to the
+ *                      store set with ReportSetStoreCallBack, or dropped when there is none. A
+ *                      report the store could not take stays queued and is handed over again on
+ *                      its next failure.
+ * INPUTS             : uint32_t Seq, uint16_t HttpStatus, 0 when no +HTTPACTION URC was received
+ * RETURNS            : void
+ ***********************************************************************************************/
+void ReportQueueNack(uint32_t Seq, uint16_t HttpStatus)
+{
+    Report_t Expired;
+    uint8_t  Store=0;
+    uint32_t Index;
+    taskENTER_CRITICAL();
+    ReportStats.Failed++;
+    ReportStats.LastHttpStatus=HttpStatus;
+    Index=ReportQueueFind(Seq);
+    if(Index<ReportCount){
+        ReportQueue[(ReportHead+Index)%ReportQueueSize].Retries++;
+        if(ReportQueue[(ReportHead+Index)%ReportQueueSize].Retries>=ReportMaxRetries){
+            if(ReportStore!=NULL){
+                Expired=ReportQueue[(ReportHead+Index)%ReportQueueSize];
+                Store=1;
+            }else{
+                ReportQueueRemove(Index);
+                ReportStats.Dropped++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+    //The store writes flash with the queue unlocked, only the sender removes the report meanwhile
+    if(Store && ReportStore(&Expired)){
+        taskENTER_CRITICAL();
+        Index=ReportQueueFind(Seq);
+        if(Index<ReportCount){
+            ReportQueueRemove(Index);
+            ReportStats.Stored++;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportSetStoreCallBack
+ * Description        : Set the function that keeps the reports which ran out of retries.
+ * INPUTS             : uint8_t (*Store)(const Report_t *Report), returns 0 when it could not
+ * RETURNS            : void
+ ***********************************************************************************************/
+void ReportSetStoreCallBack(uint8_t (*Store)(const Report_t *Report))
+{
+    ReportStore=Store;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueSetSending
+ * Description        : A transport starts or ends sending queued reports. Until it ends, the queue
+ *                      keeps the reports it holds and only the sender removes them.
+ * INPUTS             : uint8_t Sending
+ * RETURNS            : void
+ ***********************************************************************************************/
+void ReportQueueSetSending(uint8_t Sending)
+{
+    ReportSending=Sending;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueIsSending
+ * Description        : Tell if a transport is sending queued reports.
+ * INPUTS             : void
+ * RETURNS            : uint8_t
+ ***********************************************************************************************/
+uint8_t ReportQueueIsSending(void)
+{
+    return ReportSending;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueStored
+ * Description        : The oldest report was written to the flash log, remove it from the queue.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void ReportQueueStored(void)
+{
+    taskENTER_CRITICAL();
+    if(ReportCount!=0){
+        ReportHead=(ReportHead+1)%ReportQueueSize;
+        ReportCount--;
+        ReportStats.Stored++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueCount
+ * Description        : Number of reports waiting for delivery.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t ReportQueueCount(void)
+{
+    return ReportCount;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportGetStats
+ * Description        : Delivery accounting since ReportQueueInit.
+ * INPUTS             : void
+ * RETURNS            : const ReportStats_t*
+ ***********************************************************************************************/
+const ReportStats_t *ReportGetStats(void)
+{
+    return &ReportStats;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueDrop
+ * Description        : Remove the oldest report without delivering it. Called with the queue locked.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void ReportQueueDrop(void)
+{
+    ReportHead=(ReportHead+1)%ReportQueueSize;
+    ReportCount--;
+    ReportStats.Dropped++;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueFind
+ * Description        : Find a queued report by its sequence number. Called with the queue locked.
+ * INPUTS             : uint32_t Seq
+ * RETURNS            : uint32_t places after the oldest, ReportCount when it is not queued
+ ***********************************************************************************************/
+static uint32_t ReportQueueFind(uint32_t Seq)
+{
+    uint32_t Index;
+    for(Index=0;Index<ReportCount;Index++){
+        if(ReportQueue[(ReportHead+Index)%ReportQueueSize].Seq==Seq){
+            break;
+        }
+    }
+    return Index;
+}
+
+/***********************************************************************************************
+ * Function Name      : ReportQueueRemove
+ * Description        : Take out the report Index places after the oldest, the older reports move
+ *                      up one place. The caller counts it. Called with the queue locked, by the
+ *                      sender only, while no pointer into the queue is held.
+ * INPUTS             : uint32_t Index
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void ReportQueueRemove(uint32_t Index)
+{
+    for(;Index!=0;Index--){
+        ReportQueue[(ReportHead+Index)%ReportQueueSize]=ReportQueue[(ReportHead+Index-1)%ReportQueueSize];
+    }
+    ReportHead=(ReportHead+1)%ReportQueueSize;
+    ReportCount--;
+}
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File Name: report.h
+ *
+ * Description: Header file for the pending position report queue.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_REPORT_H_
+#define SRC_REPORT_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include "HAL/gps.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Number of reports kept while waiting for a 2xx from the server */
+#define ReportQueueSize     16
+/* Upload attempts of a single report before it is given up */
+#define ReportMaxRetries    3
+/* A batch is uploaded once this many reports are queued */
+#define ReportBatchSize     8
+/* or once the oldest queued report waited this long (ms) */
+#define ReportBatchMaxAge   120000
+
+typedef struct{
+    uint32_t Seq;            /* Monotonic sequence number sent with the report */
+    char     Longitude[GPSCoordinateSize];
+    char     Latitude[GPSCoordinateSize];
+    uint8_t  Retries;        /* Failed upload attempts so far */
+    uint8_t  Priority;       /* Set for reports taken during a U-turn or a curve */
+    uint16_t Speed;          /* Speed over ground in km/h */
+    uint16_t Course;         /* Course over ground in degrees */
+    uint32_t Tick;           /* Tick count when the report was queued */
+    uint32_t Time;           /* UTC Unix time when the report was queued, 0 if not known */
+    uint32_t SentTick;       /* Tick count of the last transmission, 0 if never sent */
+    uint8_t  Acked;          /* Acknowledged out of order, leaves once the older ones did */
+}Report_t;
+
+typedef struct{
+    uint32_t Queued;         /* Reports created */
+    uint32_t Delivered;      /* Reports confirmed by a 2xx HTTP status */
+    uint32_t Failed;         /* Upload attempts that did not end with a 2xx */
+    uint32_t Dropped;        /* Reports lost to retry exhaustion or queue overflow */
+    uint32_t Stored;         /* Reports moved to the flash log: no link or out of retries */
+    uint16_t LastHttpStatus; /* Status of the last +HTTPACTION URC, 0 if none */
+}ReportStats_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+void ReportQueueInit(void);
+void ReportSetNextSeq(uint32_t Seq);
+Report_t *ReportQueuePush(const char *Lon, const char *Lat, uint16_t Speed, uint16_t Course, uint8_t Priority);
+Report_t *ReportQueuePeek(void);
+Report_t *ReportQueuePeekAt(uint32_t Index);
+uint8_t ReportBatchReady(void);
+void ReportQueueAck(uint16_t HttpStatus);
+void ReportQueueNack(uint32_t Seq, uint16_t HttpStatus);
+void ReportSetStoreCallBack(uint8_t (*Store)(const Report_t *Report));
+void ReportQueueSetSending(uint8_t Sending);
+uint8_t ReportQueueIsSending(void);
+void ReportQueueStored(void);
+uint32_t ReportQueueCount(void);
+const ReportStats_t *ReportGetStats(void);
+
+#endif /* SRC_REPORT_H_ */
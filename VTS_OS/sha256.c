@@ -0,0 +1,236 @@
+/******************************************************************************
+ * File Name: sha256.c
+ *
+ * Description: Source file for SHA-256 (FIPS 180-4) and HMAC-SHA256
+ *              (RFC 2104) used to sign the reports sent without TLS. The
+ *              message schedule is kept as a rolling window of 16 words so
+ *              the hash fits in the small task stacks.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "sha256.h"
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define Sha256Rotr(X,N)     (((X)>>(N))|((X)<<(32-(N))))
+#define Sha256Ch(X,Y,Z)     (((X)&(Y))^(~(X)&(Z)))
+#define Sha256Maj(X,Y,Z)    (((X)&(Y))^((X)&(Z))^((Y)&(Z)))
+#define Sha256Sigma0(X)     (Sha256Rotr(X,2)^Sha256Rotr(X,13)^Sha256Rotr(X,22))
+#define Sha256Sigma1(X)     (Sha256Rotr(X,6)^Sha256Rotr(X,11)^Sha256Rotr(X,25))
+#define Sha256Gamma0(X)     (Sha256Rotr(X,7)^Sha256Rotr(X,18)^((X)>>3))
+#define Sha256Gamma1(X)     (Sha256Rotr(X,17)^Sha256Rotr(X,19)^((X)>>10))
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static void Sha256Compress(Sha256_t *Ctx);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static const uint32_t Sha256K[64]={
+    0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+    0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+    0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+    0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+    0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+    0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+    0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+    0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
+};
+/* HMAC scratch, kept off the task stacks. The reports are signed with the module taken, so
+ * there is a single user at a time */
+static Sha256_t HmacCtx;
+static uint8_t  HmacPad[Sha256BlockSize];
+static uint8_t  HmacInner[Sha256DigestSize];
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : Sha256Init
+ * Description        : Start a new hash.
+ * INPUTS             : Sha256_t *Ctx
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sha256Init(Sha256_t *Ctx)
+{
+    Ctx->State[0]=0x6a09e667;
+    Ctx->State[1]=0xbb67ae85;
+    Ctx->State[2]=0x3c6ef372;
+    Ctx->State[3]=0xa54ff53a;
+    Ctx->State[4]=0x510e527f;
+    Ctx->State[5]=0x9b05688c;
+    Ctx->State[6]=0x1f83d9ab;
+    Ctx->State[7]=0x5be0cd19;
+    Ctx->Length=0;
+    Ctx->Fill=0;
+}
+
+/***********************************************************************************************
+ * Function Name      : Sha256Update
+ * Description        : Hash more bytes of the message.
+ * INPUTS             : Sha256_t *Ctx, const uint8_t *Data, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sha256Update(Sha256_t *Ctx,const uint8_t *Data,uint32_t Size)
+{
+    uint32_t Chunk;
+    Ctx->Length+=Size;
+    while(Size!=0)
+    {
+        Chunk=Sha256BlockSize-Ctx->Fill;
+        if(Chunk>Size)
+        {
+            Chunk=Size;
+        }
+        memcpy(&Ctx->Block[Ctx->Fill],Data,Chunk);
+        Ctx->Fill+=Chunk;
+        Data+=Chunk;
+        Size-=Chunk;
+        if(Ctx->Fill==Sha256BlockSize)
+        {
+            Sha256Compress(Ctx);
+            Ctx->Fill=0;
+        }
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : Sha256Final
+ * Description        : Pad the message with its length in bits and write the digest.
+ * INPUTS             : Sha256_t *Ctx, uint8_t *Digest (Sha256DigestSize bytes)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void Sha256Final(Sha256_t *Ctx,uint8_t *Digest)
+{
+    uint32_t Bits=Ctx->Length<<3;
+    uint8_t Index;
+    Ctx->Block[Ctx->Fill++]=0x80;
+    if(Ctx->Fill>Sha256BlockSize-8)
+    {
+        memset(&Ctx->Block[Ctx->Fill],0,Sha256BlockSize-Ctx->Fill);
+        Sha256Compress(Ctx);
+        Ctx->Fill=0;
+    }
+    memset(&Ctx->Block[Ctx->Fill],0,Sha256BlockSize-Ctx->Fill);
+    // A message stays far below 512 MB, the upper word of the bit length is 0
+    Ctx->Block[59]=(uint8_t)(Ctx->Length>>29);
+    Ctx->Block[60]=(uint8_t)(Bits>>24);
+    Ctx->Block[61]=(uint8_t)(Bits>>16);
+    Ctx->Block[62]=(uint8_t)(Bits>>8);
+    Ctx->Block[63]=(uint8_t)Bits;
+    Sha256Compress(Ctx);
+    for(Index=0;Index<8;Index++)
+    {
+        Digest[4*Index]=(uint8_t)(Ctx->State[Index]>>24);
+        Digest[4*Index+1]=(uint8_t)(Ctx->State[Index]>>16);
+        Digest[4*Index+2]=(uint8_t)(Ctx->State[Index]>>8);
+        Digest[4*Index+3]=(uint8_t)Ctx->State[Index];
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : HmacSha256
+ * Description        : HMAC-SHA256 of a message, truncated to the first MacSize bytes. Not
+ *                      reentrant, see HmacCtx.
+ * INPUTS             : const uint8_t *Key, uint32_t KeySize, const uint8_t *Data, uint32_t Size,
+ *                      uint8_t *Mac, uint8_t MacSize (at most Sha256DigestSize)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void HmacSha256(const uint8_t *Key,uint32_t KeySize,const uint8_t *Data,uint32_t Size,
+                uint8_t *Mac,uint8_t MacSize)
+{
+    uint8_t Index;
+    memset(HmacPad,0,Sha256BlockSize);
+    // A key longer than a block is replaced by its hash
+    if(KeySize>Sha256BlockSize)
+    {
+        Sha256Init(&HmacCtx);
+        Sha256Update(&HmacCtx,Key,KeySize);
+        Sha256Final(&HmacCtx,HmacPad);
+    }
+    else
+    {
+        memcpy(HmacPad,Key,KeySize);
+    }
+    for(Index=0;Index<Sha256BlockSize;Index++)
+    {
+        HmacPad[Index]^=0x36;
+    }
+    Sha256Init(&HmacCtx);
+    Sha256Update(&HmacCtx,HmacPad,Sha256BlockSize);
+    Sha256Update(&HmacCtx,Data,Size);
+    Sha256Final(&HmacCtx,HmacInner);
+    // 0x36^0x5c turns the inner pad into the outer one
+    for(Index=0;Index<Sha256BlockSize;Index++)
+    {
+        HmacPad[Index]^=0x36^0x5c;
+    }
+    Sha256Init(&HmacCtx);
+    Sha256Update(&HmacCtx,HmacPad,Sha256BlockSize);
+    Sha256Update(&HmacCtx,HmacInner,Sha256DigestSize);
+    Sha256Final(&HmacCtx,HmacInner);
+    memcpy(Mac,HmacInner,MacSize);
+}
+
+/***********************************************************************************************
+ * Function Name      : Sha256Compress
+ * Description        : Process the full block held by the context. W holds the last 16 words of
+ *                      the message schedule, word t is computed in place of word t-16.
+ * INPUTS             : Sha256_t *Ctx
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void Sha256Compress(Sha256_t *Ctx)
+{
+    uint32_t W[16];
+    uint32_t A,B,C,D,E,F,G,H,T1,T2;
+    uint8_t Round;
+    for(Round=0;Round<16;Round++)
+    {
+        W[Round]=((uint32_t)Ctx->Block[4*Round]<<24)|((uint32_t)Ctx->Block[4*Round+1]<<16)
+                |((uint32_t)Ctx->Block[4*Round+2]<<8)|Ctx->Block[4*Round+3];
+    }
+    A=Ctx->State[0];
+    B=Ctx->State[1];
+    C=Ctx->State[2];
+    D=Ctx->State[3];
+    E=Ctx->State[4];
+    F=Ctx->State[5];
+    G=Ctx->State[6];
+    H=Ctx->State[7];
+    for(Round=0;Round<64;Round++)
+    {
+        if(Round>=16)
+        {
+            W[Round&15]+=Sha256Gamma1(W[(Round-2)&15])+W[(Round-7)&15]+Sha256Gamma0(W[(Round-15)&15]);
+        }
+        T1=H+Sha256Sigma1(E)+Sha256Ch(E,F,G)+Sha256K[Round]+W[Round&15];
+        T2=Sha256Sigma0(A)+Sha256Maj(A,B,C);
+        H=G;
+        G=F;
+        F=E;
+        E=D+T1;
+        D=C;
+        C=B;
+        B=A;
+        A=T1+T2;
+    }
+    Ctx->State[0]+=A;
+    Ctx->State[1]+=B;
+    Ctx->State[2]+=C;
+    Ctx->State[3]+=D;
+    Ctx->State[4]+=E;
+    Ctx->State[5]+=F;
+    Ctx->State[6]+=G;
+    Ctx->State[7]+=H;
+}
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * File Name: sha256.h
+ *
+ * Description: Header file for SHA-256 and HMAC-SHA256.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_SHA256_H_
+#define SRC_SHA256_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define Sha256BlockSize     64
+#define Sha256DigestSize    32
+
+typedef struct{
+    uint32_t State[8];
+    uint32_t Length;         /* Bytes hashed so far */
+    uint8_t  Block[Sha256BlockSize];
+    uint8_t  Fill;           /* Bytes waiting in Block */
+}Sha256_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+void Sha256Init(Sha256_t *Ctx);
+void Sha256Update(Sha256_t *Ctx,const uint8_t *Data,uint32_t Size);
+void Sha256Final(Sha256_t *Ctx,uint8_t *Digest);
+void HmacSha256(const uint8_t *Key,uint32_t KeySize,const uint8_t *Data,uint32_t Size,
+                uint8_t *Mac,uint8_t MacSize);
+
+#endif /* SRC_SHA256_H_ */
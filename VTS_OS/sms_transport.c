@@ -0,0 +1,290 @@
+/******************************************************************************
+ * File Name: sms_transport.c
+ *
+ * Description: Source file for the SMS fallback transport. When no GPRS
+ *              bearer can be had, several pending fixes are delta encoded
+ *              into the 140 bytes of one binary SMS. Messages cost money, so
+ *              they are rate limited and capped per day.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "transport.h"
+#include "HAL/gps.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Length of the rolling window SmsDailyLimit applies to (ms) */
+#define SmsDay                  86400000UL
+/* SMS-SUBMIT without validity period, international number, 8 bit data */
+#define SmsFirstOctet           0x01
+#define SmsNumberType           0x91
+#define SmsDataCoding           0x04
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t SmsTransportOpen(void);
+static uint32_t SmsTransportSend(const Report_t *Report,uint16_t *Status);
+static void SmsTransportClose(void);
+static uint32_t SmsTransportSendBatch(uint32_t *Count,uint16_t *Status);
+static void SmsPackFirst(const Report_t *Report,TickType_t Now);
+static uint8_t SmsPackNext(const Report_t *Report);
+static uint32_t SmsSendMessage(void);
+static void SmsPutU32(uint8_t *Dst,uint32_t Value);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* SMSC information, TPDU header (at most 10 octets of address) and the user data */
+static uint8_t SmsPdu[Sim800SmsPduMax];
+static uint8_t SmsUserData[SmsUserDataSize];
+static uint32_t SmsUserDataLen;
+/* Last fix packed, the next one is encoded relative to it */
+static uint32_t SmsLastSeq;
+static TickType_t SmsLastTick;
+static int32_t SmsLastLat;
+static int32_t SmsLastLon;
+/* Rate limiting and daily budget */
+static TickType_t SmsLastSentTick;
+static TickType_t SmsDayStartTick;
+static uint32_t SmsSentToday;
+static uint8_t SmsEverSent=0;
+
+static TransportStats_t SmsStats;
+const Transport_t SmsTransport={"SMS",SmsTransportOpen,SmsTransportSend,SmsTransportClose,
+                                SmsTransportSendBatch,1,&SmsStats};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : SmsFallbackAllowed
+ * Description        : Check the rate limit and the daily budget of the SMS fallback.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 if a message may be sent now
+ ***********************************************************************************************/
+uint8_t SmsFallbackAllowed(void)
+{
+    TickType_t Now=xTaskGetTickCount();
+    if(!SmsEverSent)
+    {
+        return 1;
+    }
+    if((Now-SmsDayStartTick)>=(TickType_t)(SmsDay/portTICK_PERIOD_MS))
+    {
+        SmsDayStartTick=Now;
+        SmsSentToday=0;
+    }
+    if(SmsSentToday>=SmsDailyLimit)
+    {
+        return 0;
+    }
+    return (Now-SmsLastSentTick)>=pdMS_TO_TICKS(SmsMinInterval);
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsTransportOpen
+ * Description        : An SMS only needs the module to be registered to the network.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t SmsTransportOpen(void)
+{
+    uint8_t Registered;
+    if(Sim800GetRegistration(&Registered)!=Gsmok || !Registered)
+    {
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsTransportSend
+ * Description        : Send a single report in its own message.
+ * INPUTS             : const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t SmsTransportSend(const Report_t *Report,uint16_t *Status)
+{
+    (void)Status;
+    SmsPackFirst(Report,xTaskGetTickCount());
+    return SmsSendMessage();
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsTransportSendBatch
+ * Description        : Pack as many of the oldest pending reports as fit in one message. A report
+ *                      whose deltas do not fit in the encoding waits for the next message.
+ * INPUTS             : uint32_t *Count (in: at most, out: reports sent), uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t SmsTransportSendBatch(uint32_t *Count,uint16_t *Status)
+{
+    Report_t *Report;
+    uint32_t Index;
+    (void)Status;
+    Report=TransportBatchAt(0);
+    if(Report==NULL || *Count==0)
+    {
+        *Count=0;
+        return GsmError;
+    }
+    SmsPackFirst(Report,xTaskGetTickCount());
+    for(Index=1;Index<*Count && (Report=TransportBatchAt(Index))!=NULL;Index++)
+    {
+        if(!SmsPackNext(Report))
+        {
+            break;
+        }
+    }
+    *Count=Index;
+    return SmsSendMessage();
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsTransportClose
+ * Description        : Nothing to release for SMS.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void SmsTransportClose(void)
+{
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsPackFirst
+ * Description        : Start the user data with the header and the absolute first fix: type,
+ *                      device id, fix count, seq, age of the fix in seconds, lat and lon in micro
+ *                      degrees. Multi byte fields are little endian.
+ * INPUTS             : const Report_t *Report, TickType_t Now
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void SmsPackFirst(const Report_t *Report,TickType_t Now)
+{
+    uint32_t Age=((Now-Report->Tick)*portTICK_PERIOD_MS)/1000;
+    SmsLastSeq=Report->Seq;
+    SmsLastTick=Report->Tick;
+    SmsLastLat=GPSToMicroDegrees(Report->Latitude);
+    SmsLastLon=GPSToMicroDegrees(Report->Longitude);
+    if(Age>0xFFFF)
+    {
+        Age=0xFFFF;
+    }
+    SmsUserData[0]=SmsPosition;
+    SmsUserData[1]=(uint8_t)TransportDeviceId;
+    SmsUserData[2]=(uint8_t)(TransportDeviceId>>8);
+    SmsUserData[3]=1;
+    SmsPutU32(&SmsUserData[4],SmsLastSeq);
+    SmsUserData[8]=(uint8_t)Age;
+    SmsUserData[9]=(uint8_t)(Age>>8);
+    SmsPutU32(&SmsUserData[10],(uint32_t)SmsLastLat);
+    SmsPutU32(&SmsUserData[14],(uint32_t)SmsLastLon);
+    SmsUserDataLen=SmsHeaderSize;
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsPackNext
+ * Description        : Append a fix relative to the previous one: seq delta (1 byte), seconds
+ *                      since the previous fix (1 byte, 255 meaning 255 or more), lat and lon deltas
+ *                      in micro degrees (int16 each).
+ * INPUTS             : const Report_t *Report
+ * RETURNS            : uint8_t 0 if the fix does not fit in the message or the encoding
+ ***********************************************************************************************/
+static uint8_t SmsPackNext(const Report_t *Report)
+{
+    int32_t Lat=GPSToMicroDegrees(Report->Latitude);
+    int32_t Lon=GPSToMicroDegrees(Report->Longitude);
+    int32_t DLat=Lat-SmsLastLat;
+    int32_t DLon=Lon-SmsLastLon;
+    uint32_t DSeq=Report->Seq-SmsLastSeq;
+    uint32_t DTime=((Report->Tick-SmsLastTick)*portTICK_PERIOD_MS)/1000;
+    uint8_t *Entry=&SmsUserData[SmsUserDataLen];
+    if(SmsUserDataLen+SmsDeltaSize>SmsUserDataSize || DSeq==0 || DSeq>0xFF ||
+       DLat<-32768 || DLat>32767 || DLon<-32768 || DLon>32767)
+    {
+        return 0;
+    }
+    if(DTime>0xFF)
+    {
+        DTime=0xFF;
+    }
+    Entry[0]=(uint8_t)DSeq;
+    Entry[1]=(uint8_t)DTime;
+    Entry[2]=(uint8_t)DLat;
+    Entry[3]=(uint8_t)(DLat>>8);
+    Entry[4]=(uint8_t)DLon;
+    Entry[5]=(uint8_t)(DLon>>8);
+    SmsUserDataLen+=SmsDeltaSize;
+    SmsUserData[3]++;
+    SmsLastSeq=Report->Seq;
+    SmsLastTick=Report->Tick;
+    SmsLastLat=Lat;
+    SmsLastLon=Lon;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsSendMessage
+ * Description        : Wrap the user data in an SMS-SUBMIT PDU to SmsServerNumber and send it.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t SmsSendMessage(void)
+{
+    const char *Number=SmsServerNumber;
+    uint32_t Digits=strlen(Number);
+    uint32_t Size=0;
+    uint32_t Index;
+    SmsPdu[Size++]=0x00;                    // Default SMSC
+    SmsPdu[Size++]=SmsFirstOctet;
+    SmsPdu[Size++]=0x00;                    // Message reference set by the module
+    SmsPdu[Size++]=(uint8_t)Digits;
+    SmsPdu[Size++]=SmsNumberType;
+    // Semi octets, low nibble first, padded with F
+    for(Index=0;Index<Digits;Index+=2)
+    {
+        SmsPdu[Size++]=(uint8_t)((Number[Index]-'0') |
+                       ((Index+1<Digits) ? (Number[Index+1]-'0')<<4 : 0xF0));
+    }
+    SmsPdu[Size++]=0x00;                    // Protocol identifier
+    SmsPdu[Size++]=SmsDataCoding;
+    SmsPdu[Size++]=(uint8_t)SmsUserDataLen;
+    memcpy(&SmsPdu[Size],SmsUserData,SmsUserDataLen);
+    Size+=SmsUserDataLen;
+    if(Sim800SmsSendPdu(SmsPdu,Size)!=Gsmok)
+    {
+        return GsmError;
+    }
+    SmsLastSentTick=xTaskGetTickCount();
+    if(!SmsEverSent)
+    {
+        SmsEverSent=1;
+        SmsDayStartTick=SmsLastSentTick;
+    }
+    SmsSentToday++;
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : SmsPutU32
+ * Description        : Store a 32 bit value little endian.
+ * INPUTS             : uint8_t *Dst, uint32_t Value
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void SmsPutU32(uint8_t *Dst,uint32_t Value)
+{
+    Dst[0]=(uint8_t)Value;
+    Dst[1]=(uint8_t)(Value>>8);
+    Dst[2]=(uint8_t)(Value>>16);
+    Dst[3]=(uint8_t)(Value>>24);
+}
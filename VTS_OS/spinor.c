@@ -0,0 +1,333 @@
+/******************************************************************************
+ * File Name: spinor.c
+ *
+ * Description: Source file for the JEDEC SPI NOR flash layer. The chip is
+ *              found by its JEDEC ID, its size read from the ID, and reached
+ *              through a bus of single transactions: SSI0 with the uDMA on the
+ *              target (HAL/spinor_hw.c), a file on the host (spinor_file.c).
+ *              Programs are split on the 256 byte pages and read back, erases
+ *              work on 4 KB sectors, and the chip is handed to the flash log
+ *              as a backend with one sector per log page.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "spinor.h"
+#include <string.h>
+#if !defined(SpiNorHostBuild)
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t SpiNorCommand(uint8_t Cmd,uint32_t Address,const uint8_t *Tx,uint8_t *Rx,uint32_t Size);
+static uint8_t SpiNorWriteEnable(void);
+static uint8_t SpiNorWaitReady(uint32_t Polls,uint8_t Sleep);
+static void SpiNorSleep(void);
+static int32_t SpiNorLogErase(uint32_t Address);
+static int32_t SpiNorLogProgram(uint32_t *Data,uint32_t Address,uint32_t Size);
+static void SpiNorLogRead(uint32_t Address,void *Data,uint32_t Size);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static const SpiNorBus_t *SpiNor=NULL;
+static SpiNorStats_t SpiNorStats;
+static FlashLogBackend_t SpiNorLog;
+/* Set while a task waits for a sector erase, the chip does not answer reads meanwhile */
+static volatile uint8_t SpiNorErasing=0;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : SpiNorInit
+ * Description        : Start the bus, wake the chip up and read its JEDEC ID.
+ * INPUTS             : const SpiNorBus_t *Bus
+ * RETURNS            : const FlashLogBackend_t* covering the whole chip, NULL if no chip answers
+ ***********************************************************************************************/
+const FlashLogBackend_t *SpiNorInit(const SpiNorBus_t *Bus)
+{
+    uint8_t Cmd=SpiNorCmdWake;
+    uint8_t Id[3];
+    SpiNor=NULL;
+    memset(&SpiNorStats,0,sizeof(SpiNorStats));
+    if(Bus->Init()!=0 || Bus->Transfer(&Cmd,1,NULL,NULL,0)!=0)
+    {
+        return NULL;
+    }
+    Cmd=SpiNorCmdReadId;
+    if(Bus->Transfer(&Cmd,1,NULL,Id,3)!=0 || Id[0]==0x00 || Id[0]==0xFF)
+    {
+        return NULL;
+    }
+    //The last ID byte is the log2 of the size, Micron counts on from 0x20 for 64 MB
+    if(Id[2]>=0x10 && Id[2]<=0x1F)
+    {
+        SpiNorStats.Capacity=(uint32_t)1<<Id[2];
+    }
+    else if(Id[2]>=0x20 && Id[2]<=0x22)
+    {
+        SpiNorStats.Capacity=(uint32_t)1<<(Id[2]-6);
+    }
+    else
+    {
+        return NULL;
+    }
+    SpiNor=Bus;
+    SpiNorStats.Manufacturer=Id[0];
+    SpiNorStats.Type=Id[1];
+    SpiNorStats.AddressBytes=(SpiNorStats.Capacity>SpiNor3ByteMax)?4:3;
+    SpiNorLog.Erase=SpiNorLogErase;
+    SpiNorLog.Program=SpiNorLogProgram;
+    SpiNorLog.Read=SpiNorLogRead;
+    SpiNorLog.Base=0;
+    SpiNorLog.Size=SpiNorStats.Capacity;
+    SpiNorLog.PageSize=SpiNorSectorSize;
+    return &SpiNorLog;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorRead
+ * Description        : Read any number of bytes from any address.
+ * INPUTS             : uint32_t Address, void *Data, uint32_t Size
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+uint8_t SpiNorRead(uint32_t Address,void *Data,uint32_t Size)
+{
+    if(SpiNor==NULL)
+    {
+        return 0;
+    }
+    while(SpiNorErasing)
+    {
+        SpiNorSleep();
+    }
+    return SpiNorCommand((SpiNorStats.AddressBytes==4)?SpiNorCmdRead4:SpiNorCmdRead,Address,NULL,(uint8_t*)Data,Size);
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorProgram
+ * Description        : Program bytes, one command per page they cover. Programming only clears
+ *                      bits, the bytes are read back to check they hold the data.
+ * INPUTS             : uint32_t Address, const void *Data, uint32_t Size
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+uint8_t SpiNorProgram(uint32_t Address,const void *Data,uint32_t Size)
+{
+    const uint8_t *Bytes=(const uint8_t*)Data;
+    uint8_t  Check[SpiNorVerifySize];
+    uint32_t Part;
+    uint32_t Offset;
+    uint32_t Length;
+    if(SpiNor==NULL)
+    {
+        return 0;
+    }
+    while(SpiNorErasing)
+    {
+        SpiNorSleep();
+    }
+    while(Size!=0)
+    {
+        Part=SpiNorPageSize-(Address%SpiNorPageSize);
+        Part=(Part<Size)?Part:Size;
+        if(!SpiNorWriteEnable() ||
+           !SpiNorCommand((SpiNorStats.AddressBytes==4)?SpiNorCmdProgram4:SpiNorCmdProgram,Address,Bytes,NULL,Part) ||
+           !SpiNorWaitReady(SpiNorProgramPolls,0))
+        {
+            return 0;
+        }
+        SpiNorStats.Programs++;
+        for(Offset=0;Offset<Part;Offset+=Length)
+        {
+            Length=((Part-Offset)<SpiNorVerifySize)?(Part-Offset):SpiNorVerifySize;
+            if(!SpiNorRead(Address+Offset,Check,Length))
+            {
+                return 0;
+            }
+            if(memcmp(Check,&Bytes[Offset],Length)!=0)
+            {
+                SpiNorStats.Errors++;
+                return 0;
+            }
+        }
+        Address+=Part;
+        Bytes+=Part;
+        Size-=Part;
+    }
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorEraseSector
+ * Description        : Erase the 4 KB sector holding an address. The erase takes tens of ms, the
+ *                      task sleeps meanwhile and a read from another task waits for it.
+ * INPUTS             : uint32_t Address
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+uint8_t SpiNorEraseSector(uint32_t Address)
+{
+    uint8_t Done;
+    if(SpiNor==NULL)
+    {
+        return 0;
+    }
+    while(SpiNorErasing)
+    {
+        SpiNorSleep();
+    }
+    Address-=Address%SpiNorSectorSize;
+    if(!SpiNorWriteEnable() ||
+       !SpiNorCommand((SpiNorStats.AddressBytes==4)?SpiNorCmdErase4:SpiNorCmdErase,Address,NULL,NULL,0))
+    {
+        return 0;
+    }
+    SpiNorErasing=1;
+    Done=SpiNorWaitReady(SpiNorErasePolls,1);
+    SpiNorErasing=0;
+    if(Done)
+    {
+        SpiNorStats.Erases++;
+    }
+    return Done;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorGetStats
+ * Description        : The chip found by SpiNorInit and the operations made on it.
+ * INPUTS             : void
+ * RETURNS            : const SpiNorStats_t*
+ ***********************************************************************************************/
+const SpiNorStats_t *SpiNorGetStats(void)
+{
+    return &SpiNorStats;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorCommand
+ * Description        : Send a command with its address, then its data or read its answer.
+ * INPUTS             : uint8_t Cmd, uint32_t Address, const uint8_t *Tx, uint8_t *Rx, uint32_t Size
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+static uint8_t SpiNorCommand(uint8_t Cmd,uint32_t Address,const uint8_t *Tx,uint8_t *Rx,uint32_t Size)
+{
+    uint8_t  Head[5];
+    uint32_t Length=0;
+    Head[Length++]=Cmd;
+    if(SpiNorStats.AddressBytes==4)
+    {
+        Head[Length++]=(uint8_t)(Address>>24);
+    }
+    Head[Length++]=(uint8_t)(Address>>16);
+    Head[Length++]=(uint8_t)(Address>>8);
+    Head[Length++]=(uint8_t)Address;
+    if(SpiNor->Transfer(Head,Length,Tx,Rx,Size)!=0)
+    {
+        SpiNorStats.Errors++;
+        return 0;
+    }
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorWriteEnable
+ * Description        : Set the write enable latch, the chip clears it after each program or erase.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 on success
+ ***********************************************************************************************/
+static uint8_t SpiNorWriteEnable(void)
+{
+    uint8_t Cmd=SpiNorCmdWriteEnable;
+    if(SpiNor->Transfer(&Cmd,1,NULL,NULL,0)!=0)
+    {
+        SpiNorStats.Errors++;
+        return 0;
+    }
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorWaitReady
+ * Description        : Poll the status register until the chip is done with a program or erase.
+ * INPUTS             : uint32_t Polls, uint8_t Sleep (sleep a tick between two polls)
+ * RETURNS            : uint8_t 1 when the chip is ready, 0 on a timeout
+ ***********************************************************************************************/
+static uint8_t SpiNorWaitReady(uint32_t Polls,uint8_t Sleep)
+{
+    uint8_t Cmd=SpiNorCmdReadStatus;
+    uint8_t Status;
+    while(Polls!=0)
+    {
+        if(SpiNor->Transfer(&Cmd,1,NULL,&Status,1)==0 && (Status&SpiNorStatusBusy)==0)
+        {
+            return 1;
+        }
+        if(Sleep)
+        {
+            SpiNorSleep();
+        }
+        Polls--;
+    }
+    SpiNorStats.Errors++;
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorSleep
+ * Description        : Let the other tasks run while the chip is busy, nothing to wait for on the
+ *                      host.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void SpiNorSleep(void)
+{
+#if !defined(SpiNorHostBuild)
+    vTaskDelay(1);
+#endif
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorLogErase
+ * Description        : Flash log backend, erase a log page.
+ * INPUTS             : uint32_t Address
+ * RETURNS            : int32_t 0 on success
+ ***********************************************************************************************/
+static int32_t SpiNorLogErase(uint32_t Address)
+{
+    return SpiNorEraseSector(Address)?0:-1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorLogProgram
+ * Description        : Flash log backend, program words.
+ * INPUTS             : uint32_t *Data, uint32_t Address, uint32_t Size
+ * RETURNS            : int32_t 0 on success
+ ***********************************************************************************************/
+static int32_t SpiNorLogProgram(uint32_t *Data,uint32_t Address,uint32_t Size)
+{
+    return SpiNorProgram(Address,Data,Size)?0:-1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorLogRead
+ * Description        : Flash log backend, read bytes. A failed read returns zeros, which the log
+ *                      takes for a damaged slot.
+ * INPUTS             : uint32_t Address, void *Data, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void SpiNorLogRead(uint32_t Address,void *Data,uint32_t Size)
+{
+    if(!SpiNorRead(Address,Data,Size))
+    {
+        memset(Data,0,Size);
+    }
+}
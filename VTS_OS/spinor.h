@@ -0,0 +1,84 @@
+/******************************************************************************
+ * File Name: spinor.h
+ *
+ * Description: Header file for the JEDEC SPI NOR flash layer, an external
+ *              flash the store-and-forward log can live on.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_SPINOR_H_
+#define SRC_SPINOR_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+#include "flashlog.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Program unit, a program wraps around inside its page */
+#define SpiNorPageSize      256
+/* Smallest erase unit, the page of the flash log */
+#define SpiNorSectorSize    4096
+/* Commands common to the JEDEC serial NOR flashes */
+#define SpiNorCmdWriteEnable    0x06
+#define SpiNorCmdReadStatus     0x05
+#define SpiNorCmdRead           0x03
+#define SpiNorCmdProgram        0x02
+#define SpiNorCmdErase          0x20
+#define SpiNorCmdRead4          0x13
+#define SpiNorCmdProgram4       0x12
+#define SpiNorCmdErase4         0x21
+#define SpiNorCmdReadId         0x9F
+#define SpiNorCmdWake           0xAB
+/* Status register bits */
+#define SpiNorStatusBusy    0x01
+#define SpiNorStatusWel     0x02
+/* Beyond 16 MB the commands take 4 address bytes */
+#define SpiNor3ByteMax      0x01000000
+/* Status polls a page program may take, and polls one tick apart a sector erase may take */
+#define SpiNorProgramPolls  5000
+#define SpiNorErasePolls    500
+/* Bytes compared at a time when a program is read back */
+#define SpiNorVerifySize    16
+
+typedef struct{
+    /* Set up the bus, 0 when it is ready */
+    uint32_t (*Init)(void);
+    /* One transaction with the chip selected: send Cmd, then send Tx or receive Rx (Size bytes,
+       both NULL when Size is 0), 0 on success */
+    uint32_t (*Transfer)(const uint8_t *Cmd,uint32_t CmdSize,const uint8_t *Tx,uint8_t *Rx,uint32_t Size);
+}SpiNorBus_t;
+
+typedef struct{
+    uint8_t  Manufacturer;   /* JEDEC ID */
+    uint8_t  Type;
+    uint8_t  AddressBytes;   /* 3, or 4 above 16 MB */
+    uint32_t Capacity;       /* Bytes */
+    uint32_t Programs;       /* Pages programmed */
+    uint32_t Erases;         /* Sectors erased */
+    uint32_t Errors;         /* Bus errors, timeouts and programs that did not read back */
+}SpiNorStats_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+const FlashLogBackend_t *SpiNorInit(const SpiNorBus_t *Bus);
+uint8_t SpiNorRead(uint32_t Address,void *Data,uint32_t Size);
+uint8_t SpiNorProgram(uint32_t Address,const void *Data,uint32_t Size);
+uint8_t SpiNorEraseSector(uint32_t Address);
+const SpiNorStats_t *SpiNorGetStats(void);
+
+#if defined(SpiNorHostBuild)
+/* File standing for the chip on the host, see spinor_file.c */
+const SpiNorBus_t *SpiNorFileOpen(const char *Path,uint32_t Capacity);
+void SpiNorFileClose(void);
+void SpiNorFileCutAfter(int32_t Bytes);
+#endif
+
+#endif /* SRC_SPINOR_H_ */
@@ -0,0 +1,291 @@
+/******************************************************************************
+ * File Name: spinor_file.c
+ *
+ * Description: Source file for the host stand-in of the SPI NOR flash. The
+ *              bus answers the commands spinor.c sends the way a Winbond chip
+ *              would, on a file of the size of the chip: the JEDEC ID tells
+ *              the size, programs and erases need the write enable latch, a
+ *              program only clears bits and wraps around inside its 256 byte
+ *              page. A cut can be armed to stop the chip after a number of
+ *              bytes programmed or erased, as a power loss would, to test the
+ *              recovery of flashlog.c. Builds with SpiNorHostBuild defined
+ *              only.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(SpiNorHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "spinor.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Winbond manufacturer and memory type */
+#define SpiNorFileMaker     0xEF
+#define SpiNorFileType      0x40
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t SpiNorFileInit(void);
+static uint32_t SpiNorFileTransfer(const uint8_t *Cmd,uint32_t CmdSize,const uint8_t *Tx,uint8_t *Rx,uint32_t Size);
+static uint8_t SpiNorFileProgram(uint32_t Address,const uint8_t *Tx,uint32_t Size);
+static uint8_t SpiNorFileErase(uint32_t Address);
+static uint8_t SpiNorFileCut(void);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static FILE *SpiNorFile=NULL;
+static uint32_t SpiNorFileCapacity;
+static uint8_t SpiNorFileWel;
+/* Bytes still programmed or erased before the power is cut, negative when no cut is armed */
+static int32_t SpiNorFileBytes=-1;
+static const SpiNorBus_t SpiNorFileBus={
+    SpiNorFileInit,
+    SpiNorFileTransfer
+};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileOpen
+ * Description        : Open the file standing for the chip, a missing file is created erased.
+ * INPUTS             : const char *Path, uint32_t Capacity (a power of two from 64 KB to 2 GB)
+ * RETURNS            : const SpiNorBus_t* or NULL if the file cannot be opened
+ ***********************************************************************************************/
+const SpiNorBus_t *SpiNorFileOpen(const char *Path,uint32_t Capacity)
+{
+    uint8_t  Blank[SpiNorSectorSize];
+    uint32_t Offset;
+    SpiNorFileClose();
+    SpiNorFile=fopen(Path,"r+b");
+    if(SpiNorFile==NULL)
+    {
+        SpiNorFile=fopen(Path,"w+b");
+        if(SpiNorFile==NULL)
+        {
+            return NULL;
+        }
+        memset(Blank,0xFF,sizeof(Blank));
+        for(Offset=0;Offset<Capacity;Offset+=SpiNorSectorSize)
+        {
+            fwrite(Blank,1,SpiNorSectorSize,SpiNorFile);
+        }
+        fflush(SpiNorFile);
+    }
+    SpiNorFileCapacity=Capacity;
+    SpiNorFileWel=0;
+    SpiNorFileBytes=-1;
+    return &SpiNorFileBus;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileClose
+ * Description        : Close the file, as a power off would leave the chip.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+void SpiNorFileClose(void)
+{
+    if(SpiNorFile!=NULL)
+    {
+        fclose(SpiNorFile);
+        SpiNorFile=NULL;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileCutAfter
+ * Description        : Cut the power after this many more bytes were programmed or erased. The
+ *                      command in progress stops there and every later one fails until the file
+ *                      is opened again. A negative count disarms the cut.
+ * INPUTS             : int32_t Bytes
+ * RETURNS            : void
+ ***********************************************************************************************/
+void SpiNorFileCutAfter(int32_t Bytes)
+{
+    SpiNorFileBytes=Bytes;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileInit
+ * Description        : Bus start up, the file is ready once opened.
+ * INPUTS             : void
+ * RETURNS            : uint32_t 0 when a file is open
+ ***********************************************************************************************/
+static uint32_t SpiNorFileInit(void)
+{
+    return (SpiNorFile!=NULL)?0:1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileTransfer
+ * Description        : Carry out a command. The chip is never busy, a program or an erase is
+ *                      done by the time the command ends.
+ * INPUTS             : const uint8_t *Cmd, uint32_t CmdSize, const uint8_t *Tx, uint8_t *Rx,
+ *                      uint32_t Size
+ * RETURNS            : uint32_t 0 on success, 1 for a command the chip does not know
+ ***********************************************************************************************/
+static uint32_t SpiNorFileTransfer(const uint8_t *Cmd,uint32_t CmdSize,const uint8_t *Tx,uint8_t *Rx,uint32_t Size)
+{
+    uint32_t Address=0;
+    uint32_t Index;
+    uint8_t  Log2=0;
+    uint8_t  Wide=(Cmd[0]==SpiNorCmdRead4 || Cmd[0]==SpiNorCmdProgram4 || Cmd[0]==SpiNorCmdErase4);
+    for(Index=1;Index<CmdSize;Index++)
+    {
+        Address=(Address<<8)|Cmd[Index];
+    }
+    if(!Wide)
+    {
+        Address&=SpiNor3ByteMax-1;
+    }
+    Address&=SpiNorFileCapacity-1;
+    //Without power the chip does not answer
+    if(SpiNorFileBytes==0)
+    {
+        return 1;
+    }
+    switch(Cmd[0])
+    {
+    case SpiNorCmdWake:
+        return 0;
+    case SpiNorCmdReadId:
+        while(((uint32_t)1<<Log2)<SpiNorFileCapacity)
+        {
+            Log2++;
+        }
+        Rx[0]=SpiNorFileMaker;
+        Rx[1]=SpiNorFileType;
+        Rx[2]=Log2;
+        return 0;
+    case SpiNorCmdReadStatus:
+        Rx[0]=SpiNorFileWel?SpiNorStatusWel:0;
+        return 0;
+    case SpiNorCmdWriteEnable:
+        SpiNorFileWel=1;
+        return 0;
+    case SpiNorCmdRead:
+    case SpiNorCmdRead4:
+        //A read goes on at the start of the chip past its end
+        while(Size!=0)
+        {
+            Index=SpiNorFileCapacity-Address;
+            Index=(Index<Size)?Index:Size;
+            fseek(SpiNorFile,(long)Address,SEEK_SET);
+            if(fread(Rx,1,Index,SpiNorFile)!=Index)
+            {
+                return 1;
+            }
+            Rx+=Index;
+            Size-=Index;
+            Address=0;
+        }
+        return 0;
+    case SpiNorCmdProgram:
+    case SpiNorCmdProgram4:
+        if(SpiNorFileWel && !SpiNorFileProgram(Address,Tx,Size))
+        {
+            return 1;
+        }
+        SpiNorFileWel=0;
+        return 0;
+    case SpiNorCmdErase:
+    case SpiNorCmdErase4:
+        if(SpiNorFileWel && !SpiNorFileErase(Address))
+        {
+            return 1;
+        }
+        SpiNorFileWel=0;
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileProgram
+ * Description        : Clear the bits of the data in the page of the address, going on at the
+ *                      start of the page past its end as the chip does.
+ * INPUTS             : uint32_t Address, const uint8_t *Tx, uint32_t Size
+ * RETURNS            : uint8_t 1 on success, 0 when the power was cut
+ ***********************************************************************************************/
+static uint8_t SpiNorFileProgram(uint32_t Address,const uint8_t *Tx,uint32_t Size)
+{
+    uint32_t Page=Address-(Address%SpiNorPageSize);
+    uint32_t Index;
+    uint32_t Offset;
+    int Old;
+    for(Index=0;Index<Size;Index++)
+    {
+        if(SpiNorFileCut())
+        {
+            fflush(SpiNorFile);
+            return 0;
+        }
+        Offset=Page+((Address+Index)%SpiNorPageSize);
+        fseek(SpiNorFile,(long)Offset,SEEK_SET);
+        Old=fgetc(SpiNorFile);
+        fseek(SpiNorFile,(long)Offset,SEEK_SET);
+        fputc(Old&Tx[Index],SpiNorFile);
+    }
+    fflush(SpiNorFile);
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileErase
+ * Description        : Set the sector of the address to 0xFF. A cut leaves the first part of it
+ *                      erased only.
+ * INPUTS             : uint32_t Address
+ * RETURNS            : uint8_t 1 on success, 0 when the power was cut
+ ***********************************************************************************************/
+static uint8_t SpiNorFileErase(uint32_t Address)
+{
+    uint32_t Offset;
+    fseek(SpiNorFile,(long)(Address-(Address%SpiNorSectorSize)),SEEK_SET);
+    for(Offset=0;Offset<SpiNorSectorSize;Offset++)
+    {
+        if(SpiNorFileCut())
+        {
+            fflush(SpiNorFile);
+            return 0;
+        }
+        fputc(0xFF,SpiNorFile);
+    }
+    fflush(SpiNorFile);
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : SpiNorFileCut
+ * Description        : Count down the bytes of an armed cut.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 once the power is cut
+ ***********************************************************************************************/
+static uint8_t SpiNorFileCut(void)
+{
+    if(SpiNorFileBytes<0)
+    {
+        return 0;
+    }
+    if(SpiNorFileBytes==0)
+    {
+        return 1;
+    }
+    SpiNorFileBytes--;
+    return 0;
+}
+
+#endif /* SpiNorHostBuild */
@@ -0,0 +1,167 @@
+/******************************************************************************
+ * File Name: tcp_transport.c
+ *
+ * Description: Source file for the TCP transport. The reports are sent as
+ *              framed binary position records on a TCP connection that stays
+ *              open between reports, so no HTTP or TLS setup is paid per
+ *              report. RecordTcpTransport sends the pending reports as one
+ *              batch of compact delta records instead.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "transport.h"
+#include "dns.h"
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t TcpTransportOpen(void);
+static uint32_t TcpTransportSend(const Report_t *Report,uint16_t *Status);
+static void TcpTransportClose(void);
+static uint32_t SignedTcpTransportSend(const Report_t *Report,uint16_t *Status);
+static uint32_t RecordTcpTransportSendBatch(uint32_t *Count,uint16_t *Status);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Set while the connection to the server is believed to be open */
+static uint8_t TcpConnected=0;
+static uint8_t TcpFrame[TransportSignedFrameSize];
+
+static TransportStats_t TcpStats;
+const Transport_t TcpTransport={"TCP",TcpTransportOpen,TcpTransportSend,TcpTransportClose,NULL,0,&TcpStats};
+static TransportStats_t SignedTcpStats;
+const Transport_t SignedTcpTransport={"TCP-SIGNED",TcpTransportOpen,SignedTcpTransportSend,TcpTransportClose,
+                                      NULL,0,&SignedTcpStats};
+/* Frame of RecordTcpTransport, 4 bytes before the batch and the checksum after it */
+static uint8_t TcpRecordFrame[TransportRecordBatchSize+5];
+static TransportStats_t RecordTcpStats;
+const Transport_t RecordTcpTransport={"TCP-RECORD",TcpTransportOpen,TcpTransportSend,TcpTransportClose,
+                                      RecordTcpTransportSendBatch,1,&RecordTcpStats};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : TcpTransportOpen
+ * Description        : Connect to the server unless the connection is already open.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t TcpTransportOpen(void)
+{
+    if(!TcpConnected)
+    {
+        if(DnsSocketOpen("TCP",TransportServerHost,TransportServerPort)!=Gsmok)
+        {
+            return GsmError;
+        }
+        TcpConnected=1;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : TcpTransportSend
+ * Description        : Send the report as one framed position record. A failed send marks the
+ *                      connection as closed so it is opened again on the next window.
+ * INPUTS             : const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t TcpTransportSend(const Report_t *Report,uint16_t *Status)
+{
+    uint32_t Size=TransportBuildFrame(TcpFrame,Report);
+    (void)Status;
+    if(Sim800SocketSend(TcpFrame,Size)!=Gsmok)
+    {
+        TcpConnected=0;
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : SignedTcpTransportSend
+ * Description        : Send the report as one signed position record on the same connection.
+ * INPUTS             : const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t SignedTcpTransportSend(const Report_t *Report,uint16_t *Status)
+{
+    uint32_t Size=TransportBuildSignedFrame(TcpFrame,Report);
+    (void)Status;
+    if(Sim800SocketSend(TcpFrame,Size)!=Gsmok)
+    {
+        TcpConnected=0;
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : RecordTcpTransportSendBatch
+ * Description        : Send the oldest pending reports as one batch of compact records, as many as
+ *                      fit in TransportRecordBatchSize.
+ * INPUTS             : uint32_t *Count (in: at most, out: sent), uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t RecordTcpTransportSendBatch(uint32_t *Count,uint16_t *Status)
+{
+    RecordEncoder_t Encoder;
+    Record_t Record;
+    Report_t *Report;
+    uint32_t Index;
+    uint8_t Checksum=0;
+    (void)Status;
+    RecordEncoderInit(&Encoder,&TcpRecordFrame[4],TransportRecordBatchSize);
+    for(Index=0;Index<*Count && (Report=TransportBatchAt(Index))!=NULL;Index++)
+    {
+        TransportToRecord(&Record,Report);
+        if(!RecordEncode(&Encoder,&Record))
+        {
+            break;
+        }
+    }
+    *Count=Index;
+    if(Index==0)
+    {
+        return GsmError;
+    }
+    TcpRecordFrame[0]=TransportFrameStart;
+    TcpRecordFrame[1]=TransportFrameRecords;
+    TcpRecordFrame[2]=(uint8_t)Encoder.Len;
+    TcpRecordFrame[3]=(uint8_t)(Encoder.Len>>8);
+    for(Index=1;Index<Encoder.Len+4;Index++)
+    {
+        Checksum^=TcpRecordFrame[Index];
+    }
+    TcpRecordFrame[Encoder.Len+4]=Checksum;
+    if(Sim800SocketSend(TcpRecordFrame,Encoder.Len+5)!=Gsmok)
+    {
+        TcpConnected=0;
+        return GsmError;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : TcpTransportClose
+ * Description        : Close the connection to the server.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TcpTransportClose(void)
+{
+    if(TcpConnected)
+    {
+        Sim800SocketClose();
+        TcpConnected=0;
+    }
+}
@@ -0,0 +1,725 @@
+/******************************************************************************
+ * File Name: tcpbench.c
+ *
+ * Description: Host benchmark of the report transports against a stand-in of
+ *              the SIM800 and of the server behind it. The transports, the
+ *              SIM800 driver and its exchanges run unchanged; the stand-in
+ *              answers their AT commands on a simulated clock, takes the
+ *              HTTP requests and the socket data, and checks that every
+ *              report reached the server once. The UART bytes and the AT
+ *              commands per report are counted exactly, the time per report
+ *              follows the link model below. A last case checks that the
+ *              rest of a reply longer than its reception does not answer the
+ *              next command. Builds with TcpHostBuild defined only, with
+ *              SIM800.c, transport.c, tcp_transport.c, dns.c, report.c,
+ *              record.c, base64.c and sha256.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(TcpHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "transport.h"
+#include "timesvc.h"
+#include "base64.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Link model: the UART runs at GSMFastBaud with 10 bits a byte, the module answers a command
+ * after BenchTurnaround ms and the GPRS bearer has a round trip of BenchRtt ms. AT+HTTPACTION
+ * opens a new connection for every request (connect and request, 2 round trips), HTTPS adds
+ * the TLS handshake (2 round trips and BenchTlsSetup ms of the module). "SEND OK" of a socket
+ * comes once the server acknowledged the data */
+#define BenchTurnaround     20
+#define BenchRtt            600
+#define BenchTlsSetup       1500
+#define BenchBearerUp       2000
+/* Reports per transport, queued one per window, or ReportBatchSize per window for batching ones */
+#define BenchReports        64
+#define BenchLineSize       400
+#define BenchBodySize       (TransportBatchBodySize*2)
+/* Long line of the over-long case: overflows the reception of a short command, its tail and the
+ * "OK" after it fit the next one */
+#define BenchNoiseLen       40
+
+typedef struct{
+    uint32_t Us;             /* Simulated time in us */
+    uint32_t TxBytes;        /* Bytes sent to the module */
+    uint32_t RxBytes;        /* Bytes the module answered */
+    uint32_t Commands;       /* AT command lines */
+    uint32_t Received;       /* Reports taken by the server */
+    uint32_t Duplicates;     /* Reports the server already had */
+    uint32_t Bad;            /* Frames or requests the server could not read */
+}BenchStats_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t BenchRun(const Transport_t *Transport);
+static uint8_t BenchOverlong(void);
+static void BenchWait(uint32_t Ms);
+static void BenchAnswer(const char *Text);
+static void BenchModemByte(uint8_t Byte);
+static void BenchCommand(const char *Line);
+static void BenchServerSeq(uint32_t Seq);
+static void BenchServerGet(void);
+static void BenchServerPost(void);
+static void BenchServerStream(uint8_t Byte);
+static void BenchServerRecords(const uint8_t *Data,uint32_t Size);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static BenchStats_t BenchStats;
+/* Reception armed by GSMReceiveResponse */
+static uint8_t     *BenchRx;
+static uint32_t     BenchRxSize;
+static uint32_t     BenchRxCount;
+/* Bytes the module holds behind RTS until the next reception is armed */
+static char         BenchHeld[BenchLineSize];
+static uint32_t     BenchHeldLen;
+/* Module state */
+static uint8_t      BenchEcho;
+static uint8_t      BenchHttps;
+static uint8_t      BenchBearer;
+/* Set to leave the next command without an answer, or to put a long line before its answer */
+static uint8_t      BenchMute;
+static uint8_t      BenchNoise;
+static char         BenchLine[BenchLineSize];
+static uint32_t     BenchLineLen;
+/* Bytes of AT+CIPSEND (socket) or AT+HTTPDATA (body) data still expected */
+static uint32_t     BenchDataLeft;
+static uint8_t      BenchDataSocket;
+static char         BenchUrl[BenchLineSize];
+static uint8_t      BenchBody[BenchBodySize];
+static uint32_t     BenchBodyLen;
+/* Server state: the socket stream being framed and the reports it has */
+static uint8_t      BenchFrame[TransportRecordBatchSize+8];
+static uint32_t     BenchFrameLen;
+static uint8_t      BenchSeen[BenchReports+1];
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Run every transport that talks to the SIM800 directly and print the cost of
+ *                      a report on each.
+ * INPUTS             : void
+ * RETURNS            : int 0, 1 if a transport lost or repeated reports
+ ***********************************************************************************************/
+int main(void)
+{
+    static const Transport_t *const Transports[]={&HttpTransport,&SignedHttpTransport,&TcpTransport,
+        &SignedTcpTransport,&HttpBatchTransport,&HttpGetBatchTransport,&RecordTcpTransport};
+    uint32_t Index;
+    uint8_t  Failed=0;
+    printf("link: %u ms round trip, %u ms TLS setup, %u baud\n",BenchRtt,BenchTlsSetup,GSMFastBaud);
+    printf("%-15s %8s %8s %8s %9s\n","transport","AT/rep","tx B/rep","rx B/rep","ms/rep");
+    for(Index=0;Index<sizeof(Transports)/sizeof(Transports[0]);Index++)
+    {
+        Failed|=BenchRun(Transports[Index]);
+    }
+    Failed|=BenchOverlong();
+    printf("%s\n",Failed?"FAILED":"all passed");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchRun
+ * Description        : Send BenchReports reports through a transport the way the GSM tasks do: open
+ *                      it every window, then send the pending reports and remove the confirmed
+ *                      ones. The connection of the socket transports stays open between windows.
+ * INPUTS             : const Transport_t *Transport
+ * RETURNS            : uint8_t 0 when the server got every report once, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t BenchRun(const Transport_t *Transport)
+{
+    uint32_t Pushed=0;
+    uint32_t Count;
+    uint32_t Index;
+    uint16_t Status;
+    memset(&BenchStats,0,sizeof(BenchStats));
+    memset(BenchSeen,0,sizeof(BenchSeen));
+    BenchEcho=1;
+    BenchHttps=0;
+    BenchBearer=0;
+    BenchMute=0;
+    BenchNoise=0;
+    BenchHeldLen=0;
+    BenchLineLen=0;
+    BenchDataLeft=0;
+    BenchFrameLen=0;
+    ReportQueueInit();
+    ReportSetNextSeq(1);
+    while(Pushed<BenchReports)
+    {
+        for(Index=0;Index<((Transport->SendBatch!=NULL)?ReportBatchSize:1) && Pushed<BenchReports;Index++)
+        {
+            ReportQueuePush("3112.12345","3002.54321",50,90,0);
+            Pushed++;
+        }
+        if(Transport->Open()!=Gsmok)
+        {
+            break;
+        }
+        while(ReportQueueCount()!=0)
+        {
+            Count=ReportQueueCount();
+            if(Transport->SendBatch!=NULL)
+            {
+                if(TransportSendBatch(Transport,&Count,&Status)!=Gsmok)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                if(TransportSend(Transport,ReportQueuePeek(),&Status)!=Gsmok)
+                {
+                    break;
+                }
+                Count=1;
+            }
+            while(Count--!=0)
+            {
+                ReportQueueAck(Status);
+            }
+        }
+        if(ReportQueueCount()!=0)
+        {
+            break;
+        }
+    }
+    Transport->Close();
+    if(BenchStats.Received!=BenchReports || BenchStats.Duplicates!=0 || BenchStats.Bad!=0)
+    {
+        printf("%-15s FAIL %u of %u reports received, %u duplicates, %u unreadable\n",Transport->Name,
+               (unsigned)BenchStats.Received,BenchReports,(unsigned)BenchStats.Duplicates,(unsigned)BenchStats.Bad);
+        return 1;
+    }
+    printf("%-15s %8.2f %8.1f %8.1f %9.0f\n",Transport->Name,(double)BenchStats.Commands/BenchReports,
+           (double)BenchStats.TxBytes/BenchReports,(double)BenchStats.RxBytes/BenchReports,
+           (double)BenchStats.Us/1000/BenchReports);
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchOverlong
+ * Description        : Let the module put a line longer than the reception before its "OK", so it
+ *                      holds the tail of the line and the "OK", then leave the next command
+ *                      unanswered: the held "OK" must not complete it.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 0 when the unanswered command failed, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t BenchOverlong(void)
+{
+    uint8_t Failed;
+    BenchEcho=1;
+    BenchMute=0;
+    BenchHeldLen=0;
+    BenchLineLen=0;
+    BenchDataLeft=0;
+    BenchNoise=1;
+    if(Sim800CheckHttps()==Gsmok || BenchHeldLen==0)
+    {
+        printf("%-15s FAIL the reply did not overflow its reception\n","over-long reply");
+        return 1;
+    }
+    BenchMute=1;
+    Failed=(Sim800CheckHttps()==Gsmok);
+    printf("%-15s %s\n","over-long reply",Failed?"FAIL a held OK completed the next command":"ok");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchWait
+ * Description        : Let simulated time pass.
+ * INPUTS             : uint32_t Ms
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchWait(uint32_t Ms)
+{
+    BenchStats.Us+=Ms*1000;
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchAnswer
+ * Description        : Send text from the module: it takes its UART time and lands in the armed
+ *                      reception. What does not fit is held behind RTS until the next reception.
+ * INPUTS             : const char *Text
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchAnswer(const char *Text)
+{
+    uint32_t Len=strlen(Text);
+    uint32_t Fit=(BenchRxCount+Len<=BenchRxSize) ? Len : BenchRxSize-BenchRxCount;
+    if(BenchHeldLen!=0)
+    {
+        Fit=0;
+    }
+    memcpy(&BenchRx[BenchRxCount],Text,Fit);
+    BenchRxCount+=Fit;
+    if(Fit<Len && BenchHeldLen+Len-Fit<=BenchLineSize)
+    {
+        memcpy(&BenchHeld[BenchHeldLen],&Text[Fit],Len-Fit);
+        BenchHeldLen+=Len-Fit;
+    }
+    BenchStats.RxBytes+=Len;
+    BenchStats.Us+=(Len*10*1000000U)/GSMFastBaud;
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchModemByte
+ * Description        : Take a byte sent to the module: data of a running AT+CIPSEND or AT+HTTPDATA,
+ *                      or a character of a command line, echoed while echo is on.
+ * INPUTS             : uint8_t Byte
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchModemByte(uint8_t Byte)
+{
+    char Echo[2]={(char)Byte,'\0'};
+    BenchStats.Us+=(10*1000000U)/GSMFastBaud;
+    if(BenchDataLeft!=0)
+    {
+        BenchDataLeft--;
+        if(BenchDataSocket)
+        {
+            if(BenchEcho && Byte!=0)
+            {
+                BenchAnswer(Echo);
+            }
+            BenchServerStream(Byte);
+            if(BenchDataLeft==0)
+            {
+                BenchWait(BenchRtt);
+                BenchAnswer("\r\nSEND OK\r\n");
+            }
+        }
+        else
+        {
+            if(BenchBodyLen<BenchBodySize)
+            {
+                BenchBody[BenchBodyLen++]=Byte;
+            }
+            if(BenchDataLeft==0)
+            {
+                BenchAnswer("\r\nOK\r\n");
+            }
+        }
+        return;
+    }
+    if(BenchEcho)
+    {
+        BenchAnswer(Echo);
+    }
+    if(Byte=='\r')
+    {
+        return;
+    }
+    if(Byte=='\n')
+    {
+        BenchLine[BenchLineLen]='\0';
+        BenchLineLen=0;
+        BenchStats.Commands++;
+        BenchWait(BenchTurnaround);
+        BenchCommand(BenchLine);
+        return;
+    }
+    if(BenchLineLen<BenchLineSize-1)
+    {
+        BenchLine[BenchLineLen++]=(char)Byte;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchCommand
+ * Description        : Answer a command line like a SIM800 with its IP stack and HTTP service.
+ * INPUTS             : const char *Line
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchCommand(const char *Line)
+{
+    char Answer[96];
+    if(BenchMute)
+    {
+        BenchMute=0;
+        return;
+    }
+    if(BenchNoise)
+    {
+        BenchNoise=0;
+        memset(Answer,'x',BenchNoiseLen);
+        Answer[BenchNoiseLen]='\0';
+        BenchAnswer("\r\n");
+        BenchAnswer(Answer);
+        BenchAnswer("\r\n");
+    }
+    if(strcmp(Line,"ATE0")==0 || strcmp(Line,"ATE1")==0)
+    {
+        BenchEcho=(Line[3]=='1');
+    }
+    else if(strncmp(Line,"AT+HTTPSSL=",11)==0)
+    {
+        BenchHttps=(Line[11]=='1');
+    }
+    else if(strncmp(Line,"AT+HTTPPARA=\"URL\",",18)==0)
+    {
+        strcpy(BenchUrl,&Line[18]);
+    }
+    else if(strncmp(Line,"AT+HTTPDATA=",12)==0)
+    {
+        BenchDataLeft=strtoul(&Line[12],NULL,10);
+        BenchDataSocket=0;
+        BenchBodyLen=0;
+        BenchAnswer("\r\nDOWNLOAD\r\n");
+        return;
+    }
+    else if(strncmp(Line,"AT+HTTPACTION=",14)==0)
+    {
+        BenchAnswer("\r\nOK\r\n");
+        BenchWait(2*BenchRtt+(BenchHttps ? 2*BenchRtt+BenchTlsSetup : 0));
+        if(Line[14]=='1')
+        {
+            BenchServerPost();
+        }
+        else
+        {
+            BenchServerGet();
+        }
+        BenchAnswer((Line[14]=='1') ? "\r\n+HTTPACTION: 1,200,0\r\n" : "\r\n+HTTPACTION: 0,200,0\r\n");
+        return;
+    }
+    else if(strcmp(Line,"AT+CIICR")==0)
+    {
+        BenchWait(BenchBearerUp);
+        BenchBearer=1;
+    }
+    else if(strcmp(Line,"AT+CIFSR")==0)
+    {
+        BenchAnswer(BenchBearer ? "\r\n10.64.12.7\r\n" : "\r\nERROR\r\n");
+        return;
+    }
+    else if(strncmp(Line,"AT+CDNSGIP=",11)==0)
+    {
+        BenchAnswer("\r\nOK\r\n");
+        BenchWait(BenchRtt);
+        snprintf(Answer,sizeof(Answer),"\r\n+CDNSGIP: 1,%.40s,\"192.0.2.10\"\r\n",&Line[11]);
+        BenchAnswer(Answer);
+        return;
+    }
+    else if(strncmp(Line,"AT+CIPSTART=",12)==0)
+    {
+        BenchAnswer("\r\nOK\r\n");
+        BenchWait(BenchRtt);
+        BenchFrameLen=0;
+        BenchAnswer("\r\nCONNECT OK\r\n");
+        return;
+    }
+    else if(strncmp(Line,"AT+CIPSEND=",11)==0)
+    {
+        BenchDataLeft=strtoul(&Line[11],NULL,10);
+        BenchDataSocket=1;
+        BenchAnswer("\r\n> ");
+        return;
+    }
+    else if(strcmp(Line,"AT+CIPCLOSE")==0)
+    {
+        BenchAnswer("\r\nCLOSE OK\r\n");
+        return;
+    }
+    BenchAnswer("\r\nOK\r\n");
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchServerSeq
+ * Description        : The server took the report with a sequence number.
+ * INPUTS             : uint32_t Seq
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchServerSeq(uint32_t Seq)
+{
+    if(Seq==0 || Seq>BenchReports)
+    {
+        BenchStats.Bad++;
+    }
+    else if(BenchSeen[Seq])
+    {
+        BenchStats.Duplicates++;
+    }
+    else
+    {
+        BenchSeen[Seq]=1;
+        BenchStats.Received++;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchServerRecords
+ * Description        : The server took a batch of compact records.
+ * INPUTS             : const uint8_t *Data, uint32_t Size
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchServerRecords(const uint8_t *Data,uint32_t Size)
+{
+    Record_t Records[RecordBatchMax];
+    uint32_t Count=RecordDecode(Data,Size,Records,RecordBatchMax);
+    uint32_t Index;
+    if(Count==0)
+    {
+        BenchStats.Bad++;
+    }
+    for(Index=0;Index<Count;Index++)
+    {
+        BenchServerSeq(Records[Index].Seq);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchServerGet
+ * Description        : The server took a GET of the URL set last: a "seq" parameter, or compact
+ *                      records in base64url in the "b" parameter.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchServerGet(void)
+{
+    uint8_t Records[Base64UrlBytes(BenchLineSize)];
+    char *P=strstr(BenchUrl,"&seq=");
+    char *End;
+    if(P!=NULL)
+    {
+        BenchServerSeq(strtoul(P+5,NULL,10));
+    }
+    else if((P=strstr(BenchUrl,"?b="))!=NULL && (End=strchr(P,'"'))!=NULL)
+    {
+        BenchServerRecords(Records,Base64UrlDecode(P+3,End-P-3,Records));
+    }
+    else
+    {
+        BenchStats.Bad++;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchServerPost
+ * Description        : The server took a POST body with one "seq,lat,lon" line per report.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchServerPost(void)
+{
+    uint32_t Index=0;
+    while(Index<BenchBodyLen)
+    {
+        BenchServerSeq(strtoul((const char *)&BenchBody[Index],NULL,10));
+        while(Index<BenchBodyLen && BenchBody[Index]!='\n')
+        {
+            Index++;
+        }
+        Index++;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : BenchServerStream
+ * Description        : Frame the socket data on the server: position and signed position records
+ *                      and batches of compact records, each checked with its XOR checksum.
+ * INPUTS             : uint8_t Byte
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void BenchServerStream(uint8_t Byte)
+{
+    uint32_t Index;
+    uint32_t Size;
+    uint8_t  Checksum=0;
+    if(BenchFrameLen==0 && Byte!=TransportFrameStart)
+    {
+        BenchStats.Bad++;
+        return;
+    }
+    BenchFrame[BenchFrameLen++]=Byte;
+    if(BenchFrameLen<4)
+    {
+        return;
+    }
+    Size=(BenchFrame[1]==TransportFrameRecords) ? (uint32_t)(BenchFrame[2]|(BenchFrame[3]<<8))+5 :
+                                                  (uint32_t)BenchFrame[2]+4;
+    if(Size>sizeof(BenchFrame))
+    {
+        BenchStats.Bad++;
+        BenchFrameLen=0;
+        return;
+    }
+    if(BenchFrameLen<Size)
+    {
+        return;
+    }
+    BenchFrameLen=0;
+    for(Index=1;Index<Size-1;Index++)
+    {
+        Checksum^=BenchFrame[Index];
+    }
+    if(Checksum!=BenchFrame[Size-1])
+    {
+        BenchStats.Bad++;
+    }
+    else if(BenchFrame[1]==TransportFrameRecords)
+    {
+        BenchServerRecords(&BenchFrame[4],Size-5);
+    }
+    else
+    {
+        BenchServerSeq(BenchFrame[3]|(BenchFrame[4]<<8)|(BenchFrame[5]<<16)|((uint32_t)BenchFrame[6]<<24));
+    }
+}
+
+/*******************************************************************************
+ *                Stand-ins of the UART driver, GPS and the kernel             *
+ *******************************************************************************/
+
+/* Arming a reception lowers RTS, the module sends what it held first */
+void GSMReceiveResponse(uint8_t *Response,uint32_t ResponseSize)
+{
+    uint32_t Fit=(BenchHeldLen<=ResponseSize) ? BenchHeldLen : ResponseSize;
+    BenchRx=Response;
+    BenchRxSize=ResponseSize;
+    memcpy(BenchRx,BenchHeld,Fit);
+    BenchRxCount=Fit;
+    BenchHeldLen-=Fit;
+    memmove(BenchHeld,&BenchHeld[Fit],BenchHeldLen);
+}
+
+void GSMSend(uint8_t *CMD_Data,uint32_t DataSize)
+{
+    uint32_t Index;
+    BenchStats.TxBytes+=DataSize;
+    for(Index=0;Index<DataSize;Index++)
+    {
+        BenchModemByte(CMD_Data[Index]);
+    }
+}
+
+uint32_t GSMSendVector(const GSMFragment_t *Fragments,uint32_t Count)
+{
+    uint32_t Index;
+    uint32_t Bytes=0;
+    for(Index=0;Index<Count;Index++)
+    {
+        GSMSend((uint8_t *)Fragments[Index].Data,Fragments[Index].Size);
+        Bytes+=Fragments[Index].Size;
+    }
+    return Bytes;
+}
+
+uint32_t GSMGetTxByteCount(void)
+{
+    return BenchStats.TxBytes;
+}
+
+uint32_t GSMGetRxByteCount(void)
+{
+    return BenchRxCount;
+}
+
+void GSMInit(void)
+{
+}
+
+void GSMSetBaudRate(uint32_t Baud)
+{
+}
+
+void GSMSetDTR(uint8_t High)
+{
+}
+
+void GSMSetPowerKey(uint8_t Pressed)
+{
+}
+
+void GSMSetReset(uint8_t Asserted)
+{
+}
+
+void GSMSetReceptionCallBack(void (*Callback)(void))
+{
+}
+
+void sim800recieve(void)
+{
+}
+
+/* The server does not check the coordinates */
+int32_t GPSToMicroDegrees(const char *Coordinate)
+{
+    return atoi(Coordinate);
+}
+
+void GPSFromMicroDegrees(int32_t MicroDegrees,char *Coordinate)
+{
+    strcpy(Coordinate,"0");
+}
+
+uint32_t TimeNow(void)
+{
+    return 0;
+}
+
+void SysCtlDelay(uint32_t ui32Count)
+{
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return BenchStats.Us/1000;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    BenchWait(xTicksToDelay);
+}
+
+QueueHandle_t xQueueCreateMutex(const uint8_t ucQueueType)
+{
+    return (QueueHandle_t)1;
+}
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue,TickType_t xTicksToWait)
+{
+    return pdTRUE;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue,const void * const pvItemToQueue,TickType_t xTicksToWait,
+                             const BaseType_t xCopyPosition)
+{
+    return pdTRUE;
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+#endif /* TcpHostBuild */
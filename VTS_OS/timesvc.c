@@ -0,0 +1,166 @@
+/******************************************************************************
+ * File Name: timesvc.c
+ *
+ * Description: Source file for the wall clock time service. The UTC time is
+ *              kept as an epoch set at a known tick count: it is disciplined
+ *              from GPS while the fix is valid and falls back to the network
+ *              time of the SIM800 otherwise. TimeNow only adds the ticks
+ *              elapsed since, so buffered records can be stamped cheaply.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "timesvc.h"
+#include "SIM800.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t TimeMakeEpoch(uint32_t Year,uint32_t Month,uint32_t Day,
+                              uint32_t Hour,uint32_t Minute,uint32_t Second);
+static void TimeSet(uint32_t Epoch,TickType_t Tick,TimeSource_t Source);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Unix time in seconds at TimeBaseTick */
+static uint32_t     TimeBaseEpoch=0;
+static TickType_t   TimeBaseTick=0;
+static TimeSource_t TimeSource=TimeNone;
+/* Tick count of the last GPS synchronisation */
+static TickType_t   TimeGpsTick=0;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : TimeSetFromGps
+ * Description        : Discipline the clock with the time and date of a valid GPRMC sentence.
+ * INPUTS             : float Utc (hhmmss.ss), uint32_t Date (ddmmyy)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void TimeSetFromGps(float Utc,uint32_t Date)
+{
+    uint32_t Hms=(uint32_t)Utc;
+    if(Date==0)
+    {
+        return;
+    }
+    TimeSet(TimeMakeEpoch(2000+Date%100,(Date/100)%100,Date/10000,
+                          Hms/10000,(Hms/100)%100,Hms%100),xTaskGetTickCount(),TimeGps);
+    TimeGpsTick=TimeBaseTick;
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeNeedsNetwork
+ * Description        : Check if the network time should be read, GPS did not set the clock lately.
+ * INPUTS             : void
+ * RETURNS            : uint8_t
+ ***********************************************************************************************/
+uint8_t TimeNeedsNetwork(void)
+{
+    return TimeSource!=TimeGps || (xTaskGetTickCount()-TimeGpsTick)>=pdMS_TO_TICKS(TimeGpsHoldover);
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeSyncFromNetwork
+ * Description        : Set the clock from the clock of the module, converted from local time to
+ *                      UTC. Must be called with the module taken (Sim800Take).
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t TimeSyncFromNetwork(void)
+{
+    Sim800Clock_t Clock;
+    TickType_t Tick=xTaskGetTickCount();
+    uint32_t Epoch;
+    if(Sim800GetClock(&Clock)!=Gsmok || Clock.Year<TimeMinYear)
+    {
+        return GsmError;
+    }
+    Epoch=TimeMakeEpoch(2000+Clock.Year,Clock.Month,Clock.Day,Clock.Hour,Clock.Minute,Clock.Second);
+    Epoch-=(int32_t)Clock.Zone*15*60;
+    TimeSet(Epoch,Tick,TimeNetwork);
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeNow
+ * Description        : Current UTC time.
+ * INPUTS             : void
+ * RETURNS            : uint32_t Unix time in seconds, 0 if the clock was never set
+ ***********************************************************************************************/
+uint32_t TimeNow(void)
+{
+    uint32_t Epoch;
+    TickType_t Tick;
+    taskENTER_CRITICAL();
+    Epoch=TimeBaseEpoch;
+    Tick=TimeBaseTick;
+    taskEXIT_CRITICAL();
+    if(Epoch==0)
+    {
+        return 0;
+    }
+    return Epoch+((xTaskGetTickCount()-Tick)*portTICK_PERIOD_MS)/1000;
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeGetSource
+ * Description        : Where the clock was last set from.
+ * INPUTS             : void
+ * RETURNS            : TimeSource_t
+ ***********************************************************************************************/
+TimeSource_t TimeGetSource(void)
+{
+    return TimeSource;
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeSet
+ * Description        : Move the epoch base to a new reference.
+ * INPUTS             : uint32_t Epoch, TickType_t Tick (tick count at Epoch), TimeSource_t Source
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TimeSet(uint32_t Epoch,TickType_t Tick,TimeSource_t Source)
+{
+    taskENTER_CRITICAL();
+    TimeBaseEpoch=Epoch;
+    TimeBaseTick=Tick;
+    TimeSource=Source;
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeMakeEpoch
+ * Description        : Convert a UTC date and time to Unix time (days from the civil calendar).
+ * INPUTS             : uint32_t Year, Month (1..12), Day, Hour, Minute, Second
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t TimeMakeEpoch(uint32_t Year,uint32_t Month,uint32_t Day,
+                              uint32_t Hour,uint32_t Minute,uint32_t Second)
+{
+    uint32_t Era;
+    uint32_t YearOfEra;
+    uint32_t DayOfYear;
+    uint32_t DayOfEra;
+    // Years start in March so the leap day is the last one
+    if(Month<=2)
+    {
+        Year--;
+    }
+    Era=Year/400;
+    YearOfEra=Year-Era*400;
+    DayOfYear=(153*(Month>2 ? Month-3 : Month+9)+2)/5+Day-1;
+    DayOfEra=YearOfEra*365+YearOfEra/4-YearOfEra/100+DayOfYear;
+    // 719468 days from 0000-03-01 to 1970-01-01
+    return (Era*146097+DayOfEra-719468)*86400+Hour*3600+Minute*60+Second;
+}
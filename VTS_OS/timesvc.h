@@ -0,0 +1,42 @@
+/******************************************************************************
+ * File Name: timesvc.h
+ *
+ * Description: Header file for the wall clock time service.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_TIMESVC_H_
+#define SRC_TIMESVC_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Time in ms a GPS synchronisation is trusted before the network time is used again */
+#define TimeGpsHoldover     600000
+/* Earlier years (since 2000) are the unset clock of the module, not network time */
+#define TimeMinYear         23
+
+typedef enum{
+    TimeNone=0,              /* Never synchronised, TimeNow returns 0 */
+    TimeNetwork,             /* Clock of the module, set by the network (NITZ) */
+    TimeGps                  /* Date and time of the last valid GPRMC */
+}TimeSource_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+void TimeSetFromGps(float Utc,uint32_t Date);
+uint8_t TimeNeedsNetwork(void);
+uint32_t TimeSyncFromNetwork(void);
+uint32_t TimeNow(void);
+TimeSource_t TimeGetSource(void);
+
+#endif /* SRC_TIMESVC_H_ */
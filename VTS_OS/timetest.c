@@ -0,0 +1,258 @@
+/******************************************************************************
+ * File Name: timetest.c
+ *
+ * Description: Host test of the network time fallback. TimeSyncFromNetwork
+ *              runs unchanged on the SIM800 driver, a stand-in of the module
+ *              answers AT+CCLK? with its clock as the SIM800 does, with echo
+ *              on or off, and the time kept by the service is checked against
+ *              the UTC time of that clock. Builds with TimeHostBuild defined
+ *              only, with timesvc.c and SIM800.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(TimeHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "timesvc.h"
+#include "SIM800.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define TimeTestLineSize    64
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t TimeTestCheck(const char *Name,uint8_t Passed);
+static void TimeTestAnswer(const char *Text);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static TickType_t   TimeTestNow;
+/* Reception armed by GSMReceiveResponse */
+static uint8_t     *TimeTestRx;
+static uint32_t     TimeTestRxSize;
+static uint32_t     TimeTestRxCount;
+/* Module state: echo, the command line being received and the answer of AT+CCLK? */
+static uint8_t      TimeTestEcho;
+static char         TimeTestLine[TimeTestLineSize];
+static uint32_t     TimeTestLineLen;
+static const char  *TimeTestClock;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Synchronise from the network clock in the cases the module answers.
+ * INPUTS             : void
+ * RETURNS            : int 0, 1 if a case failed
+ ***********************************************************************************************/
+int main(void)
+{
+    uint8_t Failed=0;
+    TimeTestNow=1000;
+    Failed|=TimeTestCheck("unset before sync",TimeNow()==0 && TimeGetSource()==TimeNone);
+    //Echo on: 2023-08-27 10:15:30 at UTC+2 (8 quarter hours)
+    TimeTestEcho=1;
+    TimeTestClock="+CCLK: \"23/08/27,10:15:30+08\"";
+    Failed|=TimeTestCheck("echo on, east of UTC",TimeSyncFromNetwork()==Gsmok &&
+                          TimeGetSource()==TimeNetwork && TimeNow()==1693124130U);
+    TimeTestNow+=pdMS_TO_TICKS(90000);
+    Failed|=TimeTestCheck("clock runs on the ticks",TimeNow()==1693124130U+90);
+    //Echo off: 2023-12-31 22:00:00 at UTC-5 is the next year in UTC
+    TimeTestEcho=0;
+    TimeTestClock="+CCLK: \"23/12/31,22:00:00-20\"";
+    Failed|=TimeTestCheck("echo off, west of UTC",TimeSyncFromNetwork()==Gsmok && TimeNow()==1704078000U);
+    //A module clock the network never set is not used
+    TimeTestClock="+CCLK: \"04/01/01,00:01:10+00\"";
+    Failed|=TimeTestCheck("unset module clock",TimeSyncFromNetwork()!=Gsmok && TimeNow()==1704078000U);
+    TimeTestClock=NULL;
+    Failed|=TimeTestCheck("ERROR answer",TimeSyncFromNetwork()!=Gsmok);
+    printf("%s\n",Failed?"FAILED":"all passed");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeTestCheck
+ * Description        : Print the result of a case.
+ * INPUTS             : const char *Name, uint8_t Passed
+ * RETURNS            : uint8_t 0 when the case passed, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t TimeTestCheck(const char *Name,uint8_t Passed)
+{
+    printf("%-28s %s\n",Name,Passed?"ok":"FAIL");
+    return !Passed;
+}
+
+/***********************************************************************************************
+ * Function Name      : TimeTestAnswer
+ * Description        : Send text from the module into the armed reception.
+ * INPUTS             : const char *Text
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TimeTestAnswer(const char *Text)
+{
+    uint32_t Len=strlen(Text);
+    if(TimeTestRxCount+Len>TimeTestRxSize)
+    {
+        Len=TimeTestRxSize-TimeTestRxCount;
+    }
+    memcpy(&TimeTestRx[TimeTestRxCount],Text,Len);
+    TimeTestRxCount+=Len;
+}
+
+/*******************************************************************************
+ *                   Stand-ins of the module, the UART driver and the kernel   *
+ *******************************************************************************/
+
+/* Echo the command and answer it once its line is complete */
+void GSMSend(uint8_t *CMD_Data,uint32_t DataSize)
+{
+    char Answer[TimeTestLineSize];
+    uint32_t Index;
+    for(Index=0;Index<DataSize;Index++)
+    {
+        if(TimeTestEcho)
+        {
+            Answer[0]=(char)CMD_Data[Index];
+            Answer[1]='\0';
+            TimeTestAnswer(Answer);
+        }
+        if(CMD_Data[Index]=='\r' || TimeTestLineLen==TimeTestLineSize-1)
+        {
+            continue;
+        }
+        if(CMD_Data[Index]!='\n')
+        {
+            TimeTestLine[TimeTestLineLen++]=(char)CMD_Data[Index];
+            continue;
+        }
+        TimeTestLine[TimeTestLineLen]='\0';
+        TimeTestLineLen=0;
+        if(strcmp(TimeTestLine,"AT+CCLK?")==0 && TimeTestClock!=NULL)
+        {
+            snprintf(Answer,sizeof(Answer),"\r\n%s\r\n\r\nOK\r\n",TimeTestClock);
+            TimeTestAnswer(Answer);
+        }
+        else
+        {
+            TimeTestAnswer("\r\nERROR\r\n");
+        }
+    }
+}
+
+void GSMReceiveResponse(uint8_t *Response,uint32_t ResponseSize)
+{
+    TimeTestRx=Response;
+    TimeTestRxSize=ResponseSize;
+    TimeTestRxCount=0;
+}
+
+uint32_t GSMSendVector(const GSMFragment_t *Fragments,uint32_t Count)
+{
+    uint32_t Index;
+    uint32_t Bytes=0;
+    for(Index=0;Index<Count;Index++)
+    {
+        GSMSend((uint8_t *)Fragments[Index].Data,Fragments[Index].Size);
+        Bytes+=Fragments[Index].Size;
+    }
+    return Bytes;
+}
+
+uint32_t GSMGetTxByteCount(void)
+{
+    return 0;
+}
+
+uint32_t GSMGetRxByteCount(void)
+{
+    return TimeTestRxCount;
+}
+
+void GSMInit(void)
+{
+}
+
+void GSMSetBaudRate(uint32_t Baud)
+{
+}
+
+void GSMSetDTR(uint8_t High)
+{
+}
+
+void GSMSetPowerKey(uint8_t Pressed)
+{
+}
+
+void GSMSetReset(uint8_t Asserted)
+{
+}
+
+void GSMSetReceptionCallBack(void (*Callback)(void))
+{
+}
+
+void sim800recieve(void)
+{
+}
+
+void SysCtlDelay(uint32_t ui32Count)
+{
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return TimeTestNow;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    TimeTestNow+=xTicksToDelay;
+}
+
+QueueHandle_t xQueueCreateMutex(const uint8_t ucQueueType)
+{
+    return (QueueHandle_t)1;
+}
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue,TickType_t xTicksToWait)
+{
+    return pdTRUE;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue,const void * const pvItemToQueue,TickType_t xTicksToWait,
+                             const BaseType_t xCopyPosition)
+{
+    return pdTRUE;
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+#endif /* TimeHostBuild */
@@ -64,6 +64,7 @@ extern void vPortSVCHandler( void );
 void UART2_ISR(void);
 void UART1_ISR(void);
 void UART0_ISR(void);
+void GPIOD_ISR(void);
 //*****************************************************************************
 //
 // The vector table.  Note that the proper constructs must be placed on this to
@@ -94,7 +95,7 @@ void (* const g_pfnVectors[])(void)__attribute__ ((section(".intvecs"))) =
     IntDefaultHandler,                      // GPIO Port A
     IntDefaultHandler,                      // GPIO Port B
     IntDefaultHandler,                      // GPIO Port C
-    IntDefaultHandler,                      // GPIO Port D
+    GPIOD_ISR,                              // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
     UART0_ISR,                              // UART0 Rx and Tx
     UART1_ISR,                              // UART1 Rx and Tx
@@ -0,0 +1,680 @@
+/******************************************************************************
+ * File Name: track.c
+ *
+ * Description: Source file for the columnar track block. A block holds the
+ *              fixes of one flash page, every field in its own column so that
+ *              similar values sit together:
+ *
+ *              header  : 'T' | speed step | heading step | chunks | count (u16)
+ *                        | seq | time | lat | lon (u32) | CRC-32
+ *              time    : delta-of-delta bits, '0' for the same interval again,
+ *                        then '10'+7, '110'+9, '1110'+12 or '1111'+32 bits
+ *              seq     : zig-zag seq steps
+ *              pos     : zig-zag micro degree deltas of lat and lon
+ *              speed   : speed / speed step
+ *              heading : course / heading step, priority in bit 0
+ *
+ *              Every field but the time is a LEB128 varint whose bit 0 tells
+ *              a value (0) from a run of repeats of the last one (1), a run of
+ *              the pos column repeating a zero move. The header values are
+ *              those of the first fix. The columns grow in chunks of
+ *              TrackChunkSize bytes tagged with their column, taken from the
+ *              page in the order they fill, so the encoder needs the page
+ *              image and a few bytes of state only.
+ *
+ *              The speed and the heading are quantised with the steps of the
+ *              block and, while stopped, moves within TrackStillRadius are
+ *              taken as GPS noise. A parked vehicle then costs a bit a fix and
+ *              the file has no target dependency, the decoder builds on the
+ *              host as well.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "track.h"
+#include "crc32.h"
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define TrackZigZag(V)      (((uint32_t)(V)<<1)^(uint32_t)((int32_t)(V)>>31))
+#define TrackUnZigZag(V)    ((int32_t)((V)>>1)^-(int32_t)((V)&1))
+/* Header offsets */
+#define TrackHdrCount       4
+#define TrackHdrSeq         6
+#define TrackHdrTime        10
+#define TrackHdrLat         14
+#define TrackHdrLon         18
+#define TrackHdrCrc         22
+
+typedef struct{
+    const uint8_t *Block;
+    uint8_t  Chunks[TrackChunks];  /* Chunks of the column in the block order */
+    uint8_t  Count;
+    uint8_t  Index;          /* Chunk being read */
+    uint8_t  Pos;            /* Bytes read from it */
+    uint8_t  Bit;            /* Bits read from Byte, time column only */
+    uint8_t  Byte;
+    uint32_t Last;
+    uint32_t Run;            /* Repeats still to return */
+}TrackReader_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t TrackRoom(const TrackEncoder_t *Enc);
+static void TrackPutByte(TrackEncoder_t *Enc,uint8_t Column,uint8_t Byte);
+static void TrackPutVarint(TrackEncoder_t *Enc,uint8_t Column,uint64_t Value);
+static void TrackPutBits(TrackEncoder_t *Enc,uint32_t Value,uint8_t Bits);
+static void TrackPutDod(TrackEncoder_t *Enc,uint32_t Dod);
+static void TrackPutRun(TrackEncoder_t *Enc,uint8_t Column,uint32_t Value);
+static void TrackPutPos(TrackEncoder_t *Enc,int32_t DLat,int32_t DLon);
+static void TrackFlushRun(TrackEncoder_t *Enc,uint8_t Column);
+static uint8_t TrackGetByte(TrackReader_t *Reader,uint8_t *Byte);
+static uint8_t TrackGetVarint(TrackReader_t *Reader,uint64_t *Value);
+static uint8_t TrackGetBits(TrackReader_t *Reader,uint8_t Bits,uint32_t *Value);
+static uint8_t TrackGetDod(TrackReader_t *Reader,uint32_t *Dod);
+static uint8_t TrackGetRun(TrackReader_t *Reader,uint32_t *Value);
+static uint8_t TrackGetPos(TrackReader_t *Reader,int32_t *DLat,int32_t *DLon);
+static void TrackPutU32(uint8_t *Buf,uint32_t Value);
+static uint32_t TrackGetU32(const uint8_t *Buf);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Most bytes a fix adds to each column, a pending run included */
+static const uint8_t TrackWorst[TrackColumns]={5,8,16,6,6};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : TrackEncoderInit
+ * Description        : Start an empty block in a page image.
+ * INPUTS             : TrackEncoder_t *Enc, uint8_t *Block (TrackBlockSize bytes),
+ *                      uint8_t SpeedStep (km/h), uint8_t HeadingStep (degrees)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void TrackEncoderInit(TrackEncoder_t *Enc,uint8_t *Block,uint8_t SpeedStep,uint8_t HeadingStep)
+{
+    memset(Enc,0,sizeof(*Enc));
+    Enc->Block=Block;
+    Enc->SpeedStep=(SpeedStep!=0)?SpeedStep:1;
+    Enc->HeadingStep=(HeadingStep!=0)?HeadingStep:1;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackEncode
+ * Description        : Append a fix to the block. Nothing is written when the block cannot take
+ *                      a fix of the worst size anymore, finish it and start the next one.
+ * INPUTS             : TrackEncoder_t *Enc, const Record_t *Record
+ * RETURNS            : uint8_t 1 if the fix was appended
+ ***********************************************************************************************/
+uint8_t TrackEncode(TrackEncoder_t *Enc,const Record_t *Record)
+{
+    uint32_t Speed=((uint32_t)Record->Speed+Enc->SpeedStep/2)/Enc->SpeedStep;
+    uint32_t Heading=(((uint32_t)(Record->Course%360)/Enc->HeadingStep)<<1)|(Record->Flags&RecordFlagPriority);
+    int32_t  Delta;
+    int32_t  DLat;
+    int32_t  DLon;
+    if(Enc->Count==TrackRunMax || !TrackRoom(Enc))
+    {
+        return 0;
+    }
+    if(Enc->Count==0)
+    {
+        TrackPutU32(&Enc->Block[TrackHdrSeq],Record->Seq);
+        TrackPutU32(&Enc->Block[TrackHdrTime],Record->Time);
+        TrackPutU32(&Enc->Block[TrackHdrLat],(uint32_t)Record->Lat);
+        TrackPutU32(&Enc->Block[TrackHdrLon],(uint32_t)Record->Lon);
+        Enc->Prev=*Record;
+    }
+    else
+    {
+        Delta=(int32_t)(Record->Time-Enc->Prev.Time);
+        TrackPutDod(Enc,(uint32_t)Delta-(uint32_t)Enc->Delta);
+        Enc->Delta=Delta;
+        TrackPutRun(Enc,TrackColSeq,TrackZigZag(Record->Seq-Enc->Prev.Seq));
+        DLat=Record->Lat-Enc->Prev.Lat;
+        DLon=Record->Lon-Enc->Prev.Lon;
+        if(Speed==0 && DLat>=-TrackStillRadius && DLat<=TrackStillRadius &&
+           DLon>=-TrackStillRadius && DLon<=TrackStillRadius)
+        {
+            DLat=0;
+            DLon=0;
+        }
+        TrackPutPos(Enc,DLat,DLon);
+        Enc->Prev.Seq=Record->Seq;
+        Enc->Prev.Time=Record->Time;
+        Enc->Prev.Lat+=DLat;
+        Enc->Prev.Lon+=DLon;
+    }
+    TrackPutRun(Enc,TrackColSpeed,Speed);
+    TrackPutRun(Enc,TrackColHeading,Heading);
+    Enc->Count++;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackEncoderFinish
+ * Description        : Write the pending runs and the header of the block.
+ * INPUTS             : TrackEncoder_t *Enc
+ * RETURNS            : uint32_t block size, 0 for a block without fixes
+ ***********************************************************************************************/
+uint32_t TrackEncoderFinish(TrackEncoder_t *Enc)
+{
+    uint8_t  Column;
+    uint32_t Size;
+    uint32_t Crc;
+    if(Enc->Count==0)
+    {
+        return 0;
+    }
+    for(Column=TrackColSeq;Column<TrackColumns;Column++)
+    {
+        TrackFlushRun(Enc,Column);
+    }
+    Size=TrackHeaderSize+(uint32_t)Enc->Chunks*TrackChunkSize;
+    Enc->Block[0]=TrackBlockType;
+    Enc->Block[1]=Enc->SpeedStep;
+    Enc->Block[2]=Enc->HeadingStep;
+    Enc->Block[3]=Enc->Chunks;
+    Enc->Block[TrackHdrCount]=(uint8_t)Enc->Count;
+    Enc->Block[TrackHdrCount+1]=(uint8_t)(Enc->Count>>8);
+    Crc=Crc32(Enc->Block,TrackHdrCrc);
+    Crc^=Crc32(&Enc->Block[TrackHeaderSize],Size-TrackHeaderSize);
+    TrackPutU32(&Enc->Block[TrackHdrCrc],Crc);
+    return Size;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackDecode
+ * Description        : Read the fixes of a block back, with the speed and the course rounded to
+ *                      the steps of the block and the priority flag in Flags.
+ * INPUTS             : const uint8_t *Block, uint32_t Size, Record_t *Records, uint32_t MaxRecords
+ * RETURNS            : uint32_t number of fixes decoded, 0 for a malformed block
+ ***********************************************************************************************/
+uint32_t TrackDecode(const uint8_t *Block,uint32_t Size,Record_t *Records,uint32_t MaxRecords)
+{
+    TrackReader_t Readers[TrackColumns];
+    Record_t Fix;
+    uint32_t Count;
+    uint32_t Index;
+    uint32_t Value;
+    uint32_t Delta=0;
+    int32_t  DLat;
+    int32_t  DLon;
+    uint8_t  Column;
+    if(Size<TrackHeaderSize || Block[0]!=TrackBlockType || Block[1]==0 || Block[2]==0 ||
+       Block[3]>TrackChunks || Size<TrackHeaderSize+(uint32_t)Block[3]*TrackChunkSize)
+    {
+        return 0;
+    }
+    Size=TrackHeaderSize+(uint32_t)Block[3]*TrackChunkSize;
+    if((Crc32(Block,TrackHdrCrc)^Crc32(&Block[TrackHeaderSize],Size-TrackHeaderSize))!=TrackGetU32(&Block[TrackHdrCrc]))
+    {
+        return 0;
+    }
+    memset(Readers,0,sizeof(Readers));
+    for(Index=0;Index<Block[3];Index++)
+    {
+        Column=Block[TrackHeaderSize+Index*TrackChunkSize];
+        if(Column>=TrackColumns)
+        {
+            return 0;
+        }
+        Readers[Column].Chunks[Readers[Column].Count++]=(uint8_t)Index;
+    }
+    for(Column=0;Column<TrackColumns;Column++)
+    {
+        Readers[Column].Block=Block;
+    }
+    Count=(uint32_t)Block[TrackHdrCount]|((uint32_t)Block[TrackHdrCount+1]<<8);
+    if(Count>MaxRecords)
+    {
+        Count=MaxRecords;
+    }
+    Fix.Seq=TrackGetU32(&Block[TrackHdrSeq]);
+    Fix.Time=TrackGetU32(&Block[TrackHdrTime]);
+    Fix.Lat=(int32_t)TrackGetU32(&Block[TrackHdrLat]);
+    Fix.Lon=(int32_t)TrackGetU32(&Block[TrackHdrLon]);
+    for(Index=0;Index<Count;Index++)
+    {
+        if(Index!=0)
+        {
+            if(!TrackGetDod(&Readers[TrackColTime],&Value))
+            {
+                return 0;
+            }
+            Delta+=Value;
+            Fix.Time+=Delta;
+            if(!TrackGetRun(&Readers[TrackColSeq],&Value) ||
+               !TrackGetPos(&Readers[TrackColPos],&DLat,&DLon))
+            {
+                return 0;
+            }
+            Fix.Seq+=(uint32_t)TrackUnZigZag(Value);
+            Fix.Lat+=DLat;
+            Fix.Lon+=DLon;
+        }
+        if(!TrackGetRun(&Readers[TrackColSpeed],&Value))
+        {
+            return 0;
+        }
+        Fix.Speed=(uint16_t)(Value*Block[1]);
+        if(!TrackGetRun(&Readers[TrackColHeading],&Value))
+        {
+            return 0;
+        }
+        Fix.Course=(uint16_t)((Value>>1)*Block[2]);
+        Fix.Flags=(uint8_t)(Value&RecordFlagPriority);
+        Records[Index]=Fix;
+    }
+    return Count;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackRoom
+ * Description        : Check the free chunks cover a fix of the worst size in every column.
+ * INPUTS             : const TrackEncoder_t *Enc
+ * RETURNS            : uint8_t 1 if the next fix fits
+ ***********************************************************************************************/
+static uint8_t TrackRoom(const TrackEncoder_t *Enc)
+{
+    uint32_t Needed=0;
+    uint32_t Room;
+    uint8_t  Column;
+    for(Column=0;Column<TrackColumns;Column++)
+    {
+        Room=(Enc->Col[Column].Chunk!=0)?(uint32_t)(TrackChunkData-Enc->Col[Column].Pos):0;
+        if(TrackWorst[Column]>Room)
+        {
+            Needed+=(TrackWorst[Column]-Room+TrackChunkData-1)/TrackChunkData;
+        }
+    }
+    return (Enc->Chunks+Needed)<=TrackChunks;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackPutByte
+ * Description        : Append a byte to a column, taking the next chunk of the page when the
+ *                      current one is full.
+ * INPUTS             : TrackEncoder_t *Enc, uint8_t Column, uint8_t Byte
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackPutByte(TrackEncoder_t *Enc,uint8_t Column,uint8_t Byte)
+{
+    TrackColumn_t *Col=&Enc->Col[Column];
+    uint32_t Offset;
+    if(Col->Chunk==0 || Col->Pos==TrackChunkData)
+    {
+        Offset=TrackHeaderSize+(uint32_t)Enc->Chunks*TrackChunkSize;
+        Enc->Block[Offset]=Column;
+        Col->Chunk=(uint16_t)(Offset+1);
+        Col->Pos=0;
+        Enc->Chunks++;
+    }
+    Enc->Block[Col->Chunk+Col->Pos]=Byte;
+    Col->Pos++;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackPutVarint
+ * Description        : Append a LEB128 varint to a column, a 32 bit value with the run bit takes
+ *                      up to 5 bytes.
+ * INPUTS             : TrackEncoder_t *Enc, uint8_t Column, uint64_t Value (below 2^33)
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackPutVarint(TrackEncoder_t *Enc,uint8_t Column,uint64_t Value)
+{
+    while(Value>=0x80)
+    {
+        TrackPutByte(Enc,Column,(uint8_t)(Value|0x80));
+        Value>>=7;
+    }
+    TrackPutByte(Enc,Column,(uint8_t)Value);
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackPutBits
+ * Description        : Append bits to the time column, most significant first.
+ * INPUTS             : TrackEncoder_t *Enc, uint32_t Value, uint8_t Bits (1 to 32)
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackPutBits(TrackEncoder_t *Enc,uint32_t Value,uint8_t Bits)
+{
+    TrackColumn_t *Col=&Enc->Col[TrackColTime];
+    while(Bits!=0)
+    {
+        Bits--;
+        if(Col->Bit==0)
+        {
+            TrackPutByte(Enc,TrackColTime,0);
+        }
+        if((Value>>Bits)&1)
+        {
+            Enc->Block[Col->Chunk+Col->Pos-1]|=(uint8_t)(0x80>>Col->Bit);
+        }
+        Col->Bit=(uint8_t)((Col->Bit+1)&7);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackPutDod
+ * Description        : Append the change of the time interval with the shortest prefix that holds
+ *                      it. Fixes taken at a steady rate cost a single bit.
+ * INPUTS             : TrackEncoder_t *Enc, uint32_t Dod (two's complement)
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackPutDod(TrackEncoder_t *Enc,uint32_t Dod)
+{
+    int32_t Signed=(int32_t)Dod;
+    if(Signed==0)
+    {
+        TrackPutBits(Enc,0x0,1);
+    }
+    else if(Signed>=-63 && Signed<=64)
+    {
+        TrackPutBits(Enc,0x2,2);
+        TrackPutBits(Enc,(uint32_t)(Signed+63),7);
+    }
+    else if(Signed>=-255 && Signed<=256)
+    {
+        TrackPutBits(Enc,0x6,3);
+        TrackPutBits(Enc,(uint32_t)(Signed+255),9);
+    }
+    else if(Signed>=-2047 && Signed<=2048)
+    {
+        TrackPutBits(Enc,0xE,4);
+        TrackPutBits(Enc,(uint32_t)(Signed+2047),12);
+    }
+    else
+    {
+        TrackPutBits(Enc,0xF,4);
+        TrackPutBits(Enc,Dod,32);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackPutRun
+ * Description        : Append a value to a run column. A repeat of the last value only counts,
+ *                      the run is written once a different value comes or the block is finished.
+ * INPUTS             : TrackEncoder_t *Enc, uint8_t Column, uint32_t Value
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackPutRun(TrackEncoder_t *Enc,uint8_t Column,uint32_t Value)
+{
+    TrackColumn_t *Col=&Enc->Col[Column];
+    if(Col->Chunk!=0 && Value==Col->Last)
+    {
+        if(Col->Run==TrackRunMax)
+        {
+            TrackFlushRun(Enc,Column);
+        }
+        Col->Run++;
+        return;
+    }
+    TrackFlushRun(Enc,Column);
+    TrackPutVarint(Enc,Column,(uint64_t)Value<<1);
+    Col->Last=Value;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackPutPos
+ * Description        : Append a move to the pos column, a zero move counting in a run.
+ * INPUTS             : TrackEncoder_t *Enc, int32_t DLat, int32_t DLon (micro degrees)
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackPutPos(TrackEncoder_t *Enc,int32_t DLat,int32_t DLon)
+{
+    TrackColumn_t *Col=&Enc->Col[TrackColPos];
+    if(DLat==0 && DLon==0)
+    {
+        if(Col->Run==TrackRunMax)
+        {
+            TrackFlushRun(Enc,TrackColPos);
+        }
+        Col->Run++;
+        return;
+    }
+    TrackFlushRun(Enc,TrackColPos);
+    TrackPutVarint(Enc,TrackColPos,(uint64_t)TrackZigZag(DLat)<<1);
+    TrackPutVarint(Enc,TrackColPos,TrackZigZag(DLon));
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackFlushRun
+ * Description        : Write the pending run of a column.
+ * INPUTS             : TrackEncoder_t *Enc, uint8_t Column
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackFlushRun(TrackEncoder_t *Enc,uint8_t Column)
+{
+    if(Enc->Col[Column].Run!=0)
+    {
+        TrackPutVarint(Enc,Column,((uint32_t)Enc->Col[Column].Run<<1)|1);
+        Enc->Col[Column].Run=0;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackGetByte
+ * Description        : Read the next byte of a column, following its chunks.
+ * INPUTS             : TrackReader_t *Reader, uint8_t *Byte
+ * RETURNS            : uint8_t 0 past the end of the column
+ ***********************************************************************************************/
+static uint8_t TrackGetByte(TrackReader_t *Reader,uint8_t *Byte)
+{
+    if(Reader->Pos==TrackChunkData)
+    {
+        Reader->Index++;
+        Reader->Pos=0;
+    }
+    if(Reader->Index>=Reader->Count)
+    {
+        return 0;
+    }
+    *Byte=Reader->Block[TrackHeaderSize+(uint32_t)Reader->Chunks[Reader->Index]*TrackChunkSize+1+Reader->Pos];
+    Reader->Pos++;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackGetVarint
+ * Description        : Read a LEB128 varint of a column.
+ * INPUTS             : TrackReader_t *Reader, uint64_t *Value
+ * RETURNS            : uint8_t 0 when the varint is cut or longer than 5 bytes
+ ***********************************************************************************************/
+static uint8_t TrackGetVarint(TrackReader_t *Reader,uint64_t *Value)
+{
+    uint8_t Byte;
+    uint8_t Shift;
+    *Value=0;
+    for(Shift=0;Shift<35;Shift+=7)
+    {
+        if(!TrackGetByte(Reader,&Byte))
+        {
+            return 0;
+        }
+        *Value|=(uint64_t)(Byte&0x7F)<<Shift;
+        if((Byte&0x80)==0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackGetBits
+ * Description        : Read bits of the time column, most significant first.
+ * INPUTS             : TrackReader_t *Reader, uint8_t Bits (1 to 32), uint32_t *Value
+ * RETURNS            : uint8_t 0 past the end of the column
+ ***********************************************************************************************/
+static uint8_t TrackGetBits(TrackReader_t *Reader,uint8_t Bits,uint32_t *Value)
+{
+    *Value=0;
+    while(Bits!=0)
+    {
+        if(Reader->Bit==0 && !TrackGetByte(Reader,&Reader->Byte))
+        {
+            return 0;
+        }
+        *Value=(*Value<<1)|((Reader->Byte>>(7-Reader->Bit))&1);
+        Reader->Bit=(uint8_t)((Reader->Bit+1)&7);
+        Bits--;
+    }
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackGetDod
+ * Description        : Read a change of the time interval.
+ * INPUTS             : TrackReader_t *Reader, uint32_t *Dod (two's complement)
+ * RETURNS            : uint8_t 0 past the end of the column
+ ***********************************************************************************************/
+static uint8_t TrackGetDod(TrackReader_t *Reader,uint32_t *Dod)
+{
+    uint32_t Bit;
+    uint8_t  Ones=0;
+    /* The prefix is up to four bits, the ones before the first zero select the width */
+    while(Ones<4)
+    {
+        if(!TrackGetBits(Reader,1,&Bit))
+        {
+            return 0;
+        }
+        if(Bit==0)
+        {
+            break;
+        }
+        Ones++;
+    }
+    switch(Ones)
+    {
+    case 0:
+        *Dod=0;
+        return 1;
+    case 1:
+        if(!TrackGetBits(Reader,7,Dod)) return 0;
+        *Dod-=63;
+        return 1;
+    case 2:
+        if(!TrackGetBits(Reader,9,Dod)) return 0;
+        *Dod-=255;
+        return 1;
+    case 3:
+        if(!TrackGetBits(Reader,12,Dod)) return 0;
+        *Dod-=2047;
+        return 1;
+    default:
+        return TrackGetBits(Reader,32,Dod);
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackGetRun
+ * Description        : Read the next value of a run column.
+ * INPUTS             : TrackReader_t *Reader, uint32_t *Value
+ * RETURNS            : uint8_t 0 past the end of the column or for an empty run
+ ***********************************************************************************************/
+static uint8_t TrackGetRun(TrackReader_t *Reader,uint32_t *Value)
+{
+    uint64_t Entry;
+    if(Reader->Run==0)
+    {
+        if(!TrackGetVarint(Reader,&Entry))
+        {
+            return 0;
+        }
+        if(Entry&1)
+        {
+            if((Entry>>1)==0)
+            {
+                return 0;
+            }
+            Reader->Run=(uint32_t)(Entry>>1);
+        }
+        else
+        {
+            Reader->Last=(uint32_t)(Entry>>1);
+            *Value=Reader->Last;
+            return 1;
+        }
+    }
+    Reader->Run--;
+    *Value=Reader->Last;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackGetPos
+ * Description        : Read the next move of the pos column.
+ * INPUTS             : TrackReader_t *Reader, int32_t *DLat, int32_t *DLon
+ * RETURNS            : uint8_t 0 past the end of the column or for an empty run
+ ***********************************************************************************************/
+static uint8_t TrackGetPos(TrackReader_t *Reader,int32_t *DLat,int32_t *DLon)
+{
+    uint64_t Entry;
+    *DLat=0;
+    *DLon=0;
+    if(Reader->Run==0)
+    {
+        if(!TrackGetVarint(Reader,&Entry))
+        {
+            return 0;
+        }
+        if(Entry&1)
+        {
+            if((Entry>>1)==0)
+            {
+                return 0;
+            }
+            Reader->Run=(uint32_t)(Entry>>1);
+        }
+        else
+        {
+            *DLat=TrackUnZigZag((uint32_t)(Entry>>1));
+            if(!TrackGetVarint(Reader,&Entry))
+            {
+                return 0;
+            }
+            *DLon=TrackUnZigZag((uint32_t)Entry);
+            return 1;
+        }
+    }
+    Reader->Run--;
+    return 1;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackPutU32
+ * Description        : Store a 32 bit value little endian.
+ * INPUTS             : uint8_t *Buf, uint32_t Value
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackPutU32(uint8_t *Buf,uint32_t Value)
+{
+    Buf[0]=(uint8_t)Value;
+    Buf[1]=(uint8_t)(Value>>8);
+    Buf[2]=(uint8_t)(Value>>16);
+    Buf[3]=(uint8_t)(Value>>24);
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackGetU32
+ * Description        : Load a 32 bit little endian value.
+ * INPUTS             : const uint8_t *Buf
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t TrackGetU32(const uint8_t *Buf)
+{
+    return (uint32_t)Buf[0]|((uint32_t)Buf[1]<<8)|((uint32_t)Buf[2]<<16)|((uint32_t)Buf[3]<<24);
+}
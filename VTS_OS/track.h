@@ -0,0 +1,76 @@
+/******************************************************************************
+ * File Name: track.h
+ *
+ * Description: Header file for the columnar track block, the compressed form
+ *              fixes are stored in one flash page at a time.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_TRACK_H_
+#define SRC_TRACK_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include <stdint.h>
+#include "record.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* First byte of a block */
+#define TrackBlockType      'T'
+/* A block fills one page of the internal flash */
+#define TrackBlockSize      1024
+/* type, steps, chunks, count, seq, time, lat, lon and CRC-32 */
+#define TrackHeaderSize     26
+/* The columns grow in chunks of a column tag and TrackChunkData bytes */
+#define TrackChunkSize      32
+#define TrackChunkData      (TrackChunkSize-1)
+#define TrackChunks         ((TrackBlockSize-TrackHeaderSize)/TrackChunkSize)
+/* Columns of a block */
+#define TrackColTime        0
+#define TrackColSeq         1
+#define TrackColPos         2
+#define TrackColSpeed       3
+#define TrackColHeading     4
+#define TrackColumns        5
+/* Longest run of repeated values a single entry holds */
+#define TrackRunMax         0xFFFF
+/* Default quantisation: speed in km/h and heading in degrees per step */
+#define TrackSpeedStep      2
+#define TrackHeadingStep    4
+/* While stopped, moves within this radius (micro degrees, about 5 m) are GPS noise */
+#define TrackStillRadius    50
+
+typedef struct{
+    uint16_t Chunk;          /* Offset of the data of the current chunk, 0 before the first one */
+    uint8_t  Pos;            /* Bytes used in the current chunk */
+    uint8_t  Bit;            /* Bits used in the last byte, time column only */
+    uint32_t Last;           /* Last value written, run columns only */
+    uint16_t Run;            /* Repeats of Last not written yet */
+}TrackColumn_t;
+
+typedef struct{
+    uint8_t       *Block;    /* TrackBlockSize bytes, the page image */
+    uint8_t        SpeedStep;
+    uint8_t        HeadingStep;
+    uint8_t        Chunks;   /* Chunks given to the columns so far */
+    uint16_t       Count;    /* Fixes in the block */
+    int32_t        Delta;    /* Last time delta, the next one is coded against it */
+    Record_t       Prev;     /* Fix as the decoder will see it */
+    TrackColumn_t  Col[TrackColumns];
+}TrackEncoder_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+void TrackEncoderInit(TrackEncoder_t *Enc,uint8_t *Block,uint8_t SpeedStep,uint8_t HeadingStep);
+uint8_t TrackEncode(TrackEncoder_t *Enc,const Record_t *Record);
+uint32_t TrackEncoderFinish(TrackEncoder_t *Enc);
+uint32_t TrackDecode(const uint8_t *Block,uint32_t Size,Record_t *Records,uint32_t MaxRecords);
+
+#endif /* SRC_TRACK_H_ */
@@ -0,0 +1,314 @@
+/******************************************************************************
+ * File Name: trackbench.c
+ *
+ * Description: Host benchmark of the track block format. Each drive given as
+ *              a CSV file of "unix_time,lat_deg,lon_deg,speed_kmh,course_deg"
+ *              lines, or the parked, city and highway drives made up when no
+ *              file is given, is packed into 1 KB blocks and decoded back,
+ *              printing the fixes a page holds, the bytes per fix against the
+ *              flash log slot and a record batch, the throughput and the
+ *              largest error the quantisation made. Builds with TrackHostBuild
+ *              defined only, with track.c, record.c and crc32.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(TrackHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "track.h"
+#include "flashlog.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define TrackBenchMaxFixes  200000
+/* Micro degrees of latitude per meter */
+#define TrackBenchPerMeter  8.983
+#define TrackBenchPi        3.14159265358979
+
+typedef struct{
+    uint32_t Fixes;
+    uint32_t Blocks;
+    uint32_t Bytes;
+    uint32_t FirstBlock;     /* Fixes in the first block */
+    uint32_t FirstSpan;      /* Seconds the first block covers */
+    uint32_t RecordBytes;    /* Bytes of the same fixes in record batches */
+    double   EncodeSec;
+    double   DecodeSec;
+    uint32_t PosError;       /* Micro degrees */
+    uint32_t SpeedError;     /* km/h */
+    uint32_t CourseError;    /* Degrees */
+}TrackBenchResult_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t TrackBenchLoad(const char *Path,Record_t *Fixes,uint32_t Max);
+static uint32_t TrackBenchDrive(Record_t *Fixes,uint32_t Count,uint32_t Period,uint32_t MaxSpeed,uint8_t Parked);
+static void TrackBenchRun(const char *Name,const Record_t *Fixes,uint32_t Count);
+static uint32_t TrackBenchRecordBytes(const Record_t *Fixes,uint32_t Count);
+static uint32_t TrackBenchRandom(void);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static Record_t TrackBenchFixes[TrackBenchMaxFixes];
+static Record_t TrackBenchDecoded[TrackRunMax];
+static uint32_t TrackBenchSeed=12345;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Benchmark the drives given on the command line, or the made up ones.
+ * INPUTS             : int argc, char *argv[] (CSV files)
+ * RETURNS            : int 0, 1 if a drive did not decode back
+ ***********************************************************************************************/
+int main(int argc,char *argv[])
+{
+    uint32_t Count;
+    int Index;
+    printf("%-16s %7s %7s %9s %9s %9s %9s %9s %8s %8s %5s %5s %5s\n",
+           "drive","fixes","blocks","fix/page","h/page","B/fix","slot B","batch B","enc MB/s","dec MB/s","pos","kmh","deg");
+    if(argc<2)
+    {
+        Count=TrackBenchDrive(TrackBenchFixes,10080,60,0,1);
+        TrackBenchRun("parked 7d@60s",TrackBenchFixes,Count);
+        Count=TrackBenchDrive(TrackBenchFixes,8640,5,50,0);
+        TrackBenchRun("city 12h@5s",TrackBenchFixes,Count);
+        Count=TrackBenchDrive(TrackBenchFixes,86400,1,120,0);
+        TrackBenchRun("highway 24h@1s",TrackBenchFixes,Count);
+        Count=TrackBenchDrive(TrackBenchFixes,1440,60,120,0);
+        TrackBenchRun("highway 24h@60s",TrackBenchFixes,Count);
+    }
+    for(Index=1;Index<argc;Index++)
+    {
+        Count=TrackBenchLoad(argv[Index],TrackBenchFixes,TrackBenchMaxFixes);
+        TrackBenchRun(argv[Index],TrackBenchFixes,Count);
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackBenchLoad
+ * Description        : Read a drive from a CSV file, lines that do not parse are skipped.
+ * INPUTS             : const char *Path, Record_t *Fixes, uint32_t Max
+ * RETURNS            : uint32_t number of fixes read
+ ***********************************************************************************************/
+static uint32_t TrackBenchLoad(const char *Path,Record_t *Fixes,uint32_t Max)
+{
+    FILE *File=fopen(Path,"r");
+    char Line[160];
+    unsigned long Time;
+    double Lat,Lon,Speed,Course;
+    uint32_t Count=0;
+    if(File==NULL)
+    {
+        fprintf(stderr,"cannot open %s\n",Path);
+        return 0;
+    }
+    while(Count<Max && fgets(Line,sizeof(Line),File)!=NULL)
+    {
+        if(sscanf(Line,"%lu,%lf,%lf,%lf,%lf",&Time,&Lat,&Lon,&Speed,&Course)!=5)
+        {
+            continue;
+        }
+        Fixes[Count].Seq=Count+1;
+        Fixes[Count].Time=(uint32_t)Time;
+        Fixes[Count].Lat=(int32_t)lround(Lat*1e6);
+        Fixes[Count].Lon=(int32_t)lround(Lon*1e6);
+        Fixes[Count].Speed=(uint16_t)lround(Speed);
+        Fixes[Count].Course=(uint16_t)lround(Course);
+        Fixes[Count].Flags=0;
+        Count++;
+    }
+    fclose(File);
+    return Count;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackBenchDrive
+ * Description        : Make up a drive: the vehicle speeds up and slows down, stops now and then
+ *                      and turns at random, and the GPS adds a few meters of noise. A parked
+ *                      drive only has the noise.
+ * INPUTS             : Record_t *Fixes, uint32_t Count, uint32_t Period (s), uint32_t MaxSpeed
+ *                      (km/h), uint8_t Parked
+ * RETURNS            : uint32_t Count
+ ***********************************************************************************************/
+static uint32_t TrackBenchDrive(Record_t *Fixes,uint32_t Count,uint32_t Period,uint32_t MaxSpeed,uint8_t Parked)
+{
+    double Lat=30.044420;
+    double Lon=31.235712;
+    double Speed=0;
+    double Course=90;
+    double Meters;
+    uint32_t Stop=0;
+    uint32_t Index;
+    for(Index=0;Index<Count;Index++)
+    {
+        if(!Parked)
+        {
+            if(Stop!=0)
+            {
+                Stop--;
+                Speed=0;
+            }
+            else if(TrackBenchRandom()%200==0)
+            {
+                Stop=30+TrackBenchRandom()%60;
+            }
+            else
+            {
+                Speed+=(double)(TrackBenchRandom()%11)-5;
+                Speed=(Speed<0)?0:(Speed>MaxSpeed)?MaxSpeed:Speed;
+                Course+=(TrackBenchRandom()%50==0)?90.0:((double)(TrackBenchRandom()%5)-2)*0.5;
+                Course=fmod(Course+360,360);
+            }
+            Meters=Speed/3.6*Period;
+            Lat+=Meters*cos(Course*TrackBenchPi/180)*TrackBenchPerMeter/1e6;
+            Lon+=Meters*sin(Course*TrackBenchPi/180)*TrackBenchPerMeter/cos(Lat*TrackBenchPi/180)/1e6;
+        }
+        Fixes[Index].Seq=Index+1;
+        Fixes[Index].Time=1700000000+Index*Period;
+        Fixes[Index].Lat=(int32_t)lround(Lat*1e6)+(int32_t)(TrackBenchRandom()%61)-30;
+        Fixes[Index].Lon=(int32_t)lround(Lon*1e6)+(int32_t)(TrackBenchRandom()%61)-30;
+        Fixes[Index].Speed=(uint16_t)lround(Speed);
+        Fixes[Index].Course=(uint16_t)lround(Course)%360;
+        Fixes[Index].Flags=0;
+    }
+    return Count;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackBenchRun
+ * Description        : Pack a drive into blocks, decode them back and print the figures. The
+ *                      decoded fixes are checked against the input within the quantisation.
+ * INPUTS             : const char *Name, const Record_t *Fixes, uint32_t Count
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TrackBenchRun(const char *Name,const Record_t *Fixes,uint32_t Count)
+{
+    static uint8_t Blocks[TrackBenchMaxFixes/16+1][TrackBlockSize];
+    static uint32_t Sizes[TrackBenchMaxFixes/16+1];
+    TrackBenchResult_t Result={0};
+    TrackEncoder_t Enc;
+    uint32_t Index=0;
+    uint32_t Block;
+    uint32_t Decoded;
+    uint32_t Fix;
+    uint32_t Error;
+    clock_t Start;
+    if(Count==0)
+    {
+        return;
+    }
+    Result.Fixes=Count;
+    Start=clock();
+    while(Index<Count && Result.Blocks<sizeof(Sizes)/sizeof(Sizes[0]))
+    {
+        TrackEncoderInit(&Enc,Blocks[Result.Blocks],TrackSpeedStep,TrackHeadingStep);
+        while(Index<Count && TrackEncode(&Enc,&Fixes[Index]))
+        {
+            Index++;
+        }
+        Sizes[Result.Blocks]=TrackEncoderFinish(&Enc);
+        Result.Bytes+=Sizes[Result.Blocks];
+        if(Result.Blocks==0)
+        {
+            Result.FirstBlock=Index;
+            Result.FirstSpan=Fixes[Index-1].Time-Fixes[0].Time;
+        }
+        Result.Blocks++;
+    }
+    Result.EncodeSec=(double)(clock()-Start)/CLOCKS_PER_SEC;
+    Start=clock();
+    Index=0;
+    for(Block=0;Block<Result.Blocks;Block++)
+    {
+        Index+=TrackDecode(Blocks[Block],Sizes[Block],TrackBenchDecoded,TrackRunMax);
+    }
+    Result.DecodeSec=(double)(clock()-Start)/CLOCKS_PER_SEC;
+    if(Index!=Count)
+    {
+        printf("%s: %u of %u fixes decoded\n",Name,Index,Count);
+        exit(1);
+    }
+    Index=0;
+    for(Block=0;Block<Result.Blocks;Block++)
+    {
+        Decoded=TrackDecode(Blocks[Block],Sizes[Block],TrackBenchDecoded,TrackRunMax);
+        for(Fix=0;Fix<Decoded;Fix++,Index++)
+        {
+            if(TrackBenchDecoded[Fix].Seq!=Fixes[Index].Seq || TrackBenchDecoded[Fix].Time!=Fixes[Index].Time)
+            {
+                printf("%s: fix %u decoded with seq %u time %u\n",Name,Index,TrackBenchDecoded[Fix].Seq,TrackBenchDecoded[Fix].Time);
+                exit(1);
+            }
+            Error=(uint32_t)labs((long)TrackBenchDecoded[Fix].Lat-Fixes[Index].Lat);
+            Result.PosError=(Error>Result.PosError)?Error:Result.PosError;
+            Error=(uint32_t)labs((long)TrackBenchDecoded[Fix].Lon-Fixes[Index].Lon);
+            Result.PosError=(Error>Result.PosError)?Error:Result.PosError;
+            Error=(uint32_t)labs((long)TrackBenchDecoded[Fix].Speed-Fixes[Index].Speed);
+            Result.SpeedError=(Error>Result.SpeedError)?Error:Result.SpeedError;
+            Error=(uint32_t)labs((long)TrackBenchDecoded[Fix].Course-Fixes[Index].Course%360);
+            Result.CourseError=(Error>Result.CourseError)?Error:Result.CourseError;
+        }
+    }
+    Result.RecordBytes=TrackBenchRecordBytes(Fixes,Count);
+    printf("%-16s %7u %7u %9u %9.1f %9.2f %9u %9.2f %8.1f %8.1f %5u %5u %5u\n",
+           Name,Result.Fixes,Result.Blocks,Result.FirstBlock,Result.FirstSpan/3600.0,
+           (double)Result.Bytes/Result.Fixes,FlashLogSlotSize,(double)Result.RecordBytes/Result.Fixes,
+           Result.Fixes*(double)sizeof(Record_t)/1e6/(Result.EncodeSec+1e-9),
+           Result.Fixes*(double)sizeof(Record_t)/1e6/(Result.DecodeSec+1e-9),
+           Result.PosError,Result.SpeedError,Result.CourseError);
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackBenchRecordBytes
+ * Description        : Size of the drive packed in record batches of up to 1 KB, the form the
+ *                      reports are uploaded in.
+ * INPUTS             : const Record_t *Fixes, uint32_t Count
+ * RETURNS            : uint32_t bytes
+ ***********************************************************************************************/
+static uint32_t TrackBenchRecordBytes(const Record_t *Fixes,uint32_t Count)
+{
+    uint8_t Buf[TrackBlockSize];
+    RecordEncoder_t Enc;
+    uint32_t Index=0;
+    uint32_t Bytes=0;
+    while(Index<Count)
+    {
+        RecordEncoderInit(&Enc,Buf,sizeof(Buf));
+        while(Index<Count && RecordEncode(&Enc,&Fixes[Index]))
+        {
+            Index++;
+        }
+        Bytes+=Enc.Len;
+    }
+    return Bytes;
+}
+
+/***********************************************************************************************
+ * Function Name      : TrackBenchRandom
+ * Description        : Repeatable pseudo random numbers, the same drives on every host.
+ * INPUTS             : void
+ * RETURNS            : uint32_t 0 to 32767
+ ***********************************************************************************************/
+static uint32_t TrackBenchRandom(void)
+{
+    TrackBenchSeed=TrackBenchSeed*1103515245+12345;
+    return (TrackBenchSeed>>16)&0x7FFF;
+}
+
+#endif /* TrackHostBuild */
@@ -0,0 +1,490 @@
+/******************************************************************************
+ * File Name: transport.c
+ *
+ * Description: Source file for the report transports. Holds the common send
+ *              path with its time and byte accounting and the HTTP transports
+ *              that write the reports to the google sheet.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "transport.h"
+#include "HAL/gps.h"
+#include "sha256.h"
+#include "base64.h"
+#include "lz.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Link held by RQSTLink */
+#define HttpLinkNone    0
+#define HttpLinkGet     1
+#define HttpLinkPost    2
+#define HttpLinkSigned  3
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t HttpTransportOpen(void);
+static uint32_t HttpTransportSend(const Report_t *Report,uint16_t *Status);
+static void HttpTransportClose(void);
+static uint32_t HttpTransportSendBatch(uint32_t *Count,uint16_t *Status);
+static uint32_t SignedHttpTransportOpen(void);
+static uint32_t SignedHttpTransportSend(const Report_t *Report,uint16_t *Status);
+static uint32_t HttpGetBatchTransportSend(uint32_t *Count,uint16_t *Status);
+static char *TransportAppendUInt(char *Str,uint32_t Value);
+static void TransportPutU32(uint8_t *Buf,uint32_t Value);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+/* Buffer the URL command of the HTTP transport is prepared in, its length and which link it holds */
+char RQSTLink[Sim800LinkSize];
+static uint32_t RQSTLinkLen=0;
+static uint8_t RQSTLinkKind=HttpLinkNone;
+/* Stored reports a backlog batch is read from instead of the pending queue, NULL for the queue */
+static Report_t *BacklogReports=NULL;
+static uint32_t BacklogCount=0;
+/* Body of the batch uploads */
+static char BatchBody[TransportBatchBodySize];
+/* Link of the batch GET and the records packed into it */
+static char BatchLink[Sim800BatchLinkSize];
+static uint8_t BatchRecords[Base64UrlBytes(Sim800BatchLinkSize)];
+#if TransportCompressBatch
+/* Compressor of the batch bodies and its output, a literal takes 9 bits at worst */
+static LzEncoder_t BatchEncoder;
+static uint8_t BatchPacked[(TransportBatchBodySize*9)/8+1];
+#endif
+
+static TransportStats_t HttpStats;
+const Transport_t HttpTransport={"HTTP",HttpTransportOpen,HttpTransportSend,HttpTransportClose,NULL,0,&HttpStats};
+static TransportStats_t HttpBatchStats;
+const Transport_t HttpBatchTransport={"HTTP-BATCH",HttpTransportOpen,HttpTransportSend,HttpTransportClose,
+                                      HttpTransportSendBatch,1,&HttpBatchStats};
+static TransportStats_t SignedHttpStats;
+const Transport_t SignedHttpTransport={"HTTP-SIGNED",SignedHttpTransportOpen,SignedHttpTransportSend,
+                                       HttpTransportClose,NULL,0,&SignedHttpStats};
+static TransportStats_t HttpGetBatchStats;
+const Transport_t HttpGetBatchTransport={"HTTP-GET-BATCH",HttpTransportOpen,HttpTransportSend,HttpTransportClose,
+                                         HttpGetBatchTransportSend,1,&HttpGetBatchStats};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : TransportSend
+ * Description        : Send a report through a transport and account the time and the bytes it
+ *                      took, so the transports can be compared on the same drive.
+ * INPUTS             : const Transport_t *Transport, const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t TransportSend(const Transport_t *Transport,const Report_t *Report,uint16_t *Status)
+{
+    uint32_t Result;
+    uint32_t TxBytes=GSMGetTxByteCount();
+    TickType_t Start=xTaskGetTickCount();
+    *Status=0;
+    Result=Transport->Send(Report,Status);
+    if(Result==Gsmok)
+    {
+        Transport->Stats->Reports++;
+        Transport->Stats->TxBytes+=GSMGetTxByteCount()-TxBytes;
+        Transport->Stats->Ticks+=xTaskGetTickCount()-Start;
+    }
+    else
+    {
+        Transport->Stats->Failures++;
+    }
+    return Result;
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportSendBatch
+ * Description        : Send the oldest pending reports at once through a batching transport and
+ *                      account the time and the bytes it took.
+ * INPUTS             : const Transport_t *Transport, uint32_t *Count (in: at most, out: sent),
+ *                      uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t TransportSendBatch(const Transport_t *Transport,uint32_t *Count,uint16_t *Status)
+{
+    uint32_t Result;
+    uint32_t TxBytes=GSMGetTxByteCount();
+    TickType_t Start=xTaskGetTickCount();
+    *Status=0;
+    Result=Transport->SendBatch(Count,Status);
+    if(Result==Gsmok)
+    {
+        Transport->Stats->Reports+=*Count;
+        Transport->Stats->TxBytes+=GSMGetTxByteCount()-TxBytes;
+        Transport->Stats->Ticks+=xTaskGetTickCount()-Start;
+    }
+    else
+    {
+        Transport->Stats->Failures+=*Count;
+    }
+    return Result;
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportSendBacklog
+ * Description        : Send reports restored from the flash log at once through a batching
+ *                      transport. The batch reads them with TransportBatchAt, the pending queue is
+ *                      left alone. Called with the module taken like every batch.
+ * INPUTS             : const Transport_t *Transport, Report_t *Reports, uint32_t *Count (in: at
+ *                      most, out: sent), uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+uint32_t TransportSendBacklog(const Transport_t *Transport,Report_t *Reports,uint32_t *Count,uint16_t *Status)
+{
+    uint32_t Result;
+    BacklogReports=Reports;
+    BacklogCount=*Count;
+    Result=TransportSendBatch(Transport,Count,Status);
+    BacklogReports=NULL;
+    BacklogCount=0;
+    return Result;
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportBatchAt
+ * Description        : Report of the batch being sent, 0 being the oldest: a pending report or,
+ *                      during TransportSendBacklog, one of the stored reports.
+ * INPUTS             : uint32_t Index
+ * RETURNS            : Report_t* or NULL past the end of the batch
+ ***********************************************************************************************/
+Report_t *TransportBatchAt(uint32_t Index)
+{
+    if(BacklogReports!=NULL)
+    {
+        return (Index<BacklogCount) ? &BacklogReports[Index] : NULL;
+    }
+    return ReportQueuePeekAt(Index);
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportBuildFrame
+ * Description        : Build the framed binary position record used by the socket transports.
+ *                      Multi byte fields are little endian, coordinates in micro degrees and the
+ *                      checksum is the XOR of every byte between the start byte and itself.
+ * INPUTS             : uint8_t *Frame (TransportFrameSize bytes), const Report_t *Report
+ * RETURNS            : uint32_t frame size
+ ***********************************************************************************************/
+uint32_t TransportBuildFrame(uint8_t *Frame,const Report_t *Report)
+{
+    uint8_t Index;
+    uint8_t Checksum=0;
+    Frame[0]=TransportFrameStart;
+    Frame[1]=TransportFramePosition;
+    Frame[2]=TransportFrameSize-4;
+    TransportPutU32(&Frame[3],Report->Seq);
+    TransportPutU32(&Frame[7],(uint32_t)GPSToMicroDegrees(Report->Latitude));
+    TransportPutU32(&Frame[11],(uint32_t)GPSToMicroDegrees(Report->Longitude));
+    for(Index=1;Index<TransportFrameSize-1;Index++)
+    {
+        Checksum^=Frame[Index];
+    }
+    Frame[TransportFrameSize-1]=Checksum;
+    return TransportFrameSize;
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportBuildSignedFrame
+ * Description        : Build the position record of TransportBuildFrame with the truncated MAC of
+ *                      the report before the checksum.
+ * INPUTS             : uint8_t *Frame (TransportSignedFrameSize bytes), const Report_t *Report
+ * RETURNS            : uint32_t frame size
+ ***********************************************************************************************/
+uint32_t TransportBuildSignedFrame(uint8_t *Frame,const Report_t *Report)
+{
+    uint8_t Index;
+    uint8_t Checksum=0;
+    TransportBuildFrame(Frame,Report);
+    Frame[1]=TransportFrameSigned;
+    Frame[2]=TransportSignedFrameSize-4;
+    TransportSign(Report,&Frame[TransportFrameSize-1]);
+    for(Index=1;Index<TransportSignedFrameSize-1;Index++)
+    {
+        Checksum^=Frame[Index];
+    }
+    Frame[TransportSignedFrameSize-1]=Checksum;
+    return TransportSignedFrameSize;
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportSign
+ * Description        : Authenticate a report with the device key instead of TLS. The sequence
+ *                      number makes every signed message unique, so the server rejects replays
+ *                      by refusing a seq it already has.
+ * INPUTS             : const Report_t *Report, uint8_t *Mac (TransportMacSize bytes)
+ * RETURNS            : void
+ ***********************************************************************************************/
+void TransportSign(const Report_t *Report,uint8_t *Mac)
+{
+    uint8_t Message[TransportSignedSize];
+    TransportPutU32(&Message[0],TransportDeviceId);
+    TransportPutU32(&Message[4],Report->Seq);
+    TransportPutU32(&Message[8],(uint32_t)GPSToMicroDegrees(Report->Latitude));
+    TransportPutU32(&Message[12],(uint32_t)GPSToMicroDegrees(Report->Longitude));
+    HmacSha256((const uint8_t *)TransportDeviceKey,strlen(TransportDeviceKey),Message,TransportSignedSize,
+               Mac,TransportMacSize);
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportToRecord
+ * Description        : Fill the compact record of a report.
+ * INPUTS             : Record_t *Record, const Report_t *Report
+ * RETURNS            : void
+ ***********************************************************************************************/
+void TransportToRecord(Record_t *Record,const Report_t *Report)
+{
+    Record->Seq=Report->Seq;
+    Record->Time=Report->Time;
+    Record->Lat=GPSToMicroDegrees(Report->Latitude);
+    Record->Lon=GPSToMicroDegrees(Report->Longitude);
+    Record->Speed=Report->Speed;
+    Record->Course=Report->Course;
+    Record->Flags=Report->Priority?RecordFlagPriority:0;
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportFromRecord
+ * Description        : Restore a report from its compact record, the coordinates written back in
+ *                      the NMEA format of the live reports.
+ * INPUTS             : Report_t *Report, const Record_t *Record
+ * RETURNS            : void
+ ***********************************************************************************************/
+void TransportFromRecord(Report_t *Report,const Record_t *Record)
+{
+    memset(Report,0,sizeof(*Report));
+    Report->Seq=Record->Seq;
+    Report->Time=Record->Time;
+    GPSFromMicroDegrees(Record->Lat,Report->Latitude);
+    GPSFromMicroDegrees(Record->Lon,Report->Longitude);
+    Report->Speed=Record->Speed;
+    Report->Course=Record->Course;
+    Report->Priority=(Record->Flags&RecordFlagPriority)?1:0;
+    Report->Tick=xTaskGetTickCount();
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportGetCost
+ * Description        : Mean time and bytes written to the module per delivered report. The bytes
+ *                      are the AT traffic on UART2, the TLS handshake the module runs on its own
+ *                      shows in the time only.
+ * INPUTS             : const Transport_t *Transport, uint32_t *MsPerReport, uint32_t *BytesPerReport
+ * RETURNS            : void
+ ***********************************************************************************************/
+void TransportGetCost(const Transport_t *Transport,uint32_t *MsPerReport,uint32_t *BytesPerReport)
+{
+    uint32_t Reports=Transport->Stats->Reports;
+    if(Reports==0)
+    {
+        *MsPerReport=0;
+        *BytesPerReport=0;
+        return;
+    }
+    *MsPerReport=(Transport->Stats->Ticks*portTICK_PERIOD_MS)/Reports;
+    *BytesPerReport=Transport->Stats->TxBytes/Reports;
+}
+
+/***********************************************************************************************
+ * Function Name      : HttpTransportOpen
+ * Description        : Check the HTTP service of the module before sending.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t HttpTransportOpen(void)
+{
+    return Sim800CheckHttps();
+}
+
+/***********************************************************************************************
+ * Function Name      : HttpTransportSend
+ * Description        : Write the report to the google sheet with an HTTP GET. Only a 2xx status
+ *                      in the +HTTPACTION URC counts as delivered.
+ * INPUTS             : const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t HttpTransportSend(const Report_t *Report,uint16_t *Status)
+{
+    // The GET template is rendered once, then only its slots are patched
+    if(RQSTLinkKind!=HttpLinkGet)
+    {
+        RQSTLinkLen=Sim800RenderLink(RQSTLink);
+        RQSTLinkKind=HttpLinkGet;
+    }
+    Sim800PrepareLink(RQSTLink,Report->Seq,(char *)Report->Longitude,(char *)Report->Latitude);
+    return Sim800HttpGet((uint8_t *)RQSTLink,RQSTLinkLen,Status);
+}
+
+/***********************************************************************************************
+ * Function Name      : HttpTransportSendBatch
+ * Description        : Write the oldest pending reports to the google sheet with one HTTP POST.
+ *                      The body holds one "seq,lat,lon" line per report, as many as fit, and is
+ *                      compressed when TransportCompressBatch is set.
+ * INPUTS             : uint32_t *Count (in: at most, out: sent), uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t HttpTransportSendBatch(uint32_t *Count,uint16_t *Status)
+{
+    Report_t *Report;
+    uint32_t Index;
+    uint32_t Size=0;
+    for(Index=0;Index<*Count && (Report=TransportBatchAt(Index))!=NULL;Index++)
+    {
+        // Longest line: 10 digits of seq, two coordinates and the separators
+        if(Size+10+strlen(Report->Latitude)+strlen(Report->Longitude)+3>TransportBatchBodySize)
+        {
+            break;
+        }
+        Size=TransportAppendUInt(&BatchBody[Size],Report->Seq)-BatchBody;
+        BatchBody[Size++]=',';
+        strcpy(&BatchBody[Size],Report->Latitude);
+        Size+=strlen(Report->Latitude);
+        BatchBody[Size++]=',';
+        strcpy(&BatchBody[Size],Report->Longitude);
+        Size+=strlen(Report->Longitude);
+        BatchBody[Size++]='\n';
+    }
+    *Count=Index;
+    if(Index==0)
+    {
+        return GsmError;
+    }
+    if(RQSTLinkKind!=HttpLinkPost)
+    {
+        RQSTLinkLen=Sim800PreparePostLink(RQSTLink);
+        RQSTLinkKind=HttpLinkPost;
+    }
+#if TransportCompressBatch
+    LzEncoderInit(&BatchEncoder,BatchPacked,sizeof(BatchPacked));
+    LzEncoderPush(&BatchEncoder,(const uint8_t *)BatchBody,Size);
+    Size=LzEncoderFinish(&BatchEncoder);
+    return Sim800HttpPost((uint8_t *)RQSTLink,RQSTLinkLen,BatchPacked,Size,Status);
+#else
+    return Sim800HttpPost((uint8_t *)RQSTLink,RQSTLinkLen,(const uint8_t *)BatchBody,Size,Status);
+#endif
+}
+
+/***********************************************************************************************
+ * Function Name      : HttpGetBatchTransportSend
+ * Description        : Write the oldest pending reports to the google sheet with one HTTP GET, for
+ *                      the deployments that only take GET. The reports are packed as compact
+ *                      records (record.h) in base64url into the "b" parameter, as many as fit in
+ *                      the link: 10 to 11 characters a fix against 46 for lat=..&lon=..&seq=..
+ * INPUTS             : uint32_t *Count (in: at most, out: sent), uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t HttpGetBatchTransportSend(uint32_t *Count,uint16_t *Status)
+{
+    RecordEncoder_t Encoder;
+    Record_t Record;
+    Report_t *Report;
+    uint32_t Index;
+    uint32_t Len;
+    RecordEncoderInit(&Encoder,BatchRecords,Base64UrlBytes(Sim800BatchLinkRoom()));
+    for(Index=0;Index<*Count && (Report=TransportBatchAt(Index))!=NULL;Index++)
+    {
+        TransportToRecord(&Record,Report);
+        if(!RecordEncode(&Encoder,&Record))
+        {
+            break;
+        }
+    }
+    *Count=Index;
+    if(Index==0)
+    {
+        return GsmError;
+    }
+    // The body buffer of the POST batches holds the text, a single transport runs at a time
+    Len=Base64UrlEncode(BatchRecords,Encoder.Len,BatchBody);
+    Len=Sim800PrepareBatchLink(BatchLink,BatchBody,Len);
+    return Sim800HttpGet((uint8_t *)BatchLink,Len,Status);
+}
+
+/***********************************************************************************************
+ * Function Name      : SignedHttpTransportOpen
+ * Description        : Switch the HTTP service to plain HTTP, the reports carry their own MAC.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t SignedHttpTransportOpen(void)
+{
+    return Sim800CheckHttp();
+}
+
+/***********************************************************************************************
+ * Function Name      : SignedHttpTransportSend
+ * Description        : Send the report with an HTTP GET on TransportSignedUrl, signed in the "mac"
+ *                      parameter.
+ * INPUTS             : const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t SignedHttpTransportSend(const Report_t *Report,uint16_t *Status)
+{
+    uint8_t Mac[TransportMacSize];
+    if(RQSTLinkKind!=HttpLinkSigned)
+    {
+        RQSTLinkLen=Sim800RenderSignedLink(RQSTLink,TransportSignedUrl);
+        RQSTLinkKind=HttpLinkSigned;
+    }
+    Sim800PrepareLink(RQSTLink,Report->Seq,(char *)Report->Longitude,(char *)Report->Latitude);
+    TransportSign(Report,Mac);
+    Sim800SignLink(RQSTLink,Mac);
+    return Sim800HttpGet((uint8_t *)RQSTLink,RQSTLinkLen,Status);
+}
+
+/***********************************************************************************************
+ * Function Name      : HttpTransportClose
+ * Description        : The HTTP service stays initialized between reports, nothing to close.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void HttpTransportClose(void)
+{
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportAppendUInt
+ * Description        : Write an unsigned number in decimal.
+ * INPUTS             : char *Str, uint32_t Value
+ * RETURNS            : char* past the last digit written
+ ***********************************************************************************************/
+static char *TransportAppendUInt(char *Str,uint32_t Value)
+{
+    char Digits[10];
+    uint8_t Count=0;
+    do{
+        Digits[Count++]=(char)('0'+(Value%10));
+        Value/=10;
+    }while(Value!=0);
+    while(Count!=0)
+    {
+        *Str++=Digits[--Count];
+    }
+    return Str;
+}
+
+/***********************************************************************************************
+ * Function Name      : TransportPutU32
+ * Description        : Store a 32 bit value little endian.
+ * INPUTS             : uint8_t *Buf, uint32_t Value
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void TransportPutU32(uint8_t *Buf,uint32_t Value)
+{
+    Buf[0]=(uint8_t)Value;
+    Buf[1]=(uint8_t)(Value>>8);
+    Buf[2]=(uint8_t)(Value>>16);
+    Buf[3]=(uint8_t)(Value>>24);
+}
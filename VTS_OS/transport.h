@@ -0,0 +1,134 @@
+/******************************************************************************
+ * File Name: transport.h
+ *
+ * Description: Header file for the report transports. A transport hides how a
+ *              report reaches the server (HTTP request, TCP socket, ...) from
+ *              the GSM tasks.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#ifndef SRC_TRANSPORT_H_
+#define SRC_TRANSPORT_H_
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "SIM800.h"
+#include "report.h"
+#include "record.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Server the socket transports connect to, modify it with your own server */
+#define TransportServerHost     "tracker.example.com"
+#define TransportServerPort     5000
+
+/* Transport used by the GSM tasks, HttpTransport, HttpBatchTransport, TcpTransport, MqttTransport,
+ * UdpTransport, SignedHttpTransport, SignedTcpTransport, RecordTcpTransport or HttpGetBatchTransport */
+#define TransportDefault        HttpTransport
+/* Alternate the report windows between two transports so their TransportGetCost can be compared
+ * on the same drive */
+#define TransportBenchmark      0
+#define TransportBenchA         HttpTransport
+#define TransportBenchB         SignedHttpTransport
+
+/* Framed position record: start, type, length, seq, lat, lon, checksum */
+#define TransportFrameStart     0x7E
+#define TransportFramePosition  0x01
+#define TransportFrameSize      16
+
+/* Signed reports, sent without TLS: HMAC-SHA256 with the device key over device id, seq, lat and
+ * lon (little endian, micro degrees), truncated to TransportMacSize bytes. Modify the key with the
+ * one provisioned on the server for this device */
+#define TransportDeviceKey      "change-me-32-byte-device-key-000"
+#define TransportMacSize        (Sim800MacSlot/2)
+#define TransportSignedSize     16
+/* Plain HTTP endpoint of the signed reports, dev is TransportDeviceId */
+#define TransportSignedUrl      "http://" TransportServerHost "/report?dev=1&"
+/* Signed position record: start, type, length, seq, lat, lon, MAC, checksum */
+#define TransportFrameSigned    0x02
+#define TransportSignedFrameSize (TransportFrameSize+TransportMacSize)
+
+/* Batch of compact records (record.h) on TCP: start, type, length (u16 LE), batch, checksum */
+#define TransportFrameRecords   0x03
+#define TransportRecordBatchSize 192
+
+/* Size of the body of a batch upload, one "seq,lat,lon" line per report */
+#define TransportBatchBodySize  512
+/* Compress the batch bodies with lz.c, the server decompresses them with LzDecode */
+#define TransportCompressBatch  0
+
+/* Position datagram of the UDP transport: type, device, seq, lat, lon */
+#define TransportDeviceId       1
+#define TransportDgramPosition  'P'
+#define TransportDgramSize      13
+/* Ack datagram from the server: type, base seq, bitmap of base seq + 0..15 */
+#define TransportDgramAck       'A'
+#define TransportAckSize        5
+
+/* SMS fallback, used while GPRS is not available. The fixes go as 8 bit data to SmsServerNumber
+ * (international format without '+'), at most one message every SmsMinInterval ms and
+ * SmsDailyLimit messages a day */
+#define SmsServerNumber         "15551234567"
+#define SmsMinInterval          600000
+#define SmsDailyLimit           20
+/* User data of one message: type, device, count, seq, age, lat, lon, then seq, time, lat and
+ * lon deltas of the following fixes */
+#define SmsUserDataSize         140
+#define SmsHeaderSize           18
+#define SmsDeltaSize            6
+#define SmsPosition             'S'
+
+typedef struct{
+    uint32_t Reports;        /* Reports sent successfully */
+    uint32_t Failures;       /* Reports that could not be sent */
+    uint32_t TxBytes;        /* Bytes written to the module for the successful reports */
+    uint32_t Ticks;          /* Time spent sending the successful reports */
+}TransportStats_t;
+
+typedef struct{
+    const char       *Name;
+    /* Make the link usable, returns Gsmok when a report can be sent */
+    uint32_t        (*Open)(void);
+    /* Deliver one report, Status is the HTTP status when the transport has one */
+    uint32_t        (*Send)(const Report_t *Report,uint16_t *Status);
+    void            (*Close)(void);
+    /* Deliver the Count oldest pending reports at once, Count returns how many were sent.
+     * NULL when the transport sends one report at a time */
+    uint32_t        (*SendBatch)(uint32_t *Count,uint16_t *Status);
+    /* Set when SendBatch should only be called once ReportBatchReady */
+    uint8_t           WaitForBatch;
+    TransportStats_t *Stats;
+}Transport_t;
+
+extern const Transport_t HttpTransport;
+extern const Transport_t HttpBatchTransport;
+extern const Transport_t TcpTransport;
+extern const Transport_t MqttTransport;
+extern const Transport_t UdpTransport;
+extern const Transport_t SmsTransport;
+extern const Transport_t SignedHttpTransport;
+extern const Transport_t SignedTcpTransport;
+extern const Transport_t RecordTcpTransport;
+extern const Transport_t HttpGetBatchTransport;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+uint32_t TransportSend(const Transport_t *Transport,const Report_t *Report,uint16_t *Status);
+uint32_t TransportSendBatch(const Transport_t *Transport,uint32_t *Count,uint16_t *Status);
+uint32_t TransportSendBacklog(const Transport_t *Transport,Report_t *Reports,uint32_t *Count,uint16_t *Status);
+Report_t *TransportBatchAt(uint32_t Index);
+uint32_t TransportBuildFrame(uint8_t *Frame,const Report_t *Report);
+uint32_t TransportBuildSignedFrame(uint8_t *Frame,const Report_t *Report);
+void TransportSign(const Report_t *Report,uint8_t *Mac);
+void TransportToRecord(Record_t *Record,const Report_t *Report);
+void TransportFromRecord(Report_t *Report,const Record_t *Record);
+void TransportGetCost(const Transport_t *Transport,uint32_t *MsPerReport,uint32_t *BytesPerReport);
+uint8_t SmsFallbackAllowed(void);
+
+#endif /* SRC_TRANSPORT_H_ */
@@ -0,0 +1,226 @@
+/******************************************************************************
+ * File Name: udp_transport.c
+ *
+ * Description: Source file for the UDP transport. Every report is a small
+ *              sequence numbered datagram. The server answers with selective
+ *              acknowledgements and only the reports it did not confirm are
+ *              sent again from the pending queue.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "transport.h"
+#include "dns.h"
+#include "HAL/gps.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Time in ms before a datagram without acknowledgement is sent again */
+#define UdpRetransmitTimeout    5000
+/* Time in ms the acknowledgements are waited for after sending */
+#define UdpAckWait              3000
+/* Acknowledgements read at once */
+#define UdpRxBufSize            (TransportAckSize*8)
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint32_t UdpTransportOpen(void);
+static uint32_t UdpTransportSend(const Report_t *Report,uint16_t *Status);
+static void UdpTransportClose(void);
+static uint32_t UdpTransportSendBatch(uint32_t *Count,uint16_t *Status);
+static uint32_t UdpSendDatagram(Report_t *Report);
+static void UdpHandleAck(const uint8_t *Ack);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static uint8_t UdpOpen=0;
+static uint8_t UdpDgram[TransportDgramSize];
+static uint8_t UdpRxBuf[UdpRxBufSize];
+
+static TransportStats_t UdpStats;
+const Transport_t UdpTransport={"UDP",UdpTransportOpen,UdpTransportSend,UdpTransportClose,
+                                UdpTransportSendBatch,0,&UdpStats};
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : UdpTransportOpen
+ * Description        : Bind the UDP socket to the server unless it already is.
+ * INPUTS             : void
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t UdpTransportOpen(void)
+{
+    if(!UdpOpen)
+    {
+        if(DnsSocketOpen("UDP",TransportServerHost,TransportServerPort)!=Gsmok)
+        {
+            return GsmError;
+        }
+        UdpOpen=1;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpTransportSend
+ * Description        : Send a single report without waiting for its acknowledgement.
+ * INPUTS             : const Report_t *Report, uint16_t *Status
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t UdpTransportSend(const Report_t *Report,uint16_t *Status)
+{
+    (void)Status;
+    return UdpSendDatagram((Report_t *)Report);
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpTransportSendBatch
+ * Description        : Send the pending reports that were never sent or whose acknowledgement is
+ *                      overdue, then collect the acknowledgements of the server.
+ * INPUTS             : uint32_t *Count (in: at most, out: oldest reports now confirmed),
+ *                      uint16_t *Status
+ * RETURNS            : uint32_t Gsmok if the oldest report was confirmed
+ ***********************************************************************************************/
+static uint32_t UdpTransportSendBatch(uint32_t *Count,uint16_t *Status)
+{
+    Report_t *Report;
+    uint32_t Index;
+    uint32_t Received;
+    uint32_t Offset;
+    TickType_t Now=xTaskGetTickCount();
+    TickType_t Start;
+    (void)Status;
+    for(Index=0;Index<*Count && (Report=TransportBatchAt(Index))!=NULL;Index++)
+    {
+        if(!Report->Acked && (Report->SentTick==0 ||
+           (Now-Report->SentTick)>=pdMS_TO_TICKS(UdpRetransmitTimeout)))
+        {
+            if(UdpSendDatagram(Report)!=Gsmok)
+            {
+                break;
+            }
+        }
+    }
+    Start=xTaskGetTickCount();
+    while((xTaskGetTickCount()-Start)<pdMS_TO_TICKS(UdpAckWait))
+    {
+        Received=0;
+        Sim800SocketReceive(UdpRxBuf,UdpRxBufSize,&Received);
+        // Datagram boundaries are lost in the module, the acks have a fixed size
+        for(Offset=0;Offset+TransportAckSize<=Received;Offset+=TransportAckSize)
+        {
+            UdpHandleAck(&UdpRxBuf[Offset]);
+        }
+        Report=TransportBatchAt(0);
+        if(Report==NULL || Report->Acked)
+        {
+            break;
+        }
+        if(Received==0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+    // Only the confirmed reports at the head of the queue leave it
+    for(Index=0;(Report=TransportBatchAt(Index))!=NULL && Report->Acked;Index++)
+    {
+    }
+    *Count=Index;
+    return (Index!=0) ? Gsmok : GsmError;
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpTransportClose
+ * Description        : Release the UDP socket.
+ * INPUTS             : void
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void UdpTransportClose(void)
+{
+    if(UdpOpen)
+    {
+        Sim800SocketClose();
+        UdpOpen=0;
+    }
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpSendDatagram
+ * Description        : Send the position datagram of a report: type, device id, the low 16 bits
+ *                      of the sequence number and the coordinates in micro degrees, little endian.
+ * INPUTS             : Report_t *Report
+ * RETURNS            : uint32_t
+ ***********************************************************************************************/
+static uint32_t UdpSendDatagram(Report_t *Report)
+{
+    int32_t Lat=GPSToMicroDegrees(Report->Latitude);
+    int32_t Lon=GPSToMicroDegrees(Report->Longitude);
+    UdpDgram[0]=TransportDgramPosition;
+    UdpDgram[1]=(uint8_t)TransportDeviceId;
+    UdpDgram[2]=(uint8_t)(TransportDeviceId>>8);
+    UdpDgram[3]=(uint8_t)Report->Seq;
+    UdpDgram[4]=(uint8_t)(Report->Seq>>8);
+    UdpDgram[5]=(uint8_t)Lat;
+    UdpDgram[6]=(uint8_t)(Lat>>8);
+    UdpDgram[7]=(uint8_t)(Lat>>16);
+    UdpDgram[8]=(uint8_t)(Lat>>24);
+    UdpDgram[9]=(uint8_t)Lon;
+    UdpDgram[10]=(uint8_t)(Lon>>8);
+    UdpDgram[11]=(uint8_t)(Lon>>16);
+    UdpDgram[12]=(uint8_t)(Lon>>24);
+    if(Sim800SocketSend(UdpDgram,TransportDgramSize)!=Gsmok)
+    {
+        UdpOpen=0;
+        return GsmError;
+    }
+    Report->SentTick=xTaskGetTickCount();
+    // Tick 0 means never sent
+    if(Report->SentTick==0)
+    {
+        Report->SentTick=1;
+    }
+    return Gsmok;
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpHandleAck
+ * Description        : Mark the pending reports confirmed by an ack datagram. Bit k of the bitmap
+ *                      confirms the report with the low sequence bits base + k.
+ * INPUTS             : const uint8_t *Ack
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void UdpHandleAck(const uint8_t *Ack)
+{
+    Report_t *Report;
+    uint32_t Index;
+    uint16_t Base;
+    uint16_t Bitmap;
+    uint16_t Offset;
+    if(Ack[0]!=TransportDgramAck)
+    {
+        return;
+    }
+    Base=(uint16_t)(Ack[1]|(Ack[2]<<8));
+    Bitmap=(uint16_t)(Ack[3]|(Ack[4]<<8));
+    for(Index=0;(Report=TransportBatchAt(Index))!=NULL;Index++)
+    {
+        Offset=(uint16_t)((uint16_t)Report->Seq-Base);
+        if(Offset<16 && (Bitmap&(1U<<Offset)))
+        {
+            Report->Acked=1;
+        }
+    }
+}
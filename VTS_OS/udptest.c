@@ -0,0 +1,318 @@
+/******************************************************************************
+ * File Name: udptest.c
+ *
+ * Description: Host test of the UDP transport against a stand-in server. The
+ *              stand-in answers every datagram it gets with a selective ack
+ *              after a delay, and a seeded loss rate drops datagrams and acks
+ *              on the way. Reports are queued once a second and sent through
+ *              UdpTransport with the clock of the stand-in, across a wrap of
+ *              the 16 bit sequence numbers. Each run checks that only reports
+ *              the server got leave the queue and that all of them arrive, and
+ *              prints the datagrams per report. Builds with UdpHostBuild
+ *              defined only, with udp_transport.c and report.c.
+ *
+ * Author: AVELABS_D
+ *
+ * Date : Aug 27 2023
+ *******************************************************************************/
+
+#if defined(UdpHostBuild)
+
+/*******************************************************************************
+ *                                Includes                                     *
+ *******************************************************************************/
+#include "transport.h"
+#include "dns.h"
+#include "timesvc.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define UdpTestReports      600
+/* The first sequence number, the low 16 bits wrap during a run */
+#define UdpTestFirstSeq     65300
+/* Time in ms between two queued reports */
+#define UdpTestPeriod       1000
+/* Time in ms from a datagram to the arrival of its ack */
+#define UdpTestAckDelay     400
+#define UdpTestAcksMax      64
+/* Windows a run may take before the reports count as lost */
+#define UdpTestWindowsMax   (UdpTestReports*4)
+
+typedef struct{
+    uint8_t    Data[TransportAckSize];
+    TickType_t Due;
+}UdpTestAck_t;
+
+typedef struct{
+    uint32_t Datagrams;      /* Datagrams sent by the transport */
+    uint32_t Lost;           /* Datagrams and acks dropped by the loss injection */
+    uint32_t Duplicates;     /* Datagrams the server already had */
+    uint32_t Windows;        /* Batches sent */
+}UdpTestStats_t;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+static uint8_t UdpTestRun(uint8_t Loss);
+static uint8_t UdpTestDrop(void);
+static void UdpTestServerAck(uint32_t Seq);
+
+/*******************************************************************************
+ *                               Global_Variables Declaration                  *
+ *******************************************************************************/
+static TickType_t     UdpTestNow;
+static uint32_t       UdpTestSeed;
+static uint8_t        UdpTestLoss;
+/* Reports the server received, by sequence number from UdpTestFirstSeq */
+static uint8_t        UdpTestReceived[UdpTestReports];
+/* Lowest sequence number the server still misses */
+static uint32_t       UdpTestBase;
+static UdpTestAck_t   UdpTestAcks[UdpTestAcksMax];
+static uint32_t       UdpTestAckCount;
+static UdpTestStats_t UdpTestStats;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+
+/***********************************************************************************************
+ * Function Name      : main
+ * Description        : Run the transport at rising loss rates, the same on the way up and down.
+ * INPUTS             : void
+ * RETURNS            : int 0, 1 if a run failed
+ ***********************************************************************************************/
+int main(void)
+{
+    static const uint8_t Losses[]={0,5,20,40};
+    uint32_t Index;
+    uint8_t  Failed=0;
+    for(Index=0;Index<sizeof(Losses);Index++)
+    {
+        Failed|=UdpTestRun(Losses[Index]);
+    }
+    printf("%s\n",Failed?"FAILED":"all passed");
+    return Failed;
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpTestRun
+ * Description        : Queue UdpTestReports reports one window apart and send each window as a
+ *                      batch. A report the transport confirms must have reached the server.
+ * INPUTS             : uint8_t Loss, percent of the datagrams and acks dropped
+ * RETURNS            : uint8_t 0 when every report was delivered, 1 otherwise
+ ***********************************************************************************************/
+static uint8_t UdpTestRun(uint8_t Loss)
+{
+    Report_t *Report;
+    uint32_t Pushed=0;
+    uint32_t Delivered=0;
+    uint32_t Count;
+    uint16_t Status;
+    UdpTestNow=1;
+    UdpTestSeed=0x2545F491U+Loss;
+    UdpTestLoss=Loss;
+    UdpTestBase=UdpTestFirstSeq;
+    UdpTestAckCount=0;
+    memset(UdpTestReceived,0,sizeof(UdpTestReceived));
+    memset(&UdpTestStats,0,sizeof(UdpTestStats));
+    ReportQueueInit();
+    ReportSetNextSeq(UdpTestFirstSeq);
+    UdpTransport.Open();
+    while(Delivered<UdpTestReports && UdpTestStats.Windows<UdpTestWindowsMax)
+    {
+        if(Pushed<UdpTestReports && ReportQueueCount()<ReportQueueSize)
+        {
+            ReportQueuePush("3112.12345","3002.54321",50,90,0);
+            Pushed++;
+        }
+        Count=ReportQueueCount();
+        UdpTestStats.Windows++;
+        if(UdpTransport.SendBatch(&Count,&Status)==Gsmok)
+        {
+            while(Count!=0)
+            {
+                Report=ReportQueuePeek();
+                if(!UdpTestReceived[Report->Seq-UdpTestFirstSeq])
+                {
+                    printf("loss %2u%%  FAIL seq %u confirmed but never received\n",
+                           (unsigned)Loss,(unsigned)Report->Seq);
+                    return 1;
+                }
+                ReportQueueAck(200);
+                Delivered++;
+                Count--;
+            }
+        }
+        UdpTestNow+=UdpTestPeriod;
+    }
+    UdpTransport.Close();
+    if(Delivered!=UdpTestReports || UdpTestBase!=UdpTestFirstSeq+UdpTestReports)
+    {
+        printf("loss %2u%%  FAIL %u of %u reports delivered\n",(unsigned)Loss,(unsigned)Delivered,
+               (unsigned)UdpTestReports);
+        return 1;
+    }
+    printf("loss %2u%%  ok %u reports in %u windows, %.2f datagrams per report, %u duplicates, %u lost\n",
+           (unsigned)Loss,(unsigned)Delivered,(unsigned)UdpTestStats.Windows,
+           (double)UdpTestStats.Datagrams/Delivered,(unsigned)UdpTestStats.Duplicates,
+           (unsigned)UdpTestStats.Lost);
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpTestDrop
+ * Description        : Decide with a seeded xorshift generator if a packet is lost.
+ * INPUTS             : void
+ * RETURNS            : uint8_t 1 when the packet is dropped
+ ***********************************************************************************************/
+static uint8_t UdpTestDrop(void)
+{
+    UdpTestSeed^=UdpTestSeed<<13;
+    UdpTestSeed^=UdpTestSeed>>17;
+    UdpTestSeed^=UdpTestSeed<<5;
+    if((UdpTestSeed%100)<UdpTestLoss)
+    {
+        UdpTestStats.Lost++;
+        return 1;
+    }
+    return 0;
+}
+
+/***********************************************************************************************
+ * Function Name      : UdpTestServerAck
+ * Description        : Queue the ack the server sends for a datagram: the bitmap of the 16 reports
+ *                      from the lowest missing one, or from the datagram when it is further ahead.
+ * INPUTS             : uint32_t Seq
+ * RETURNS            : void
+ ***********************************************************************************************/
+static void UdpTestServerAck(uint32_t Seq)
+{
+    UdpTestAck_t *Ack;
+    uint32_t Base=(Seq-UdpTestBase<16) ? UdpTestBase : Seq;
+    uint32_t Offset;
+    uint16_t Bitmap=0;
+    if(UdpTestDrop() || UdpTestAckCount==UdpTestAcksMax)
+    {
+        return;
+    }
+    for(Offset=0;Offset<16 && Base+Offset<UdpTestFirstSeq+UdpTestReports;Offset++)
+    {
+        if(UdpTestReceived[Base+Offset-UdpTestFirstSeq])
+        {
+            Bitmap|=(uint16_t)(1U<<Offset);
+        }
+    }
+    Ack=&UdpTestAcks[UdpTestAckCount++];
+    Ack->Data[0]=TransportDgramAck;
+    Ack->Data[1]=(uint8_t)Base;
+    Ack->Data[2]=(uint8_t)(Base>>8);
+    Ack->Data[3]=(uint8_t)Bitmap;
+    Ack->Data[4]=(uint8_t)(Bitmap>>8);
+    Ack->Due=UdpTestNow+UdpTestAckDelay;
+}
+
+/*******************************************************************************
+ *                     Stand-ins of the module and the kernel                  *
+ *******************************************************************************/
+
+/* The server takes a datagram that was not lost, the sequence number is widened from its low
+ * 16 bits to the nearest one around the lowest it misses, a repeat may be older */
+uint32_t Sim800SocketSend(const uint8_t *Data,uint32_t DataSize)
+{
+    uint32_t Seq;
+    UdpTestStats.Datagrams++;
+    if(DataSize!=TransportDgramSize || Data[0]!=TransportDgramPosition || UdpTestDrop())
+    {
+        return Gsmok;
+    }
+    Seq=UdpTestBase+(int16_t)((Data[3]|(Data[4]<<8))-(uint16_t)UdpTestBase);
+    if(Seq-UdpTestFirstSeq>=UdpTestReports)
+    {
+        return Gsmok;
+    }
+    if(UdpTestReceived[Seq-UdpTestFirstSeq])
+    {
+        UdpTestStats.Duplicates++;
+    }
+    UdpTestReceived[Seq-UdpTestFirstSeq]=1;
+    while(UdpTestBase<UdpTestFirstSeq+UdpTestReports && UdpTestReceived[UdpTestBase-UdpTestFirstSeq])
+    {
+        UdpTestBase++;
+    }
+    UdpTestServerAck(Seq);
+    return Gsmok;
+}
+
+/* The acks that arrived by now, oldest first */
+uint32_t Sim800SocketReceive(uint8_t *Data,uint32_t MaxSize,uint32_t *Received)
+{
+    uint32_t Index=0;
+    uint32_t Kept=0;
+    *Received=0;
+    for(Index=0;Index<UdpTestAckCount;Index++)
+    {
+        if(UdpTestAcks[Index].Due<=UdpTestNow && *Received+TransportAckSize<=MaxSize)
+        {
+            memcpy(&Data[*Received],UdpTestAcks[Index].Data,TransportAckSize);
+            *Received+=TransportAckSize;
+        }
+        else
+        {
+            UdpTestAcks[Kept++]=UdpTestAcks[Index];
+        }
+    }
+    UdpTestAckCount=Kept;
+    return Gsmok;
+}
+
+/* The batch is the pending queue, as in transport.c outside TransportSendBacklog */
+Report_t *TransportBatchAt(uint32_t Index)
+{
+    return ReportQueuePeekAt(Index);
+}
+
+void Sim800SocketClose(void)
+{
+}
+
+uint32_t DnsSocketOpen(const char *Mode,const char *Host,uint16_t Port)
+{
+    return Gsmok;
+}
+
+/* The coordinates are not checked by the server */
+int32_t GPSToMicroDegrees(const char *Coordinate)
+{
+    return atoi(Coordinate);
+}
+
+uint32_t TimeNow(void)
+{
+    return 0;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return UdpTestNow;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    UdpTestNow+=xTicksToDelay;
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+#endif /* UdpHostBuild */